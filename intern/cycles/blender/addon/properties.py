@@ -389,6 +389,13 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
                 min=0, max=16,
                 default=12,
                 )
+        cls.offscreen_dicing_scale = FloatProperty(
+                name="Offscreen Scale",
+                description="Multiplier for dicing rate of geometry outside of the camera view, "
+                            "to reduce memory usage of large environments",
+                min=1.0, max=25.0,
+                default=4.0,
+                )
 
         cls.film_exposure = FloatProperty(
                 name="Exposure",
@@ -503,6 +510,11 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
                 description="Use BVH spatial splits: longer builder time, faster render",
                 default=False,
                 )
+        cls.debug_use_compact_geometry = BoolProperty(
+                name="Use Compact Geometry",
+                description="Store triangles and normals in a compact form: lower memory usage, slower render",
+                default=False,
+                )
         cls.tile_order = EnumProperty(
                 name="Tile Order",
                 description="Tile order for rendering",
@@ -593,6 +605,11 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         cls.debug_use_cpu_sse3 = BoolProperty(name="SSE3", default=True)
         cls.debug_use_cpu_sse2 = BoolProperty(name="SSE2", default=True)
         cls.debug_use_qbvh = BoolProperty(name="QBVH", default=True)
+        cls.debug_use_cpu_stream = BoolProperty(
+                name="Ray Stream",
+                description="Trace paths in streams of sorted rays instead of one at a time",
+                default=False,
+                )
 
         cls.debug_opencl_kernel_type = EnumProperty(
             name="OpenCL Kernel Type",
@@ -969,6 +986,14 @@ class CyclesMeshSettings(bpy.types.PropertyGroup):
                 min=0.1, max=1000.0,
                 default=1.0,
                 )
+        cls.volume_clipping = FloatProperty(
+                name="Volume Clipping",
+                description="Smoke and fire values at or below which space is considered empty "
+                            "and skipped while rendering, only valid when the volume shader has no "
+                            "density where all smoke and fire values are this low, zero renders all space",
+                min=0.0, max=1.0,
+                default=0.0,
+                )
 
     @classmethod
     def unregister(cls):
@@ -1121,6 +1146,46 @@ class CyclesCurveSettings(bpy.types.PropertyGroup):
         del bpy.types.ParticleSettings.cycles
 
 
+class CyclesRenderLayerSettings(bpy.types.PropertyGroup):
+    @classmethod
+    def register(cls):
+        bpy.types.SceneRenderLayer.cycles = PointerProperty(
+                name="Cycles RenderLayer Settings",
+                description="Cycles RenderLayer Settings",
+                type=cls,
+                )
+        cls.use_denoising = BoolProperty(
+                name="Use Denoising",
+                description="Denoise the rendered image, guided by normal, albedo and depth of the first hit",
+                default=False,
+                )
+        cls.denoising_radius = IntProperty(
+                name="Radius",
+                description="Size of the image area that is searched for similar pixels, "
+                            "larger values give smoother results but take longer",
+                min=1, max=50,
+                default=8,
+                )
+        cls.denoising_strength = FloatProperty(
+                name="Strength",
+                description="How strongly pixels with different colors are still mixed, "
+                            "higher values remove more noise but may blur details",
+                min=0.0, max=1.0,
+                default=0.5,
+                )
+        cls.denoising_feature_strength = FloatProperty(
+                name="Feature Strength",
+                description="How strongly differences in normal, albedo and depth keep pixels apart, "
+                            "higher values preserve more edges and texture detail",
+                min=0.0, max=1.0,
+                default=0.5,
+                )
+
+    @classmethod
+    def unregister(cls):
+        del bpy.types.SceneRenderLayer.cycles
+
+
 def register():
     bpy.utils.register_class(CyclesRenderSettings)
     bpy.utils.register_class(CyclesCameraSettings)
@@ -1131,6 +1196,7 @@ def register():
     bpy.utils.register_class(CyclesMeshSettings)
     bpy.utils.register_class(CyclesCurveRenderSettings)
     bpy.utils.register_class(CyclesCurveSettings)
+    bpy.utils.register_class(CyclesRenderLayerSettings)
 
 
 def unregister():
@@ -1143,3 +1209,4 @@ def unregister():
     bpy.utils.unregister_class(CyclesVisibilitySettings)
     bpy.utils.unregister_class(CyclesCurveRenderSettings)
     bpy.utils.unregister_class(CyclesCurveSettings)
+    bpy.utils.unregister_class(CyclesRenderLayerSettings)
@@ -237,6 +237,7 @@ class CyclesRender_PT_geometery(CyclesButtonsPanel, Panel):
             sub.prop(cscene, "preview_dicing_rate", text="Preview")
             sub.separator()
             sub.prop(cscene, "max_subdivisions")
+            sub.prop(cscene, "offscreen_dicing_scale")
         else:
             row = layout.row()
             row.label("Volume Sampling:")
@@ -403,6 +404,7 @@ class CyclesRender_PT_performance(CyclesButtonsPanel, Panel):
 
         col.label(text="Acceleration structure:")
         col.prop(cscene, "debug_use_spatial_splits")
+        col.prop(cscene, "debug_use_compact_geometry")
 
 
 class CyclesRender_PT_layer_options(CyclesButtonsPanel, Panel):
@@ -543,6 +545,31 @@ class CyclesRender_PT_views(CyclesButtonsPanel, Panel):
             row.prop(rv, "camera_suffix", text="")
 
 
+class CyclesRender_PT_denoising(CyclesButtonsPanel, Panel):
+    bl_label = "Denoising"
+    bl_context = "render_layer"
+    bl_options = {'DEFAULT_CLOSED'}
+
+    def draw_header(self, context):
+        rl = context.scene.render.layers.active
+        crl = rl.cycles
+        self.layout.prop(crl, "use_denoising", text="")
+
+    def draw(self, context):
+        layout = self.layout
+
+        scene = context.scene
+        rl = scene.render.layers.active
+        crl = rl.cycles
+
+        layout.active = crl.use_denoising
+
+        col = layout.column(align=True)
+        col.prop(crl, "denoising_radius")
+        col.prop(crl, "denoising_strength", slider=True)
+        col.prop(crl, "denoising_feature_strength", slider=True)
+
+
 class Cycles_PT_post_processing(CyclesButtonsPanel, Panel):
     bl_label = "Post Processing"
     bl_options = {'DEFAULT_CLOSED'}
@@ -715,6 +742,27 @@ class Cycles_PT_mesh_displacement(CyclesButtonsPanel, Panel):
         if cdata.subdivision_type != 'NONE':
             sub.prop(cdata, "dicing_rate")
 
+
+class Cycles_PT_mesh_volume(CyclesButtonsPanel, Panel):
+    bl_label = "Volume"
+    bl_context = "data"
+
+    @classmethod
+    def poll(cls, context):
+        if CyclesButtonsPanel.poll(context) and context.mesh and context.object:
+            for md in context.object.modifiers:
+                if md.type == 'SMOKE' and md.smoke_type == 'DOMAIN':
+                    return True
+
+        return False
+
+    def draw(self, context):
+        layout = self.layout
+
+        cdata = context.mesh.cycles
+
+        layout.prop(cdata, "volume_clipping", text="Clipping")
+
 class CyclesObject_PT_motion_blur(CyclesButtonsPanel, Panel):
     bl_label = "Motion Blur"
     bl_context = "object"
@@ -1552,6 +1600,7 @@ class CyclesRender_PT_debug(CyclesButtonsPanel, Panel):
         row.prop(cscene, "debug_use_cpu_avx", toggle=True)
         row.prop(cscene, "debug_use_cpu_avx2", toggle=True)
         col.prop(cscene, "debug_use_qbvh")
+        col.prop(cscene, "debug_use_cpu_stream")
 
         col = layout.column()
         col.label('OpenCL Flags:')
@@ -662,7 +662,8 @@ static void create_subd_mesh(Scene *scene,
                              PointerRNA *cmesh,
                              const vector<uint>& used_shaders,
                              float dicing_rate,
-                             int max_subdivisions)
+                             int max_subdivisions,
+                             float offscreen_dicing_scale)
 {
 	Mesh basemesh;
 	create_mesh(scene, &basemesh, b_mesh, used_shaders);
@@ -670,6 +671,7 @@ static void create_subd_mesh(Scene *scene,
 	SubdParams sdparams(mesh, used_shaders[0], true, false);
 	sdparams.dicing_rate = max(0.1f, RNA_float_get(cmesh, "dicing_rate") * dicing_rate);
 	sdparams.max_level = max_subdivisions;
+	sdparams.offscreen_dicing_scale = offscreen_dicing_scale;
 
 	scene->camera->update();
 	sdparams.camera = scene->camera;
@@ -699,6 +701,14 @@ Mesh *BlenderSync::sync_mesh(BL::Object& b_ob,
 	BL::ID key = (BKE_object_is_modified(b_ob))? b_ob: b_ob_data;
 	BL::Material material_override = render_layer.material_override;
 
+	/* instanced mesh which was already synced, skip shader lookup which
+	 * would otherwise be done for every dupli using this mesh */
+	Mesh *synced_mesh = mesh_map.find(key);
+	if(synced_mesh && mesh_synced.find(synced_mesh) != mesh_synced.end()) {
+		mesh_map.used(synced_mesh);
+		return synced_mesh;
+	}
+
 	/* find shader indices */
 	vector<uint> used_shaders;
 
@@ -787,7 +797,7 @@ Mesh *BlenderSync::sync_mesh(BL::Object& b_ob,
 			if(render_layer.use_surfaces && !hide_tris) {
 				if(cmesh.data && experimental && RNA_enum_get(&cmesh, "subdivision_type"))
 					create_subd_mesh(scene, mesh, b_ob, b_mesh, &cmesh, used_shaders,
-					                 dicing_rate, max_subdivisions);
+					                 dicing_rate, max_subdivisions, offscreen_dicing_scale);
 				else
 					create_mesh(scene, mesh, b_mesh, used_shaders);
 
@@ -820,6 +830,8 @@ Mesh *BlenderSync::sync_mesh(BL::Object& b_ob,
 			mesh->displacement_method = Mesh::DISPLACE_TRUE;
 		else
 			mesh->displacement_method = Mesh::DISPLACE_BOTH;
+
+		mesh->volume_clipping = get_float(cmesh, "volume_clipping");
 	}
 
 	/* tag update */
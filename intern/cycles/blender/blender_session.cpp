@@ -472,6 +472,14 @@ void BlenderSession::render()
 
 		BL::RenderLayer b_rlay = *b_single_rlay;
 
+		/* denoising settings are per layer */
+		PointerRNA crl = RNA_pointer_get(&b_layer_iter->ptr, "cycles");
+		session->params.use_denoising = session_params.device.advanced_shading &&
+		                                get_boolean(crl, "use_denoising");
+		session->params.denoising.radius = get_int(crl, "denoising_radius");
+		session->params.denoising.strength = get_float(crl, "denoising_strength");
+		session->params.denoising.feature_strength = get_float(crl, "denoising_feature_strength");
+
 		/* add passes */
 		vector<Pass> passes;
 		Pass::add(PASS_COMBINED, passes);
@@ -490,6 +498,9 @@ void BlenderSession::render()
 				if(pass_type != PASS_NONE)
 					Pass::add(pass_type, passes);
 			}
+
+			if(session->params.use_denoising)
+				Pass::add(PASS_DENOISING, passes);
 		}
 
 		buffer_params.passes = passes;
@@ -684,19 +695,19 @@ void BlenderSession::bake(BL::Object& b_object,
 	/* when used, non-instanced convention: object = ~object */
 	int object = ~object_index;
 
-	BakeData *bake_data = scene->bake_manager->init(object, tri_offset, num_pixels);
+	BakeData *bake_data = new BakeData(object, tri_offset, num_pixels);
 
 	populate_bake_data(bake_data, object_id, pixel_array, num_pixels);
 
-	/* set number of samples */
-	session->tile_manager.set_samples(session_params.samples);
-	session->reset(buffer_params, session_params.samples);
-	session->update_scene();
+	/* scene was fully updated above, the bake data itself does not tag
+	 * anything for update so there's no need to go over the scene again */
 
 	session->progress.set_update_callback(function_bind(&BlenderSession::update_bake_progress, this));
 
 	scene->bake_manager->bake(scene->device, &scene->dscene, scene, session->progress, shader_type, bake_pass_filter, bake_data, result);
 
+	delete bake_data;
+
 	/* free all memory used (host and device), so we wouldn't leave render
 	 * engine with extra memory allocated
 	 */
@@ -36,6 +36,7 @@
 #include "util_debug.h"
 #include "util_foreach.h"
 #include "util_opengl.h"
+#include "util_optimization.h"
 #include "util_hash.h"
 
 CCL_NAMESPACE_BEGIN
@@ -65,11 +66,13 @@ BlenderSync::BlenderSync(BL::RenderEngine& b_engine,
   is_cpu(is_cpu),
   dicing_rate(1.0f),
   max_subdivisions(12),
+  offscreen_dicing_scale(1.0f),
   progress(progress)
 {
 	PointerRNA cscene = RNA_pointer_get(&b_scene.ptr, "cycles");
 	dicing_rate = preview ? RNA_float_get(&cscene, "preview_dicing_rate") : RNA_float_get(&cscene, "dicing_rate");
 	max_subdivisions = RNA_int_get(&cscene, "max_subdivisions");
+	offscreen_dicing_scale = RNA_float_get(&cscene, "offscreen_dicing_scale");
 }
 
 BlenderSync::~BlenderSync()
@@ -148,6 +151,13 @@ bool BlenderSync::sync_recalc()
 			max_subdivisions = updated_max_subdivisions;
 			dicing_prop_changed = true;
 		}
+
+		float updated_offscreen_dicing_scale = RNA_float_get(&cscene, "offscreen_dicing_scale");
+
+		if(offscreen_dicing_scale != updated_offscreen_dicing_scale) {
+			offscreen_dicing_scale = updated_offscreen_dicing_scale;
+			dicing_prop_changed = true;
+		}
 	}
 
 	BL::BlendData::meshes_iterator b_mesh;
@@ -496,6 +506,7 @@ SceneParams BlenderSync::get_scene_params(BL::Scene& b_scene,
 		        SceneParams::BVH_STATIC);
 
 	params.use_bvh_spatial_split = RNA_boolean_get(&cscene, "debug_use_spatial_splits");
+	params.use_compact_geometry = RNA_boolean_get(&cscene, "debug_use_compact_geometry");
 
 	if(background && params.shadingsystem != SHADINGSYSTEM_OSL)
 		params.persistent_data = r.use_persistent_data();
@@ -505,11 +516,16 @@ SceneParams BlenderSync::get_scene_params(BL::Scene& b_scene,
 #if !(defined(__GNUC__) && (defined(i386) || defined(_M_IX86)))
 	if(is_cpu) {
 		params.use_qbvh = DebugFlags().cpu.qbvh && system_cpu_support_sse2();
+#ifdef WITH_CYCLES_OPTIMIZED_KERNEL_AVX2
+		/* Wider nodes are only traversed by the AVX2 kernel. */
+		params.use_obvh = params.use_qbvh && system_cpu_support_avx2();
+#endif
 	}
 	else
 #endif
 	{
 		params.use_qbvh = false;
+		params.use_obvh = false;
 	}
 
 	return params;
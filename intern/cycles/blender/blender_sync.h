@@ -174,6 +174,7 @@ private:
 
 	float dicing_rate;
 	int max_subdivisions;
+	float offscreen_dicing_scale;
 
 	struct RenderLayerInfo {
 		RenderLayerInfo()
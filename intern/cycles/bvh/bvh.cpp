@@ -63,7 +63,9 @@ BVH::BVH(const BVHParams& params_, const vector<Object*>& objects_)
 
 BVH *BVH::create(const BVHParams& params, const vector<Object*>& objects)
 {
-	if(params.use_qbvh)
+	if(params.use_obvh)
+		return new OBVH(params, objects);
+	else if(params.use_qbvh)
 		return new QBVH(params, objects);
 	else
 		return new RegularBVH(params, objects);
@@ -119,6 +121,73 @@ void BVH::refit(Progress& progress)
 	refit_nodes();
 }
 
+void BVH::refit_primitives(int start, int end, BoundBox& bbox, uint& visibility)
+{
+	for(int prim = start; prim < end; prim++) {
+		int pidx = pack.prim_index[prim];
+		int tob = pack.prim_object[prim];
+		Object *ob = objects[tob];
+
+		if(pidx == -1) {
+			/* object instance */
+			bbox.grow(ob->bounds);
+		}
+		else {
+			/* primitives */
+			const Mesh *mesh = ob->mesh;
+
+			if(pack.prim_type[prim] & PRIMITIVE_ALL_CURVE) {
+				/* curves */
+				int str_offset = (params.top_level)? mesh->curve_offset: 0;
+				const Mesh::Curve& curve = mesh->curves[pidx - str_offset];
+				int k = PRIMITIVE_UNPACK_SEGMENT(pack.prim_type[prim]);
+
+				curve.bounds_grow(k, &mesh->curve_keys[0], bbox);
+
+				visibility |= PATH_RAY_CURVE;
+
+				/* motion curves */
+				if(mesh->use_motion_blur) {
+					Attribute *attr = mesh->curve_attributes.find(ATTR_STD_MOTION_VERTEX_POSITION);
+
+					if(attr) {
+						size_t mesh_size = mesh->curve_keys.size();
+						size_t steps = mesh->motion_steps - 1;
+						float4 *key_steps = attr->data_float4();
+
+						for(size_t i = 0; i < steps; i++)
+							curve.bounds_grow(k, key_steps + i*mesh_size, bbox);
+					}
+				}
+			}
+			else {
+				/* triangles */
+				int tri_offset = (params.top_level)? mesh->tri_offset: 0;
+				const Mesh::Triangle& triangle = mesh->triangles[pidx - tri_offset];
+				const float3 *vpos = &mesh->verts[0];
+
+				triangle.bounds_grow(vpos, bbox);
+
+				/* motion triangles */
+				if(mesh->use_motion_blur) {
+					Attribute *attr = mesh->attributes.find(ATTR_STD_MOTION_VERTEX_POSITION);
+
+					if(attr) {
+						size_t mesh_size = mesh->verts.size();
+						size_t steps = mesh->motion_steps - 1;
+						float3 *vert_steps = attr->data_float3();
+
+						for(size_t i = 0; i < steps; i++)
+							triangle.bounds_grow(vert_steps + i*mesh_size, bbox);
+					}
+				}
+			}
+		}
+
+		visibility |= ob->visibility;
+	}
+}
+
 /* Triangles */
 
 void BVH::pack_triangle(int idx, float4 storage[3])
@@ -143,25 +212,31 @@ void BVH::pack_primitives()
 {
 	int nsize = TRI_NODE_SIZE;
 	size_t tidx_size = pack.prim_index.size();
+	/* with compact geometry the kernel reads triangle vertices from the
+	 * mesh arrays, so no copy of them is stored along with the BVH */
+	bool use_tri_storage = !params.use_compact_geometry;
 
 	pack.tri_storage.clear();
-	pack.tri_storage.resize(tidx_size * nsize);
+	if(use_tri_storage)
+		pack.tri_storage.resize(tidx_size * nsize);
 	pack.prim_visibility.clear();
 	pack.prim_visibility.resize(tidx_size);
 
 	for(unsigned int i = 0; i < tidx_size; i++) {
 		if(pack.prim_index[i] != -1) {
-			float4 storage[3];
+			if(use_tri_storage) {
+				float4 storage[3];
 
-			if(pack.prim_type[i] & PRIMITIVE_TRIANGLE) {
-				pack_triangle(i, storage);
-			}
-			else {
-				/* Avoid use of uninitialized memory. */
-				memset(&storage, 0, sizeof(storage));
-			}
+				if(pack.prim_type[i] & PRIMITIVE_TRIANGLE) {
+					pack_triangle(i, storage);
+				}
+				else {
+					/* Avoid use of uninitialized memory. */
+					memset(&storage, 0, sizeof(storage));
+				}
 
-			memcpy(&pack.tri_storage[i * nsize], storage, sizeof(float4)*3);
+				memcpy(&pack.tri_storage[i * nsize], storage, sizeof(float4)*3);
+			}
 
 			int tob = pack.prim_object[i];
 			Object *ob = objects[tob];
@@ -171,7 +246,8 @@ void BVH::pack_primitives()
 				pack.prim_visibility[i] |= PATH_RAY_CURVE;
 		}
 		else {
-			memset(&pack.tri_storage[i * nsize], 0, sizeof(float4)*3);
+			if(use_tri_storage)
+				memset(&pack.tri_storage[i * nsize], 0, sizeof(float4)*3);
 			pack.prim_visibility[i] = 0;
 		}
 	}
@@ -184,9 +260,21 @@ void BVH::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
 	/* The BVH's for instances are built separately, but for traversal all
 	 * BVH's are stored in global arrays. This function merges them into the
 	 * top level BVH, adjusting indexes and offsets where appropriate. */
-	bool use_qbvh = params.use_qbvh;
-	size_t nsize = (use_qbvh)? BVH_QNODE_SIZE: BVH_NODE_SIZE;
-	size_t nsize_leaf = (use_qbvh)? BVH_QNODE_LEAF_SIZE: BVH_NODE_LEAF_SIZE;
+	bool use_obvh = params.use_obvh;
+	bool use_qbvh = params.use_qbvh && !use_obvh;
+	size_t nsize, nsize_leaf;
+	if(use_obvh) {
+		nsize = BVH_ONODE_SIZE;
+		nsize_leaf = BVH_ONODE_LEAF_SIZE;
+	}
+	else if(use_qbvh) {
+		nsize = BVH_QNODE_SIZE;
+		nsize_leaf = BVH_QNODE_LEAF_SIZE;
+	}
+	else {
+		nsize = BVH_NODE_SIZE;
+		nsize_leaf = BVH_NODE_LEAF_SIZE;
+	}
 
 	/* adjust primitive index to point to the triangle in the global array, for
 	 * meshes with transform applied and already in the top level BVH */
@@ -335,10 +423,12 @@ void BVH::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
 		}
 
 		if(bvh->pack.nodes.size()) {
-			/* For QBVH we're packing a child bbox into 6 float4,
-			 * and for regular BVH they're packed into 3 float4.
+			/* For OBVH we're packing a child bbox into 12 float4 followed
+			 * by two int4 of child indices, for QBVH into 6 float4 and
+			 * for regular BVH they're packed into 3 float4.
 			 */
-			size_t nsize_bbox = (use_qbvh)? 6: 3;
+			size_t nsize_bbox = (use_obvh)? 12: (use_qbvh)? 6: 3;
+			size_t nsize_child = (use_obvh)? 2: 1;
 			int4 *bvh_nodes = &bvh->pack.nodes[0];
 			size_t bvh_nodes_size = bvh->pack.nodes.size(); 
 
@@ -346,24 +436,26 @@ void BVH::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
 				memcpy(pack_nodes + pack_nodes_offset, bvh_nodes + i, nsize_bbox*sizeof(int4));
 
 				/* modify offsets into arrays */
-				int4 data = bvh_nodes[i + nsize_bbox];
+				for(size_t k = 0; k < nsize_child; k++) {
+					int4 data = bvh_nodes[i + nsize_bbox + k];
 
-				data.x += (data.x < 0)? -noffset_leaf: noffset;
-				data.y += (data.y < 0)? -noffset_leaf: noffset;
+					data.x += (data.x < 0)? -noffset_leaf: noffset;
+					data.y += (data.y < 0)? -noffset_leaf: noffset;
 
-				if(use_qbvh) {
-					data.z += (data.z < 0)? -noffset_leaf: noffset;
-					data.w += (data.w < 0)? -noffset_leaf: noffset;
-				}
+					if(use_qbvh || use_obvh) {
+						data.z += (data.z < 0)? -noffset_leaf: noffset;
+						data.w += (data.w < 0)? -noffset_leaf: noffset;
+					}
 
-				pack_nodes[pack_nodes_offset + nsize_bbox] = data;
+					pack_nodes[pack_nodes_offset + nsize_bbox + k] = data;
+				}
 
 				/* Usually this copies nothing, but we better
 				 * be prepared for possible node size extension.
 				 */
-				memcpy(&pack_nodes[pack_nodes_offset + nsize_bbox+1],
-				       &bvh_nodes[i + nsize_bbox+1],
-				       sizeof(int4) * (nsize - (nsize_bbox+1)));
+				memcpy(&pack_nodes[pack_nodes_offset + nsize_bbox+nsize_child],
+				       &bvh_nodes[i + nsize_bbox+nsize_child],
+				       sizeof(int4) * (nsize - (nsize_bbox+nsize_child)));
 
 				pack_nodes_offset += nsize;
 			}
@@ -490,69 +582,7 @@ void RegularBVH::refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility
 		int c0 = data[0].x;
 		int c1 = data[0].y;
 		/* refit leaf node */
-		for(int prim = c0; prim < c1; prim++) {
-			int pidx = pack.prim_index[prim];
-			int tob = pack.prim_object[prim];
-			Object *ob = objects[tob];
-
-			if(pidx == -1) {
-				/* object instance */
-				bbox.grow(ob->bounds);
-			}
-			else {
-				/* primitives */
-				const Mesh *mesh = ob->mesh;
-
-				if(pack.prim_type[prim] & PRIMITIVE_ALL_CURVE) {
-					/* curves */
-					int str_offset = (params.top_level)? mesh->curve_offset: 0;
-					const Mesh::Curve& curve = mesh->curves[pidx - str_offset];
-					int k = PRIMITIVE_UNPACK_SEGMENT(pack.prim_type[prim]);
-
-					curve.bounds_grow(k, &mesh->curve_keys[0], bbox);
-
-					visibility |= PATH_RAY_CURVE;
-
-					/* motion curves */
-					if(mesh->use_motion_blur) {
-						Attribute *attr = mesh->curve_attributes.find(ATTR_STD_MOTION_VERTEX_POSITION);
-
-						if(attr) {
-							size_t mesh_size = mesh->curve_keys.size();
-							size_t steps = mesh->motion_steps - 1;
-							float4 *key_steps = attr->data_float4();
-
-							for(size_t i = 0; i < steps; i++)
-								curve.bounds_grow(k, key_steps + i*mesh_size, bbox);
-						}
-					}
-				}
-				else {
-					/* triangles */
-					int tri_offset = (params.top_level)? mesh->tri_offset: 0;
-					const Mesh::Triangle& triangle = mesh->triangles[pidx - tri_offset];
-					const float3 *vpos = &mesh->verts[0];
-
-					triangle.bounds_grow(vpos, bbox);
-
-					/* motion triangles */
-					if(mesh->use_motion_blur) {
-						Attribute *attr = mesh->attributes.find(ATTR_STD_MOTION_VERTEX_POSITION);
-
-						if(attr) {
-							size_t mesh_size = mesh->verts.size();
-							size_t steps = mesh->motion_steps - 1;
-							float3 *vert_steps = attr->data_float3();
-
-							for(size_t i = 0; i < steps; i++)
-								triangle.bounds_grow(vert_steps + i*mesh_size, bbox);
-						}
-					}
-				}
-			}
-
-			visibility |= ob->visibility;
-		}
+		refit_primitives(c0, c1, bbox, visibility);
 
 		/* TODO(sergey): De-duplicate with pack_leaf(). */
 		float4 leaf_data[BVH_NODE_LEAF_SIZE];
@@ -754,69 +784,7 @@ void QBVH::refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility)
 		int4 *data = &pack.leaf_nodes[idx*BVH_QNODE_LEAF_SIZE];
 		int4 c = data[0];
 		/* Refit leaf node. */
-		for(int prim = c.x; prim < c.y; prim++) {
-			int pidx = pack.prim_index[prim];
-			int tob = pack.prim_object[prim];
-			Object *ob = objects[tob];
-
-			if(pidx == -1) {
-				/* Object instance. */
-				bbox.grow(ob->bounds);
-			}
-			else {
-				/* Primitives. */
-				const Mesh *mesh = ob->mesh;
-
-				if(pack.prim_type[prim] & PRIMITIVE_ALL_CURVE) {
-					/* Curves. */
-					int str_offset = (params.top_level)? mesh->curve_offset: 0;
-					const Mesh::Curve& curve = mesh->curves[pidx - str_offset];
-					int k = PRIMITIVE_UNPACK_SEGMENT(pack.prim_type[prim]);
-
-					curve.bounds_grow(k, &mesh->curve_keys[0], bbox);
-
-					visibility |= PATH_RAY_CURVE;
-
-					/* Motion curves. */
-					if(mesh->use_motion_blur) {
-						Attribute *attr = mesh->curve_attributes.find(ATTR_STD_MOTION_VERTEX_POSITION);
-
-						if(attr) {
-							size_t mesh_size = mesh->curve_keys.size();
-							size_t steps = mesh->motion_steps - 1;
-							float4 *key_steps = attr->data_float4();
-
-							for(size_t i = 0; i < steps; i++)
-								curve.bounds_grow(k, key_steps + i*mesh_size, bbox);
-						}
-					}
-				}
-				else {
-					/* Triangles. */
-					int tri_offset = (params.top_level)? mesh->tri_offset: 0;
-					const Mesh::Triangle& triangle = mesh->triangles[pidx - tri_offset];
-					const float3 *vpos = &mesh->verts[0];
-
-					triangle.bounds_grow(vpos, bbox);
-
-					/* Motion triangles. */
-					if(mesh->use_motion_blur) {
-						Attribute *attr = mesh->attributes.find(ATTR_STD_MOTION_VERTEX_POSITION);
-
-						if(attr) {
-							size_t mesh_size = mesh->verts.size();
-							size_t steps = mesh->motion_steps - 1;
-							float3 *vert_steps = attr->data_float3();
-
-							for(size_t i = 0; i < steps; i++)
-								triangle.bounds_grow(vert_steps + i*mesh_size, bbox);
-						}
-					}
-				}
-			}
-
-			visibility |= ob->visibility;
-		}
+		refit_primitives(c.x, c.y, bbox, visibility);
 
 		/* TODO(sergey): This is actually a copy of pack_leaf(),
 		 * but this chunk of code only knows actual data and has
@@ -876,4 +844,209 @@ void QBVH::refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility)
 	}
 }
 
+/* OBVH */
+
+OBVH::OBVH(const BVHParams& params_, const vector<Object*>& objects_)
+: BVH(params_, objects_)
+{
+	params.use_obvh = true;
+}
+
+void OBVH::pack_leaf(const BVHStackEntry& e, const LeafNode *leaf)
+{
+	float4 data[BVH_ONODE_LEAF_SIZE];
+	memset(data, 0, sizeof(data));
+	if(leaf->num_triangles() == 1 && pack.prim_index[leaf->m_lo] == -1) {
+		/* object */
+		data[0].x = __int_as_float(~(leaf->m_lo));
+		data[0].y = __int_as_float(0);
+	}
+	else {
+		/* triangle */
+		data[0].x = __int_as_float(leaf->m_lo);
+		data[0].y = __int_as_float(leaf->m_hi);
+	}
+	data[0].z = __uint_as_float(leaf->m_visibility);
+	if(leaf->num_triangles() != 0) {
+		data[0].w = __uint_as_float(pack.prim_type[leaf->m_lo]);
+	}
+
+	memcpy(&pack.leaf_nodes[e.idx * BVH_ONODE_LEAF_SIZE], data, sizeof(float4)*BVH_ONODE_LEAF_SIZE);
+}
+
+void OBVH::pack_inner(const BVHStackEntry& e, const BVHStackEntry *en, int num)
+{
+	BoundBox bounds[8];
+	int child[8];
+
+	for(int i = 0; i < num; i++) {
+		bounds[i] = en[i].node->m_bounds;
+		child[i] = en[i].encodeIdx();
+	}
+
+	pack_inner_bounds(e.idx, bounds, child, num);
+}
+
+void OBVH::pack_inner_bounds(int idx, const BoundBox *bounds, const int *child, int num)
+{
+	float data[BVH_ONODE_SIZE][4];
+
+	for(int i = 0; i < 8; i++) {
+		/* Bounds of each axis side take two float4, children 0-3 go into
+		 * the first one and children 4-7 into the second one. */
+		const int j = i >> 2, k = i & 3;
+
+		if(i < num) {
+			float3 bb_min = bounds[i].min;
+			float3 bb_max = bounds[i].max;
+
+			data[0 + j][k] = bb_min.x;
+			data[2 + j][k] = bb_max.x;
+			data[4 + j][k] = bb_min.y;
+			data[6 + j][k] = bb_max.y;
+			data[8 + j][k] = bb_min.z;
+			data[10 + j][k] = bb_max.z;
+
+			data[12 + j][k] = __int_as_float(child[i]);
+		}
+		else {
+			/* We store BB which would never be recorded as intersection
+			 * so kernel might safely assume there are always 8 child nodes.
+			 */
+			data[0 + j][k] = FLT_MAX;
+			data[2 + j][k] = -FLT_MAX;
+
+			data[4 + j][k] = FLT_MAX;
+			data[6 + j][k] = -FLT_MAX;
+
+			data[8 + j][k] = FLT_MAX;
+			data[10 + j][k] = -FLT_MAX;
+
+			data[12 + j][k] = __int_as_float(0);
+		}
+	}
+
+	memcpy(&pack.nodes[idx * BVH_ONODE_SIZE], data, sizeof(float4)*BVH_ONODE_SIZE);
+}
+
+/* Octo SIMD Nodes */
+
+void OBVH::pack_nodes(const BVHNode *root)
+{
+	size_t tot_node_size = root->getSubtreeSize(BVH_STAT_ONODE_COUNT);
+	size_t leaf_node_size = root->getSubtreeSize(BVH_STAT_LEAF_COUNT);
+	size_t node_size = tot_node_size - leaf_node_size;
+
+	/* resize arrays */
+	pack.nodes.clear();
+	pack.leaf_nodes.clear();
+
+	/* for top level BVH, first merge existing BVH's so we know the offsets */
+	if(params.top_level) {
+		pack_instances(node_size*BVH_ONODE_SIZE,
+		               leaf_node_size*BVH_ONODE_LEAF_SIZE);
+	}
+	else {
+		pack.nodes.resize(node_size*BVH_ONODE_SIZE);
+		pack.leaf_nodes.resize(leaf_node_size*BVH_ONODE_LEAF_SIZE);
+	}
+
+	int nextNodeIdx = 0, nextLeafNodeIdx = 0;
+
+	vector<BVHStackEntry> stack;
+	stack.reserve(BVHParams::MAX_DEPTH*8);
+	if(root->is_leaf()) {
+		stack.push_back(BVHStackEntry(root, nextLeafNodeIdx++));
+	}
+	else {
+		stack.push_back(BVHStackEntry(root, nextNodeIdx++));
+	}
+
+	while(stack.size()) {
+		BVHStackEntry e = stack.back();
+		stack.pop_back();
+
+		if(e.node->is_leaf()) {
+			/* leaf node */
+			const LeafNode* leaf = reinterpret_cast<const LeafNode*>(e.node);
+			pack_leaf(e, leaf);
+		}
+		else {
+			/* inner node, collect up to 8 nodes from the binary subtree */
+			const BVHNode *nodes[8];
+			int numnodes = e.node->getOctoChildren(nodes);
+
+			/* push entries on the stack */
+			for(int i = 0; i < numnodes; i++) {
+				int idx;
+				if(nodes[i]->is_leaf()) {
+					idx = nextLeafNodeIdx++;
+				}
+				else {
+					idx = nextNodeIdx++;
+				}
+				stack.push_back(BVHStackEntry(nodes[i], idx));
+			}
+
+			/* set node */
+			pack_inner(e, &stack[stack.size()-numnodes], numnodes);
+		}
+	}
+
+	/* root index to start traversal at, to handle case of single leaf node */
+	pack.root_index = (root->is_leaf())? -1: 0;
+}
+
+void OBVH::refit_nodes()
+{
+	assert(!params.top_level);
+
+	BoundBox bbox = BoundBox::empty;
+	uint visibility = 0;
+	refit_node(0, (pack.root_index == -1)? true: false, bbox, visibility);
+}
+
+void OBVH::refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility)
+{
+	if(leaf) {
+		int4 *data = &pack.leaf_nodes[idx*BVH_ONODE_LEAF_SIZE];
+		int4 c = data[0];
+		/* Refit leaf node. */
+		refit_primitives(c.x, c.y, bbox, visibility);
+
+		float4 leaf_data[BVH_ONODE_LEAF_SIZE];
+		leaf_data[0].x = __int_as_float(c.x);
+		leaf_data[0].y = __int_as_float(c.y);
+		leaf_data[0].z = __uint_as_float(visibility);
+		leaf_data[0].w = __uint_as_float(c.w);
+		memcpy(&pack.leaf_nodes[idx * BVH_ONODE_LEAF_SIZE],
+		       leaf_data,
+		       sizeof(float4)*BVH_ONODE_LEAF_SIZE);
+	}
+	else {
+		int4 *data = &pack.nodes[idx*BVH_ONODE_SIZE];
+		int c[8];
+		memcpy(c, &data[12], sizeof(c));
+
+		/* Refit inner node, set bbox from children. */
+		BoundBox child_bbox[8];
+		int num_nodes = 0;
+
+		for(int i = 0; i < 8; ++i) {
+			if(c[i] == 0) {
+				break;
+			}
+			uint child_visibility = 0;
+			child_bbox[i] = BoundBox::empty;
+			refit_node((c[i] < 0)? -c[i]-1: c[i], (c[i] < 0),
+			           child_bbox[i], child_visibility);
+			++num_nodes;
+			bbox.grow(child_bbox[i]);
+			visibility |= child_visibility;
+		}
+
+		pack_inner_bounds(idx, child_bbox, c, num_nodes);
+	}
+}
+
 CCL_NAMESPACE_END
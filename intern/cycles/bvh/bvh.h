@@ -37,6 +37,8 @@ class Progress;
 #define BVH_NODE_LEAF_SIZE	1
 #define BVH_QNODE_SIZE	7
 #define BVH_QNODE_LEAF_SIZE	1
+#define BVH_ONODE_SIZE	14
+#define BVH_ONODE_LEAF_SIZE	1
 #define BVH_ALIGN		4096
 #define TRI_NODE_SIZE	3
 
@@ -98,6 +100,9 @@ protected:
 	/* merge instance BVH's */
 	void pack_instances(size_t nodes_size, size_t leaf_nodes_size);
 
+	/* grow bounds and visibility by the primitives of a leaf */
+	void refit_primitives(int start, int end, BoundBox& bbox, uint& visibility);
+
 	/* for subclasses to implement */
 	virtual void pack_nodes(const BVHNode *root) = 0;
 	virtual void refit_nodes() = 0;
@@ -144,6 +149,27 @@ protected:
 	void refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility);
 };
 
+/* OBVH
+ *
+ * Octo BVH, with each node having eight children, to use with AVX instructions. */
+
+class OBVH : public BVH {
+protected:
+	/* constructor */
+	friend class BVH;
+	OBVH(const BVHParams& params, const vector<Object*>& objects);
+
+	/* pack */
+	void pack_nodes(const BVHNode *root);
+	void pack_leaf(const BVHStackEntry& e, const LeafNode *leaf);
+	void pack_inner(const BVHStackEntry& e, const BVHStackEntry *en, int num);
+	void pack_inner_bounds(int idx, const BoundBox *bounds, const int *child, int num);
+
+	/* refit */
+	void refit_nodes();
+	void refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility);
+};
+
 CCL_NAMESPACE_END
 
 #endif /* __BVH_H__ */
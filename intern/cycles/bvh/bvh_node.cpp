@@ -61,6 +61,16 @@ int BVHNode::getSubtreeSize(BVH_STAT stat) const
 				}
 			}
 			return cnt;
+		case BVH_STAT_ONODE_COUNT:
+			cnt = 1;
+			if(!is_leaf()) {
+				const BVHNode *children[8];
+				int num = getOctoChildren(children);
+				for(int i = 0; i < num; i++) {
+					cnt += children[i]->getSubtreeSize(stat);
+				}
+			}
+			return cnt;
 		default:
 			assert(0); /* unknown mode */
 	}
@@ -72,6 +82,41 @@ int BVHNode::getSubtreeSize(BVH_STAT stat) const
 	return cnt;
 }
 
+/* Collapse the binary subtree below this node into up to 8 children for the
+ * OBVH, opening the inner child with the largest surface area first. */
+int BVHNode::getOctoChildren(const BVHNode *children[8]) const
+{
+	assert(!is_leaf());
+	int num = 0;
+	for(int i = 0; i < num_children(); i++) {
+		children[num++] = get_child(i);
+	}
+
+	while(num < 8) {
+		int best = -1;
+		float best_area = -FLT_MAX;
+		for(int i = 0; i < num; i++) {
+			if(!children[i]->is_leaf()) {
+				float area = children[i]->m_bounds.safe_area();
+				if(area > best_area) {
+					best = i;
+					best_area = area;
+				}
+			}
+		}
+		if(best == -1 || num + children[best]->num_children() - 1 > 8) {
+			break;
+		}
+		const BVHNode *node = children[best];
+		children[best] = node->get_child(0);
+		for(int i = 1; i < node->num_children(); i++) {
+			children[num++] = node->get_child(i);
+		}
+	}
+
+	return num;
+}
+
 void BVHNode::deleteSubtree()
 {
 	for(int i = 0; i < num_children(); i++)
@@ -31,6 +31,7 @@ enum BVH_STAT {
 	BVH_STAT_TRIANGLE_COUNT,
 	BVH_STAT_CHILDNODE_COUNT,
 	BVH_STAT_QNODE_COUNT,
+	BVH_STAT_ONODE_COUNT,
 };
 
 class BVHParams;
@@ -54,6 +55,7 @@ public:
 
 	// Subtree functions
 	int getSubtreeSize(BVH_STAT stat=BVH_STAT_NODE_COUNT) const;
+	int getOctoChildren(const BVHNode *children[8]) const;
 	float computeSubtreeSAHCost(const BVHParams& p, float probability = 1.0f) const;
 	void deleteSubtree();
 
@@ -46,6 +46,12 @@ public:
 	/* QBVH */
 	bool use_qbvh;
 
+	/* OBVH, takes precedence over QBVH */
+	bool use_obvh;
+
+	/* no precomputed triangle storage, vertices are read from the mesh */
+	bool use_compact_geometry;
+
 	/* fixed parameters */
 	enum {
 		MAX_DEPTH = 64,
@@ -69,6 +75,8 @@ public:
 
 		top_level = false;
 		use_qbvh = false;
+		use_obvh = false;
+		use_compact_geometry = false;
 	}
 
 	/* SAH costs */
@@ -319,6 +319,102 @@ void BVHSpatialSplit::split_triangle_primitive(const Mesh *mesh,
 	}
 }
 
+/* Number of chords a curve segment is approximated with when splitting it. */
+#define BVH_CURVE_SPLIT_STEPS 2
+
+/* Grow bounds with the part of the chord v0-v1 which lies on the given side
+ * of the split plane, extended by margin in every direction. */
+static void curve_chord_grow_clipped(const float3& v0,
+                                     const float3& v1,
+                                     int dim,
+                                     float pos,
+                                     bool left,
+                                     const float3& margin,
+                                     BoundBox& bounds)
+{
+	/* a chord point which is up to margin away from the plane may still
+	 * correspond to a point of the curve tube on the other side of it */
+	const float limit = left? pos + margin[dim]: pos - margin[dim];
+	const float v0p = left? v0[dim] - limit: limit - v0[dim];
+	const float v1p = left? v1[dim] - limit: limit - v1[dim];
+
+	if(v0p > 0.0f && v1p > 0.0f)
+		return;
+
+	float3 a = v0, b = v1;
+
+	/* chord crosses the plane => clip it at the intersection. */
+	if(v0p > 0.0f)
+		a = lerp(v0, v1, clamp(v0p / (v0p - v1p), 0.0f, 1.0f));
+	else if(v1p > 0.0f)
+		b = lerp(v0, v1, clamp(v0p / (v0p - v1p), 0.0f, 1.0f));
+
+	bounds.grow(a - margin);
+	bounds.grow(a + margin);
+	bounds.grow(b - margin);
+	bounds.grow(b + margin);
+}
+
+static void curve_keys_split(const Mesh::Curve& curve,
+                             const float4 *curve_keys,
+                             const Transform *tfm,
+                             int k,
+                             int dim,
+                             float pos,
+                             BoundBox& left_bounds,
+                             BoundBox& right_bounds)
+{
+	/* same control points and radius as Mesh::Curve::bounds_grow() */
+	float3 P[4];
+
+	P[0] = float4_to_float3(curve_keys[max(curve.first_key + k - 1, curve.first_key)]);
+	P[1] = float4_to_float3(curve_keys[curve.first_key + k]);
+	P[2] = float4_to_float3(curve_keys[curve.first_key + k + 1]);
+	P[3] = float4_to_float3(curve_keys[min(curve.first_key + k + 2, curve.first_key + curve.num_keys - 1)]);
+
+	float mr = max(curve_keys[curve.first_key + k].w, curve_keys[curve.first_key + k + 1].w);
+	float3 radius = make_float3(mr, mr, mr);
+
+	if(tfm != NULL) {
+		for(int i = 0; i < 4; i++)
+			P[i] = transform_point(tfm, P[i]);
+
+		/* per axis bound of the transformed radius */
+		radius.x *= len(make_float3(tfm->x.x, tfm->x.y, tfm->x.z));
+		radius.y *= len(make_float3(tfm->y.x, tfm->y.y, tfm->y.z));
+		radius.z *= len(make_float3(tfm->z.x, tfm->z.y, tfm->z.z));
+	}
+
+	/* cardinal curve coefficients, keep in sync with curvebounds() */
+	const float fc = 0.71f;
+	float3 curve_coef[4];
+	curve_coef[0] = P[1];
+	curve_coef[1] = -fc*P[0] + fc*P[2];
+	curve_coef[2] = 2.0f * fc * P[0] + (fc - 3.0f) * P[1] + (3.0f - 2.0f * fc) * P[2] - fc * P[3];
+	curve_coef[3] = -fc * P[0] + (2.0f - fc) * P[1] + (fc - 2.0f) * P[2] + fc * P[3];
+
+	/* the curve deviates from its chords by at most h^2/8 times the maximum
+	 * of its second derivative, which is linear in t and so is the largest at
+	 * one of the segment ends */
+	const float h = 1.0f / BVH_CURVE_SPLIT_STEPS;
+	float3 ddp0 = fabs(2.0f * curve_coef[2]);
+	float3 ddp1 = fabs(2.0f * curve_coef[2] + 6.0f * curve_coef[3]);
+	float3 margin = max(ddp0, ddp1) * (h * h * 0.125f) + radius;
+
+	float3 v0 = P[1];
+
+	for(int i = 1; i <= BVH_CURVE_SPLIT_STEPS; i++) {
+		float t = i * h;
+		float3 v1 = (i == BVH_CURVE_SPLIT_STEPS)? P[2]:
+		            ((curve_coef[3] * t + curve_coef[2]) * t + curve_coef[1]) * t + curve_coef[0];
+
+		curve_chord_grow_clipped(v0, v1, dim, pos, true, margin, left_bounds);
+		curve_chord_grow_clipped(v0, v1, dim, pos, false, margin, right_bounds);
+
+		v0 = v1;
+	}
+}
+
 void BVHSpatialSplit::split_curve_primitive(const Mesh *mesh,
                                             const Transform *tfm,
                                             int prim_index,
@@ -328,40 +424,41 @@ void BVHSpatialSplit::split_curve_primitive(const Mesh *mesh,
                                             BoundBox& left_bounds,
                                             BoundBox& right_bounds)
 {
-	/* curve split: NOTE - Currently ignores curve width and needs to be fixed.*/
-	const int k0 = mesh->curves[prim_index].first_key + segment_index;
-	const int k1 = k0 + 1;
-	const float4& key0 = mesh->curve_keys[k0];
-	const float4& key1 = mesh->curve_keys[k1];
-	float3 v0 = float4_to_float3(key0);
-	float3 v1 = float4_to_float3(key1);
-
-	if(tfm != NULL) {
-		v0 = transform_point(tfm, v0);
-		v1 = transform_point(tfm, v1);
-	}
-
-	float v0p = v0[dim];
-	float v1p = v1[dim];
-
-	/* insert vertex to the boxes it belongs to. */
-	if(v0p <= pos)
-		left_bounds.grow(v0);
-
-	if(v0p >= pos)
-		right_bounds.grow(v0);
-
-	if(v1p <= pos)
-		left_bounds.grow(v1);
-
-	if(v1p >= pos)
-		right_bounds.grow(v1);
-
-	/* edge intersects the plane => insert intersection to both boxes. */
-	if((v0p < pos && v1p > pos) || (v0p > pos && v1p < pos)) {
-		float3 t = lerp(v0, v1, clamp((pos - v0p) / (v1p - v0p), 0.0f, 1.0f));
-		left_bounds.grow(t);
-		right_bounds.grow(t);
+	/* curve split: the segment is approximated by a few chords which are
+	 * extended by the curve radius and the maximum distance between the curve
+	 * and its chords, so the resulting boxes stay conservative while being
+	 * much tighter than the original box for long diagonal segments */
+	const Mesh::Curve& curve = mesh->curves[prim_index];
+
+	curve_keys_split(curve,
+	                 &mesh->curve_keys[0],
+	                 tfm,
+	                 segment_index,
+	                 dim,
+	                 pos,
+	                 left_bounds,
+	                 right_bounds);
+
+	/* motion curve */
+	if(mesh->has_motion_blur()) {
+		Attribute *curve_attr_mP = mesh->curve_attributes.find(ATTR_STD_MOTION_VERTEX_POSITION);
+
+		if(curve_attr_mP) {
+			size_t mesh_size = mesh->curve_keys.size();
+			size_t steps = mesh->motion_steps - 1;
+			float4 *key_steps = curve_attr_mP->data_float4();
+
+			for(size_t i = 0; i < steps; i++) {
+				curve_keys_split(curve,
+				                 key_steps + i*mesh_size,
+				                 tfm,
+				                 segment_index,
+				                 dim,
+				                 pos,
+				                 left_bounds,
+				                 right_bounds);
+			}
+		}
 	}
 }
 
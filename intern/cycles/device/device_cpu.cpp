@@ -222,41 +222,55 @@ public:
 		RenderTile tile;
 
 		void(*path_trace_kernel)(KernelGlobals*, float*, unsigned int*, int, int, int, int, int);
+		void(*path_trace_stream_kernel)(KernelGlobals*, PathStream*, float*, unsigned int*, int, int, int, int, int, int, int);
 
 #ifdef WITH_CYCLES_OPTIMIZED_KERNEL_AVX2
 		if(system_cpu_support_avx2()) {
 			path_trace_kernel = kernel_cpu_avx2_path_trace;
+			path_trace_stream_kernel = kernel_cpu_avx2_path_trace_stream;
 		}
 		else
 #endif
 #ifdef WITH_CYCLES_OPTIMIZED_KERNEL_AVX
 		if(system_cpu_support_avx()) {
 			path_trace_kernel = kernel_cpu_avx_path_trace;
+			path_trace_stream_kernel = kernel_cpu_avx_path_trace_stream;
 		}
 		else
 #endif
 #ifdef WITH_CYCLES_OPTIMIZED_KERNEL_SSE41
 		if(system_cpu_support_sse41()) {
 			path_trace_kernel = kernel_cpu_sse41_path_trace;
+			path_trace_stream_kernel = kernel_cpu_sse41_path_trace_stream;
 		}
 		else
 #endif
 #ifdef WITH_CYCLES_OPTIMIZED_KERNEL_SSE3
 		if(system_cpu_support_sse3()) {
 			path_trace_kernel = kernel_cpu_sse3_path_trace;
+			path_trace_stream_kernel = kernel_cpu_sse3_path_trace_stream;
 		}
 		else
 #endif
 #ifdef WITH_CYCLES_OPTIMIZED_KERNEL_SSE2
 		if(system_cpu_support_sse2()) {
 			path_trace_kernel = kernel_cpu_sse2_path_trace;
+			path_trace_stream_kernel = kernel_cpu_sse2_path_trace_stream;
 		}
 		else
 #endif
 		{
 			path_trace_kernel = kernel_cpu_path_trace;
+			path_trace_stream_kernel = kernel_cpu_path_trace_stream;
 		}
 		
+		/* paths traced together in stream mode, one stream per thread */
+		PathStream *stream = NULL;
+
+		if(DebugFlags().cpu.stream) {
+			stream = (PathStream*)util_aligned_malloc(sizeof(PathStream), 16);
+		}
+
 		while(task.acquire_tile(this, tile)) {
 			float *render_buffer = (float*)tile.buffer;
 			uint *rng_state = (uint*)tile.rng_state;
@@ -269,10 +283,17 @@ public:
 						break;
 				}
 
-				for(int y = tile.y; y < tile.y + tile.h; y++) {
-					for(int x = tile.x; x < tile.x + tile.w; x++) {
-						path_trace_kernel(&kg, render_buffer, rng_state,
-						                  sample, x, y, tile.offset, tile.stride);
+				if(stream) {
+					path_trace_stream_kernel(&kg, stream, render_buffer, rng_state,
+					                         sample, tile.x, tile.y, tile.w, tile.h,
+					                         tile.offset, tile.stride);
+				}
+				else {
+					for(int y = tile.y; y < tile.y + tile.h; y++) {
+						for(int x = tile.x; x < tile.x + tile.w; x++) {
+							path_trace_kernel(&kg, render_buffer, rng_state,
+							                  sample, x, y, tile.offset, tile.stride);
+						}
 					}
 				}
 
@@ -289,6 +310,10 @@ public:
 			}
 		}
 
+		if(stream) {
+			util_aligned_free(stream);
+		}
+
 #ifdef WITH_OSL
 		OSLShader::thread_free(&kg);
 #endif
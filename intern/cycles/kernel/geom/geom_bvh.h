@@ -53,6 +53,11 @@ CCL_NAMESPACE_BEGIN
 #  include "geom_qbvh.h"
 #endif
 
+/* Common OBVH functions. */
+#ifdef __OBVH__
+#  include "geom_obvh.h"
+#endif
+
 /* Regular BVH traversal */
 
 #define BVH_FUNCTION_NAME bvh_intersect
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2011-2016, Blender Foundation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Octo BVH node layout, in float4 units:
+ *
+ *   0-1   min.x of children 0-3 and 4-7
+ *   2-3   max.x
+ *   4-5   min.y
+ *   6-7   max.y
+ *   8-9   min.z
+ *   10-11 max.z
+ *   12-13 child node indices
+ *
+ * The near/far plane offsets are the same as for QBVH (0..5), they are
+ * scaled by two here since every plane takes two float4 in this layout.
+ */
+
+/* Sort the num top-most stack items so the closest one ends up on top. */
+ccl_device_inline void obvh_stack_sort(QBVHStackItem *__restrict top,
+                                       const int num)
+{
+	QBVHStackItem *base = top - num + 1;
+	for(int i = 1; i < num; i++) {
+		QBVHStackItem item = base[i];
+		int j = i - 1;
+		while(j >= 0 && base[j].dist < item.dist) {
+			base[j + 1] = base[j];
+			j--;
+		}
+		base[j + 1] = item;
+	}
+}
+
+ccl_device_inline int obvh_node_intersect(KernelGlobals *__restrict kg,
+                                          const avxf& tnear,
+                                          const avxf& tfar,
+                                          const avx3f& org_idir,
+                                          const avx3f& idir,
+                                          const int near_x,
+                                          const int near_y,
+                                          const int near_z,
+                                          const int far_x,
+                                          const int far_y,
+                                          const int far_z,
+                                          const int nodeAddr,
+                                          avxf *__restrict dist)
+{
+	const int offset = nodeAddr*BVH_ONODE_SIZE;
+	const avxf tnear_x = msub(kernel_tex_fetch_avxf(__bvh_nodes, offset+near_x*2), idir.x, org_idir.x);
+	const avxf tnear_y = msub(kernel_tex_fetch_avxf(__bvh_nodes, offset+near_y*2), idir.y, org_idir.y);
+	const avxf tnear_z = msub(kernel_tex_fetch_avxf(__bvh_nodes, offset+near_z*2), idir.z, org_idir.z);
+	const avxf tfar_x = msub(kernel_tex_fetch_avxf(__bvh_nodes, offset+far_x*2), idir.x, org_idir.x);
+	const avxf tfar_y = msub(kernel_tex_fetch_avxf(__bvh_nodes, offset+far_y*2), idir.y, org_idir.y);
+	const avxf tfar_z = msub(kernel_tex_fetch_avxf(__bvh_nodes, offset+far_z*2), idir.z, org_idir.z);
+
+	const avxf tNear = max(max(tnear_x, tnear_y), max(tnear_z, tnear));
+	const avxf tFar = min(min(tfar_x, tfar_y), min(tfar_z, tfar));
+	const avxb vmask = tNear <= tFar;
+	*dist = tNear;
+	return movemask(vmask);
+}
+
+ccl_device_inline int obvh_node_intersect_robust(KernelGlobals *__restrict kg,
+                                                 const avxf& tnear,
+                                                 const avxf& tfar,
+                                                 const avx3f& P_idir,
+                                                 const avx3f& idir,
+                                                 const int near_x,
+                                                 const int near_y,
+                                                 const int near_z,
+                                                 const int far_x,
+                                                 const int far_y,
+                                                 const int far_z,
+                                                 const int nodeAddr,
+                                                 const float difl,
+                                                 avxf *__restrict dist)
+{
+	const int offset = nodeAddr*BVH_ONODE_SIZE;
+	const avxf tnear_x = msub(kernel_tex_fetch_avxf(__bvh_nodes, offset+near_x*2), idir.x, P_idir.x);
+	const avxf tnear_y = msub(kernel_tex_fetch_avxf(__bvh_nodes, offset+near_y*2), idir.y, P_idir.y);
+	const avxf tnear_z = msub(kernel_tex_fetch_avxf(__bvh_nodes, offset+near_z*2), idir.z, P_idir.z);
+	const avxf tfar_x = msub(kernel_tex_fetch_avxf(__bvh_nodes, offset+far_x*2), idir.x, P_idir.x);
+	const avxf tfar_y = msub(kernel_tex_fetch_avxf(__bvh_nodes, offset+far_y*2), idir.y, P_idir.y);
+	const avxf tfar_z = msub(kernel_tex_fetch_avxf(__bvh_nodes, offset+far_z*2), idir.z, P_idir.z);
+
+	const float round_down = 1.0f - difl;
+	const float round_up = 1.0f + difl;
+	const avxf tNear = max(max(tnear_x, tnear_y), max(tnear_z, tnear));
+	const avxf tFar = min(min(tfar_x, tfar_y), min(tfar_z, tfar));
+	const avxb vmask = round_down*tNear <= round_up*tFar;
+	*dist = tNear;
+	return movemask(vmask);
+}
@@ -78,6 +78,16 @@ ccl_device_inline void triangle_vertices(KernelGlobals *kg, int prim, float3 P[3
 	P[2] = float4_to_float3(kernel_tex_fetch(__tri_verts, __float_as_int(tri_vindex.z)));
 }
 
+/* Vertex normal, octahedral encoded when using compact geometry */
+
+ccl_device_inline float3 triangle_vertex_normal(KernelGlobals *kg, int vert)
+{
+	if(kernel_data.bvh.use_compact_geometry)
+		return octahedral_decode(kernel_tex_fetch(__tri_vnormal_packed, vert));
+	else
+		return float4_to_float3(kernel_tex_fetch(__tri_vnormal, vert));
+}
+
 /* Interpolate smooth vertex normal from vertices */
 
 ccl_device_inline float3 triangle_smooth_normal(KernelGlobals *kg, int prim, float u, float v)
@@ -85,9 +95,9 @@ ccl_device_inline float3 triangle_smooth_normal(KernelGlobals *kg, int prim, flo
 	/* load triangle vertices */
 	float4 tri_vindex = kernel_tex_fetch(__tri_vindex, prim);
 
-	float3 n0 = float4_to_float3(kernel_tex_fetch(__tri_vnormal, __float_as_int(tri_vindex.x)));
-	float3 n1 = float4_to_float3(kernel_tex_fetch(__tri_vnormal, __float_as_int(tri_vindex.y)));
-	float3 n2 = float4_to_float3(kernel_tex_fetch(__tri_vnormal, __float_as_int(tri_vindex.z)));
+	float3 n0 = triangle_vertex_normal(kg, __float_as_int(tri_vindex.x));
+	float3 n1 = triangle_vertex_normal(kg, __float_as_int(tri_vindex.y));
+	float3 n2 = triangle_vertex_normal(kg, __float_as_int(tri_vindex.z));
 
 	return normalize((1.0f - u - v)*n2 + u*n0 + v*n1);
 }
@@ -17,7 +17,8 @@
 /* Triangle/Ray intersections.
  *
  * For BVH ray intersection we use a precomputed triangle storage to accelerate
- * intersection at the cost of more memory usage.
+ * intersection at the cost of more memory usage, unless compact geometry is
+ * used in which case vertices are read through the triangle vertex indices.
  */
 
 CCL_NAMESPACE_BEGIN
@@ -84,6 +85,28 @@ void triangle_intersect_precalc(float3 dir,
 	isect_precalc->kz = kz;
 }
 
+/* Triangle vertices for intersection, either from the precomputed triangle
+ * storage or, with compact geometry, from the mesh vertex arrays. */
+ccl_device_inline void triangle_intersect_vertices(KernelGlobals *kg,
+                                                   int triAddr,
+                                                   float4 *tri_a,
+                                                   float4 *tri_b,
+                                                   float4 *tri_c)
+{
+	if(kernel_data.bvh.use_compact_geometry) {
+		const int prim = kernel_tex_fetch(__prim_index, triAddr);
+		const float4 tri_vindex = kernel_tex_fetch(__tri_vindex, prim);
+		*tri_a = kernel_tex_fetch(__tri_verts, __float_as_int(tri_vindex.x));
+		*tri_b = kernel_tex_fetch(__tri_verts, __float_as_int(tri_vindex.y));
+		*tri_c = kernel_tex_fetch(__tri_verts, __float_as_int(tri_vindex.z));
+	}
+	else {
+		*tri_a = kernel_tex_fetch(__tri_storage, triAddr*TRI_NODE_SIZE+0);
+		*tri_b = kernel_tex_fetch(__tri_storage, triAddr*TRI_NODE_SIZE+1);
+		*tri_c = kernel_tex_fetch(__tri_storage, triAddr*TRI_NODE_SIZE+2);
+	}
+}
+
 /* TODO(sergey): Make it general utility function. */
 ccl_device_inline float xor_signmask(float x, int y)
 {
@@ -106,9 +129,8 @@ ccl_device_inline bool triangle_intersect(KernelGlobals *kg,
 	const float Sz = isect_precalc->Sz;
 
 	/* Calculate vertices relative to ray origin. */
-	const float4 tri_a = kernel_tex_fetch(__tri_storage, triAddr*TRI_NODE_SIZE+0),
-	             tri_b = kernel_tex_fetch(__tri_storage, triAddr*TRI_NODE_SIZE+1),
-	             tri_c = kernel_tex_fetch(__tri_storage, triAddr*TRI_NODE_SIZE+2);
+	float4 tri_a, tri_b, tri_c;
+	triangle_intersect_vertices(kg, triAddr, &tri_a, &tri_b, &tri_c);
 	const float3 A = make_float3(tri_a.x - P.x, tri_a.y - P.y, tri_a.z - P.z);
 	const float3 B = make_float3(tri_b.x - P.x, tri_b.y - P.y, tri_b.z - P.z);
 	const float3 C = make_float3(tri_c.x - P.x, tri_c.y - P.y, tri_c.z - P.z);
@@ -207,9 +229,8 @@ ccl_device_inline void triangle_intersect_subsurface(
 	const float Sz = isect_precalc->Sz;
 
 	/* Calculate vertices relative to ray origin. */
-	const float4 tri_a = kernel_tex_fetch(__tri_storage, triAddr*TRI_NODE_SIZE+0),
-	             tri_b = kernel_tex_fetch(__tri_storage, triAddr*TRI_NODE_SIZE+1),
-	             tri_c = kernel_tex_fetch(__tri_storage, triAddr*TRI_NODE_SIZE+2);
+	float4 tri_a, tri_b, tri_c;
+	triangle_intersect_vertices(kg, triAddr, &tri_a, &tri_b, &tri_c);
 	const float3 A = make_float3(tri_a.x - P.x, tri_a.y - P.y, tri_a.z - P.z);
 	const float3 B = make_float3(tri_b.x - P.x, tri_b.y - P.y, tri_b.z - P.z);
 	const float3 C = make_float3(tri_c.x - P.x, tri_c.y - P.y, tri_c.z - P.z);
@@ -329,9 +350,8 @@ ccl_device_inline float3 triangle_refine(KernelGlobals *kg,
 
 	P = P + D*t;
 
-	const float4 tri_a = kernel_tex_fetch(__tri_storage, isect->prim*TRI_NODE_SIZE+0),
-	             tri_b = kernel_tex_fetch(__tri_storage, isect->prim*TRI_NODE_SIZE+1),
-	             tri_c = kernel_tex_fetch(__tri_storage, isect->prim*TRI_NODE_SIZE+2);
+	float4 tri_a, tri_b, tri_c;
+	triangle_intersect_vertices(kg, isect->prim, &tri_a, &tri_b, &tri_c);
 	float3 edge1 = make_float3(tri_a.x - tri_c.x, tri_a.y - tri_c.y, tri_a.z - tri_c.z);
 	float3 edge2 = make_float3(tri_b.x - tri_c.x, tri_b.y - tri_c.y, tri_b.z - tri_c.z);
 	float3 tvec = make_float3(P.x - tri_c.x, P.y - tri_c.y, P.z - tri_c.z);
@@ -386,9 +406,8 @@ ccl_device_inline float3 triangle_refine_subsurface(KernelGlobals *kg,
 	P = P + D*t;
 
 #ifdef __INTERSECTION_REFINE__
-	const float4 tri_a = kernel_tex_fetch(__tri_storage, isect->prim*TRI_NODE_SIZE+0),
-	             tri_b = kernel_tex_fetch(__tri_storage, isect->prim*TRI_NODE_SIZE+1),
-	             tri_c = kernel_tex_fetch(__tri_storage, isect->prim*TRI_NODE_SIZE+2);
+	float4 tri_a, tri_b, tri_c;
+	triangle_intersect_vertices(kg, isect->prim, &tri_a, &tri_b, &tri_c);
 	float3 edge1 = make_float3(tri_a.x - tri_c.x, tri_a.y - tri_c.y, tri_a.z - tri_c.z);
 	float3 edge2 = make_float3(tri_b.x - tri_c.x, tri_b.y - tri_c.y, tri_b.z - tri_c.z);
 	float3 tvec = make_float3(P.x - tri_c.x, P.y - tri_c.y, P.z - tri_c.z);
@@ -61,6 +61,32 @@ ccl_device float3 volume_normalized_position(KernelGlobals *kg, const ShaderData
 	return P;
 }
 
+/* Test if any voxel attribute may be non-empty at the shading position, using
+ * the coarse grid of blocks built on the host. Positions outside of texture
+ * space use the nearest block, objects without a grid are never empty. */
+
+ccl_device bool volume_grid_occupied(KernelGlobals *kg, const ShaderData *sd)
+{
+	uint offset = kernel_tex_fetch(__volume_grid, sd->object);
+
+	if(offset == 0)
+		return true;
+
+	int res_x = kernel_tex_fetch(__volume_grid, offset + 0);
+	int res_y = kernel_tex_fetch(__volume_grid, offset + 1);
+	int res_z = kernel_tex_fetch(__volume_grid, offset + 2);
+
+	float3 P = volume_normalized_position(kg, sd, sd->P);
+	int x = min((int)(clamp(P.x, 0.0f, 1.0f) * res_x), res_x - 1);
+	int y = min((int)(clamp(P.y, 0.0f, 1.0f) * res_y), res_y - 1);
+	int z = min((int)(clamp(P.z, 0.0f, 1.0f) * res_z), res_z - 1);
+
+	uint index = (z*res_y + y)*res_x + x;
+	uint bits = kernel_tex_fetch(__volume_grid, offset + 3 + (index >> 5));
+
+	return (bits & (1u << (index & 31))) != 0;
+}
+
 ccl_device float volume_attribute_float(KernelGlobals *kg, const ShaderData *sd, AttributeElement elem, int id, float *dx, float *dy)
 {
 	float3 P = volume_normalized_position(kg, sd, sd->P);
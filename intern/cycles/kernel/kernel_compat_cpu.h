@@ -84,6 +84,14 @@ template<typename T> struct texture  {
 	}
 #endif
 
+#ifdef __KERNEL_AVX__
+	ccl_always_inline avxf fetch_avxf(int index)
+	{
+		kernel_assert(index >= 0 && index + 1 < width);
+		return avxf::loadu(&data[index]);
+	}
+#endif
+
 	T *data;
 	int width;
 };
@@ -478,6 +486,7 @@ typedef texture_image<uchar4> texture_image_uchar4;
 #define kernel_tex_fetch(tex, index) (kg->tex.fetch(index))
 #define kernel_tex_fetch_ssef(tex, index) (kg->tex.fetch_ssef(index))
 #define kernel_tex_fetch_ssei(tex, index) (kg->tex.fetch_ssei(index))
+#define kernel_tex_fetch_avxf(tex, index) (kg->tex.fetch_avxf(index))
 #define kernel_tex_lookup(tex, t, offset, size) (kg->tex.lookup(t, offset, size))
 #define kernel_tex_image_interp(tex, x, y) ((tex < MAX_FLOAT_IMAGES) ? kg->texture_float_images[tex].interp(x, y) : kg->texture_byte_images[tex - MAX_FLOAT_IMAGES].interp(x, y))
 #define kernel_tex_image_interp_3d(tex, x, y, z) ((tex < MAX_FLOAT_IMAGES) ? kg->texture_float_images[tex].interp_3d(x, y, z) : kg->texture_byte_images[tex - MAX_FLOAT_IMAGES].interp_3d(x, y, z))
@@ -513,6 +522,10 @@ ccl_device_inline void print_sse3i(const char *label, sse3i& a)
 
 #endif
 
+#ifdef __KERNEL_AVX__
+typedef vector3<avxf> avx3f;
+#endif
+
 CCL_NAMESPACE_END
 
 #endif /* __KERNEL_COMPAT_CPU_H__ */
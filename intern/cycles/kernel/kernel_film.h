@@ -21,13 +21,21 @@ ccl_device float4 film_map(KernelGlobals *kg, float4 irradiance, float scale)
 	float exposure = kernel_data.film.exposure;
 	float4 result = irradiance*scale;
 
+	/* clamp since alpha might be > 1.0 due to russian roulette */
+	float alpha = saturate(result.w);
+
 	/* conversion to srgb */
+#ifdef __KERNEL_SSE2__
+	/* colors above 1.0 are clamped by film_float_to_byte() anyway, clamping
+	 * them here keeps them in the working range of the fast power function */
+	ssef srgb = color_scene_linear_to_srgb(min(load4f(result) * ssef(exposure), ssef(1.0f)));
+	result = make_float4(srgb[0], srgb[1], srgb[2], alpha);
+#else
 	result.x = color_scene_linear_to_srgb(result.x*exposure);
 	result.y = color_scene_linear_to_srgb(result.y*exposure);
 	result.z = color_scene_linear_to_srgb(result.z*exposure);
-
-	/* clamp since alpha might be > 1.0 due to russian roulette */
-	result.w = saturate(result.w);
+	result.w = alpha;
+#endif
 
 	return result;
 }
@@ -108,6 +108,19 @@ ccl_device_inline void kernel_write_data_passes(KernelGlobals *kg, ccl_global fl
 				kernel_write_pass_float4(buffer + kernel_data.film.pass_motion, sample, speed);
 				kernel_write_pass_float(buffer + kernel_data.film.pass_motion_weight, sample, 1.0f);
 			}
+			if(flag & PASS_DENOISING) {
+				/* normal and depth, then albedo with the w component left
+				 * for kernel_write_denoising_variance() */
+				float3 normal = ccl_fetch(sd, N);
+				float depth = camera_distance(kg, ccl_fetch(sd, P));
+				float3 albedo = shader_bsdf_diffuse(kg, sd) + shader_bsdf_glossy(kg, sd) +
+				                shader_bsdf_transmission(kg, sd) + shader_bsdf_subsurface(kg, sd);
+
+				kernel_write_pass_float4(buffer + kernel_data.film.pass_denoising, sample,
+				                         make_float4(normal.x, normal.y, normal.z, depth));
+				kernel_write_pass_float4(buffer + kernel_data.film.pass_denoising + 4, sample,
+				                         make_float4(albedo.x, albedo.y, albedo.z, 0.0f));
+			}
 
 			state->flag |= PATH_RAY_SINGLE_PASS_DONE;
 		}
@@ -199,5 +212,16 @@ ccl_device_inline void kernel_write_light_passes(KernelGlobals *kg, ccl_global f
 #endif
 }
 
+ccl_device_inline void kernel_write_denoising_variance(KernelGlobals *kg, ccl_global float *buffer, int sample, float4 L)
+{
+#ifdef __PASSES__
+	/* squared luminance of every sample, to estimate the variance of the pixel */
+	if(kernel_data.film.pass_flag & PASS_DENOISING) {
+		float luminance = linear_rgb_to_gray(make_float3(L.x, L.y, L.z));
+		kernel_write_pass_float(buffer + kernel_data.film.pass_denoising + 7, sample, luminance*luminance);
+	}
+#endif
+}
+
 CCL_NAMESPACE_END
 
@@ -591,291 +591,325 @@ ccl_device void kernel_path_subsurface_setup_indirect(
 
 #endif  /* __SUBSURFACE__ */
 
-ccl_device_inline float4 kernel_path_integrate(KernelGlobals *kg,
-                                               RNG *rng,
-                                               int sample,
-                                               Ray ray,
-                                               ccl_global float *buffer)
+/* Intersect the current ray of a path with the scene. */
+ccl_device_inline bool kernel_path_scene_intersect(KernelGlobals *kg,
+                                                   RNG *rng,
+                                                   PathState *state,
+                                                   Ray *ray,
+                                                   Intersection *isect)
 {
-	/* initialize */
-	PathRadiance L;
-	float3 throughput = make_float3(1.0f, 1.0f, 1.0f);
-	float L_transparent = 0.0f;
-
-	path_radiance_init(&L, kernel_data.film.use_light_pass);
-
-	PathState state;
-	path_state_init(kg, &state, rng, sample, &ray);
-
-#ifdef __KERNEL_DEBUG__
-	DebugData debug_data;
-	debug_data_init(&debug_data);
-#endif
-
-#ifdef __SUBSURFACE__
-	SubsurfaceIndirectRays ss_indirect;
-	kernel_path_subsurface_init_indirect(&ss_indirect);
-
-	for(;;) {
-#endif
-
-	/* path iteration */
-	for(;;) {
-		/* intersect scene */
-		Intersection isect;
-		uint visibility = path_state_ray_visibility(kg, &state);
+	uint visibility = path_state_ray_visibility(kg, state);
 
 #ifdef __HAIR__
-		float difl = 0.0f, extmax = 0.0f;
-		uint lcg_state = 0;
-
-		if(kernel_data.bvh.have_curves) {
-			if((kernel_data.cam.resolution == 1) && (state.flag & PATH_RAY_CAMERA)) {	
-				float3 pixdiff = ray.dD.dx + ray.dD.dy;
-				/*pixdiff = pixdiff - dot(pixdiff, ray.D)*ray.D;*/
-				difl = kernel_data.curve.minimum_width * len(pixdiff) * 0.5f;
-			}
-
-			extmax = kernel_data.curve.maximum_width;
-			lcg_state = lcg_state_init(rng, &state, 0x51633e2d);
+	float difl = 0.0f, extmax = 0.0f;
+	uint lcg_state = 0;
+
+	if(kernel_data.bvh.have_curves) {
+		if((kernel_data.cam.resolution == 1) && (state->flag & PATH_RAY_CAMERA)) {	
+			float3 pixdiff = ray->dD.dx + ray->dD.dy;
+			/*pixdiff = pixdiff - dot(pixdiff, ray->D)*ray->D;*/
+			difl = kernel_data.curve.minimum_width * len(pixdiff) * 0.5f;
 		}
 
-		bool hit = scene_intersect(kg, &ray, visibility, &isect, &lcg_state, difl, extmax);
+		extmax = kernel_data.curve.maximum_width;
+		lcg_state = lcg_state_init(rng, state, 0x51633e2d);
+	}
+
+	return scene_intersect(kg, ray, visibility, isect, &lcg_state, difl, extmax);
 #else
-		bool hit = scene_intersect(kg, &ray, visibility, &isect, NULL, 0.0f, 0.0f);
+	return scene_intersect(kg, ray, visibility, isect, NULL, 0.0f, 0.0f);
 #endif
+}
 
-#ifdef __KERNEL_DEBUG__
-		if(state.flag & PATH_RAY_CAMERA) {
-			debug_data.num_bvh_traversal_steps += isect.num_traversal_steps;
-			debug_data.num_bvh_traversed_instances += isect.num_traversed_instances;
-		}
-		debug_data.num_ray_bounces++;
+/* Shade the intersection of a path with the scene, or the background when
+ * nothing was hit, and set up the ray of the next bounce. Returns false when
+ * the path is terminated. */
+ccl_device_inline bool kernel_path_integrate_bounce(KernelGlobals *kg,
+                                                    RNG *rng,
+                                                    int sample,
+                                                    PathState *state,
+                                                    Ray *ray,
+                                                    Intersection *isect,
+                                                    bool hit,
+                                                    PathRadiance *L,
+                                                    float3 *throughput,
+                                                    float *L_transparent,
+                                                    ccl_global float *buffer
+#ifdef __SUBSURFACE__
+                                                  , SubsurfaceIndirectRays *ss_indirect
 #endif
-
+                                                    )
+{
 #ifdef __LAMP_MIS__
-		if(kernel_data.integrator.use_lamp_mis && !(state.flag & PATH_RAY_CAMERA)) {
-			/* ray starting from previous non-transparent bounce */
-			Ray light_ray;
+	if(kernel_data.integrator.use_lamp_mis && !(state->flag & PATH_RAY_CAMERA)) {
+		/* ray starting from previous non-transparent bounce */
+		Ray light_ray;
 
-			light_ray.P = ray.P - state.ray_t*ray.D;
-			state.ray_t += isect.t;
-			light_ray.D = ray.D;
-			light_ray.t = state.ray_t;
-			light_ray.time = ray.time;
-			light_ray.dD = ray.dD;
-			light_ray.dP = ray.dP;
+		light_ray.P = ray->P - state->ray_t*ray->D;
+		state->ray_t += isect->t;
+		light_ray.D = ray->D;
+		light_ray.t = state->ray_t;
+		light_ray.time = ray->time;
+		light_ray.dD = ray->dD;
+		light_ray.dP = ray->dP;
 
-			/* intersect with lamp */
-			float3 emission;
+		/* intersect with lamp */
+		float3 emission;
 
-			if(indirect_lamp_emission(kg, &state, &light_ray, &emission))
-				path_radiance_accum_emission(&L, throughput, emission, state.bounce);
-		}
+		if(indirect_lamp_emission(kg, state, &light_ray, &emission))
+			path_radiance_accum_emission(L, *throughput, emission, state->bounce);
+	}
 #endif
 
 #ifdef __VOLUME__
-		/* volume attenuation, emission, scatter */
-		if(state.volume_stack[0].shader != SHADER_NONE) {
-			Ray volume_ray = ray;
-			volume_ray.t = (hit)? isect.t: FLT_MAX;
+	/* volume attenuation, emission, scatter */
+	if(state->volume_stack[0].shader != SHADER_NONE) {
+		Ray volume_ray = *ray;
+		volume_ray.t = (hit)? isect->t: FLT_MAX;
 
-			bool heterogeneous = volume_stack_is_heterogeneous(kg, state.volume_stack);
+		bool heterogeneous = volume_stack_is_heterogeneous(kg, state->volume_stack);
 
 #  ifdef __VOLUME_DECOUPLED__
-			int sampling_method = volume_stack_sampling_method(kg, state.volume_stack);
-			bool decoupled = kernel_volume_use_decoupled(kg, heterogeneous, true, sampling_method);
+		int sampling_method = volume_stack_sampling_method(kg, state->volume_stack);
+		bool decoupled = kernel_volume_use_decoupled(kg, heterogeneous, true, sampling_method);
 
-			if(decoupled) {
-				/* cache steps along volume for repeated sampling */
-				VolumeSegment volume_segment;
-				ShaderData volume_sd;
+		if(decoupled) {
+			/* cache steps along volume for repeated sampling */
+			VolumeSegment volume_segment;
+			ShaderData volume_sd;
 
-				shader_setup_from_volume(kg, &volume_sd, &volume_ray);
-				kernel_volume_decoupled_record(kg, &state,
-					&volume_ray, &volume_sd, &volume_segment, heterogeneous);
+			shader_setup_from_volume(kg, &volume_sd, &volume_ray);
+			kernel_volume_decoupled_record(kg, state,
+				&volume_ray, &volume_sd, &volume_segment, heterogeneous);
 
-				volume_segment.sampling_method = sampling_method;
+			volume_segment.sampling_method = sampling_method;
 
-				/* emission */
-				if(volume_segment.closure_flag & SD_EMISSION)
-					path_radiance_accum_emission(&L, throughput, volume_segment.accum_emission, state.bounce);
+			/* emission */
+			if(volume_segment.closure_flag & SD_EMISSION)
+				path_radiance_accum_emission(L, *throughput, volume_segment.accum_emission, state->bounce);
 
-				/* scattering */
-				VolumeIntegrateResult result = VOLUME_PATH_ATTENUATED;
+			/* scattering */
+			VolumeIntegrateResult result = VOLUME_PATH_ATTENUATED;
 
-				if(volume_segment.closure_flag & SD_SCATTER) {
-					int all = false;
+			if(volume_segment.closure_flag & SD_SCATTER) {
+				int all = false;
 
-					/* direct light sampling */
-					kernel_branched_path_volume_connect_light(kg, rng, &volume_sd,
-						throughput, &state, &L, all, &volume_ray, &volume_segment);
+				/* direct light sampling */
+				kernel_branched_path_volume_connect_light(kg, rng, &volume_sd,
+					*throughput, state, L, all, &volume_ray, &volume_segment);
 
-					/* indirect sample. if we use distance sampling and take just
-					 * one sample for direct and indirect light, we could share
-					 * this computation, but makes code a bit complex */
-					float rphase = path_state_rng_1D_for_decision(kg, rng, &state, PRNG_PHASE);
-					float rscatter = path_state_rng_1D_for_decision(kg, rng, &state, PRNG_SCATTER_DISTANCE);
+				/* indirect sample. if we use distance sampling and take just
+				 * one sample for direct and indirect light, we could share
+				 * this computation, but makes code a bit complex */
+				float rphase = path_state_rng_1D_for_decision(kg, rng, state, PRNG_PHASE);
+				float rscatter = path_state_rng_1D_for_decision(kg, rng, state, PRNG_SCATTER_DISTANCE);
 
-					result = kernel_volume_decoupled_scatter(kg,
-						&state, &volume_ray, &volume_sd, &throughput,
-						rphase, rscatter, &volume_segment, NULL, true);
-				}
+				result = kernel_volume_decoupled_scatter(kg,
+					state, &volume_ray, &volume_sd, throughput,
+					rphase, rscatter, &volume_segment, NULL, true);
+			}
 
-				/* free cached steps */
-				kernel_volume_decoupled_free(kg, &volume_segment);
+			/* free cached steps */
+			kernel_volume_decoupled_free(kg, &volume_segment);
 
-				if(result == VOLUME_PATH_SCATTERED) {
-					if(kernel_path_volume_bounce(kg, rng, &volume_sd, &throughput, &state, &L, &ray))
-						continue;
-					else
-						break;
-				}
-				else {
-					throughput *= volume_segment.accum_transmittance;
-				}
+			if(result == VOLUME_PATH_SCATTERED) {
+				return kernel_path_volume_bounce(kg, rng, &volume_sd, throughput, state, L, ray);
 			}
-			else
+			else {
+				*throughput *= volume_segment.accum_transmittance;
+			}
+		}
+		else
 #  endif
-			{
-				/* integrate along volume segment with distance sampling */
-				ShaderData volume_sd;
-				VolumeIntegrateResult result = kernel_volume_integrate(
-					kg, &state, &volume_sd, &volume_ray, &L, &throughput, rng, heterogeneous);
+		{
+			/* integrate along volume segment with distance sampling */
+			ShaderData volume_sd;
+			VolumeIntegrateResult result = kernel_volume_integrate(
+				kg, state, &volume_sd, &volume_ray, L, throughput, rng, heterogeneous);
 
 #  ifdef __VOLUME_SCATTER__
-				if(result == VOLUME_PATH_SCATTERED) {
-					/* direct lighting */
-					kernel_path_volume_connect_light(kg, rng, &volume_sd, throughput, &state, &L);
+			if(result == VOLUME_PATH_SCATTERED) {
+				/* direct lighting */
+				kernel_path_volume_connect_light(kg, rng, &volume_sd, *throughput, state, L);
 
-					/* indirect light bounce */
-					if(kernel_path_volume_bounce(kg, rng, &volume_sd, &throughput, &state, &L, &ray))
-						continue;
-					else
-						break;
-				}
-#  endif
+				/* indirect light bounce */
+				return kernel_path_volume_bounce(kg, rng, &volume_sd, throughput, state, L, ray);
 			}
+#  endif
 		}
+	}
 #endif
 
-		if(!hit) {
-			/* eval background shader if nothing hit */
-			if(kernel_data.background.transparent && (state.flag & PATH_RAY_CAMERA)) {
-				L_transparent += average(throughput);
+	if(!hit) {
+		/* eval background shader if nothing hit */
+		if(kernel_data.background.transparent && (state->flag & PATH_RAY_CAMERA)) {
+			*L_transparent += average(*throughput);
 
 #ifdef __PASSES__
-				if(!(kernel_data.film.pass_flag & PASS_BACKGROUND))
+			if(!(kernel_data.film.pass_flag & PASS_BACKGROUND))
 #endif
-					break;
-			}
+				return false;
+		}
 
 #ifdef __BACKGROUND__
-			/* sample background shader */
-			float3 L_background = indirect_background(kg, &state, &ray);
-			path_radiance_accum_background(&L, throughput, L_background, state.bounce);
+		/* sample background shader */
+		float3 L_background = indirect_background(kg, state, ray);
+		path_radiance_accum_background(L, *throughput, L_background, state->bounce);
 #endif
 
-			break;
-		}
+		return false;
+	}
 
-		/* setup shading */
-		ShaderData sd;
-		shader_setup_from_ray(kg, &sd, &isect, &ray);
-		float rbsdf = path_state_rng_1D_for_decision(kg, rng, &state, PRNG_BSDF);
-		shader_eval_surface(kg, &sd, &state, rbsdf, state.flag, SHADER_CONTEXT_MAIN);
+	/* setup shading */
+	ShaderData sd;
+	shader_setup_from_ray(kg, &sd, isect, ray);
+	float rbsdf = path_state_rng_1D_for_decision(kg, rng, state, PRNG_BSDF);
+	shader_eval_surface(kg, &sd, state, rbsdf, state->flag, SHADER_CONTEXT_MAIN);
 
-		/* holdout */
+	/* holdout */
 #ifdef __HOLDOUT__
-		if((sd.flag & (SD_HOLDOUT|SD_HOLDOUT_MASK)) && (state.flag & PATH_RAY_CAMERA)) {
-			if(kernel_data.background.transparent) {
-				float3 holdout_weight;
-				
-				if(sd.flag & SD_HOLDOUT_MASK)
-					holdout_weight = make_float3(1.0f, 1.0f, 1.0f);
-				else
-					holdout_weight = shader_holdout_eval(kg, &sd);
-
-				/* any throughput is ok, should all be identical here */
-				L_transparent += average(holdout_weight*throughput);
-			}
-
+	if((sd.flag & (SD_HOLDOUT|SD_HOLDOUT_MASK)) && (state->flag & PATH_RAY_CAMERA)) {
+		if(kernel_data.background.transparent) {
+			float3 holdout_weight;
+			
 			if(sd.flag & SD_HOLDOUT_MASK)
-				break;
+				holdout_weight = make_float3(1.0f, 1.0f, 1.0f);
+			else
+				holdout_weight = shader_holdout_eval(kg, &sd);
+
+			/* any throughput is ok, should all be identical here */
+			*L_transparent += average(holdout_weight*(*throughput));
 		}
+
+		if(sd.flag & SD_HOLDOUT_MASK)
+			return false;
+	}
 #endif
 
-		/* holdout mask objects do not write data passes */
-		kernel_write_data_passes(kg, buffer, &L, &sd, sample, &state, throughput);
+	/* holdout mask objects do not write data passes */
+	kernel_write_data_passes(kg, buffer, L, &sd, sample, state, *throughput);
 
-		/* blurring of bsdf after bounces, for rays that have a small likelihood
-		 * of following this particular path (diffuse, rough glossy) */
-		if(kernel_data.integrator.filter_glossy != FLT_MAX) {
-			float blur_pdf = kernel_data.integrator.filter_glossy*state.min_ray_pdf;
+	/* blurring of bsdf after bounces, for rays that have a small likelihood
+	 * of following this particular path (diffuse, rough glossy) */
+	if(kernel_data.integrator.filter_glossy != FLT_MAX) {
+		float blur_pdf = kernel_data.integrator.filter_glossy*state->min_ray_pdf;
 
-			if(blur_pdf < 1.0f) {
-				float blur_roughness = sqrtf(1.0f - blur_pdf)*0.5f;
-				shader_bsdf_blur(kg, &sd, blur_roughness);
-			}
+		if(blur_pdf < 1.0f) {
+			float blur_roughness = sqrtf(1.0f - blur_pdf)*0.5f;
+			shader_bsdf_blur(kg, &sd, blur_roughness);
 		}
+	}
 
 #ifdef __EMISSION__
-		/* emission */
-		if(sd.flag & SD_EMISSION) {
-			/* todo: is isect.t wrong here for transparent surfaces? */
-			float3 emission = indirect_primitive_emission(kg, &sd, isect.t, state.flag, state.ray_pdf);
-			path_radiance_accum_emission(&L, throughput, emission, state.bounce);
-		}
+	/* emission */
+	if(sd.flag & SD_EMISSION) {
+		/* todo: is isect.t wrong here for transparent surfaces? */
+		float3 emission = indirect_primitive_emission(kg, &sd, isect->t, state->flag, state->ray_pdf);
+		path_radiance_accum_emission(L, *throughput, emission, state->bounce);
+	}
 #endif
 
-		/* path termination. this is a strange place to put the termination, it's
-		 * mainly due to the mixed in MIS that we use. gives too many unneeded
-		 * shader evaluations, only need emission if we are going to terminate */
-		float probability = path_state_terminate_probability(kg, &state, throughput);
+	/* path termination. this is a strange place to put the termination, it's
+	 * mainly due to the mixed in MIS that we use. gives too many unneeded
+	 * shader evaluations, only need emission if we are going to terminate */
+	float probability = path_state_terminate_probability(kg, state, *throughput);
 
-		if(probability == 0.0f) {
-			break;
-		}
-		else if(probability != 1.0f) {
-			float terminate = path_state_rng_1D_for_decision(kg, rng, &state, PRNG_TERMINATE);
+	if(probability == 0.0f) {
+		return false;
+	}
+	else if(probability != 1.0f) {
+		float terminate = path_state_rng_1D_for_decision(kg, rng, state, PRNG_TERMINATE);
 
-			if(terminate >= probability)
-				break;
+		if(terminate >= probability)
+			return false;
 
-			throughput /= probability;
-		}
+		*throughput /= probability;
+	}
 
 #ifdef __AO__
-		/* ambient occlusion */
-		if(kernel_data.integrator.use_ambient_occlusion || (sd.flag & SD_AO)) {
-			kernel_path_ao(kg, &sd, &L, &state, rng, throughput);
-		}
+	/* ambient occlusion */
+	if(kernel_data.integrator.use_ambient_occlusion || (sd.flag & SD_AO)) {
+		kernel_path_ao(kg, &sd, L, state, rng, *throughput);
+	}
 #endif
 
 #ifdef __SUBSURFACE__
-		/* bssrdf scatter to a different location on the same object, replacing
-		 * the closures with a diffuse BSDF */
-		if(sd.flag & SD_BSSRDF) {
-			if(kernel_path_subsurface_scatter(kg,
-			                                  &sd,
-			                                  &L,
-			                                  &state,
-			                                  rng,
-			                                  &ray,
-			                                  &throughput,
-			                                  &ss_indirect))
-			{
-				break;
-			}
+	/* bssrdf scatter to a different location on the same object, replacing
+	 * the closures with a diffuse BSDF */
+	if(sd.flag & SD_BSSRDF) {
+		if(kernel_path_subsurface_scatter(kg,
+		                                  &sd,
+		                                  L,
+		                                  state,
+		                                  rng,
+		                                  ray,
+		                                  throughput,
+		                                  ss_indirect))
+		{
+			return false;
 		}
+	}
 #endif  /* __SUBSURFACE__ */
 
-		/* direct lighting */
-		kernel_path_surface_connect_light(kg, rng, &sd, throughput, &state, &L);
+	/* direct lighting */
+	kernel_path_surface_connect_light(kg, rng, &sd, *throughput, state, L);
+
+	/* compute direct lighting and next bounce */
+	return kernel_path_surface_bounce(kg, rng, &sd, throughput, state, L, ray);
+}
+
+ccl_device_inline float4 kernel_path_integrate(KernelGlobals *kg,
+                                               RNG *rng,
+                                               int sample,
+                                               Ray ray,
+                                               ccl_global float *buffer)
+{
+	/* initialize */
+	PathRadiance L;
+	float3 throughput = make_float3(1.0f, 1.0f, 1.0f);
+	float L_transparent = 0.0f;
+
+	path_radiance_init(&L, kernel_data.film.use_light_pass);
+
+	PathState state;
+	path_state_init(kg, &state, rng, sample, &ray);
+
+#ifdef __KERNEL_DEBUG__
+	DebugData debug_data;
+	debug_data_init(&debug_data);
+#endif
+
+#ifdef __SUBSURFACE__
+	SubsurfaceIndirectRays ss_indirect;
+	kernel_path_subsurface_init_indirect(&ss_indirect);
+
+	for(;;) {
+#endif
+
+	/* path iteration */
+	for(;;) {
+		/* intersect scene */
+		Intersection isect;
+		bool hit = kernel_path_scene_intersect(kg, rng, &state, &ray, &isect);
+
+#ifdef __KERNEL_DEBUG__
+		if(state.flag & PATH_RAY_CAMERA) {
+			debug_data.num_bvh_traversal_steps += isect.num_traversal_steps;
+			debug_data.num_bvh_traversed_instances += isect.num_traversed_instances;
+		}
+		debug_data.num_ray_bounces++;
+#endif
 
-		/* compute direct lighting and next bounce */
-		if(!kernel_path_surface_bounce(kg, rng, &sd, &throughput, &state, &L, &ray))
+		/* shade and set up the next bounce */
+		if(!kernel_path_integrate_bounce(kg, rng, sample, &state, &ray, &isect, hit,
+		                                 &L, &throughput, &L_transparent, buffer
+#ifdef __SUBSURFACE__
+		                               , &ss_indirect
+#endif
+		                                 ))
+		{
 			break;
+		}
 	}
 
 #ifdef __SUBSURFACE__
@@ -936,6 +970,7 @@ ccl_device void kernel_path_trace(KernelGlobals *kg,
 
 	/* accumulate result in output buffer */
 	kernel_write_pass_float4(buffer, sample, L);
+	kernel_write_denoising_variance(kg, buffer, sample, L);
 
 	path_rng_end(kg, rng_state, rng);
 }
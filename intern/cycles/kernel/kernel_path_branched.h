@@ -592,6 +592,7 @@ ccl_device void kernel_branched_path_trace(KernelGlobals *kg,
 
 	/* accumulate result in output buffer */
 	kernel_write_pass_float4(buffer, sample, L);
+	kernel_write_denoising_variance(kg, buffer, sample, L);
 
 	path_rng_end(kg, rng_state, rng);
 }
@@ -0,0 +1,268 @@
+/*
+ * Copyright 2011-2016 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Ray Stream Path Tracing
+ *
+ * Instead of tracing one path from the camera to its end before starting the
+ * next one, the paths of up to PATH_STREAM_SIZE pixels advance together one
+ * bounce at a time. Before every bounce the rays of the active paths are
+ * sorted by direction octant and origin, so that consecutive traversals
+ * visit the same BVH nodes and the node data stays in cache.
+ *
+ * Every path keeps its own random number state, so the result is the same
+ * as kernel_path_trace() gives, only the order of the work differs. */
+
+CCL_NAMESPACE_BEGIN
+
+ccl_device_inline uint kernel_path_stream_expand_bits(uint v)
+{
+	/* spread the lower 10 bits, leaving two zero bits between each */
+	v = (v * 0x00010001u) & 0xFF0000FFu;
+	v = (v * 0x00000101u) & 0x0F00F00Fu;
+	v = (v * 0x00000011u) & 0xC30C30C3u;
+	v = (v * 0x00000005u) & 0x49249249u;
+	return v;
+}
+
+ccl_device_inline uint kernel_path_stream_key(float3 P, float3 D, float3 bmin, float3 inv_extent)
+{
+	/* direction octant in the highest bits, then the ray origin as a morton
+	 * code of 9 bits per axis within the bounds of all origins */
+	uint octant = ((D.x < 0.0f)? 1: 0) | ((D.y < 0.0f)? 2: 0) | ((D.z < 0.0f)? 4: 0);
+	float3 co = (P - bmin)*inv_extent;
+
+	uint x = (uint)(fminf(fmaxf(co.x, 0.0f), 1.0f)*511.0f);
+	uint y = (uint)(fminf(fmaxf(co.y, 0.0f), 1.0f)*511.0f);
+	uint z = (uint)(fminf(fmaxf(co.z, 0.0f), 1.0f)*511.0f);
+
+	return (octant << 27) |
+	       (kernel_path_stream_expand_bits(x) << 2) |
+	       (kernel_path_stream_expand_bits(y) << 1) |
+	       kernel_path_stream_expand_bits(z);
+}
+
+/* Sort the active paths by the key of their current ray, using a radix sort
+ * over the 30 bits of the key. */
+ccl_device void kernel_path_stream_sort(PathStream *stream, int num_active)
+{
+	float3 bmin = make_float3(FLT_MAX, FLT_MAX, FLT_MAX);
+	float3 bmax = make_float3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+	for(int i = 0; i < num_active; i++) {
+		float3 P = stream->paths[stream->order[i]].ray.P;
+
+		bmin = min(bmin, P);
+		bmax = max(bmax, P);
+	}
+
+	float3 extent = bmax - bmin;
+	float3 inv_extent = make_float3((extent.x > 0.0f)? 1.0f/extent.x: 0.0f,
+	                                (extent.y > 0.0f)? 1.0f/extent.y: 0.0f,
+	                                (extent.z > 0.0f)? 1.0f/extent.z: 0.0f);
+
+	uint *key = stream->key, *key_tmp = stream->key_tmp;
+	int *order = stream->order, *order_tmp = stream->order_tmp;
+
+	for(int i = 0; i < num_active; i++) {
+		Ray *ray = &stream->paths[order[i]].ray;
+		key[i] = kernel_path_stream_key(ray->P, ray->D, bmin, inv_extent);
+	}
+
+	for(int shift = 0; shift < 30; shift += 10) {
+		int offset[1024];
+
+		for(int b = 0; b < 1024; b++)
+			offset[b] = 0;
+		for(int i = 0; i < num_active; i++)
+			offset[(key[i] >> shift) & 1023]++;
+
+		for(int b = 0, sum = 0; b < 1024; b++) {
+			int count = offset[b];
+			offset[b] = sum;
+			sum += count;
+		}
+
+		for(int i = 0; i < num_active; i++) {
+			int j = offset[(key[i] >> shift) & 1023]++;
+			key_tmp[j] = key[i];
+			order_tmp[j] = order[i];
+		}
+
+		uint *key_swap = key; key = key_tmp; key_tmp = key_swap;
+		int *order_swap = order; order = order_tmp; order_tmp = order_swap;
+	}
+
+	/* odd number of passes, copy sorted order back */
+	for(int i = 0; i < num_active; i++)
+		stream->order[i] = order[i];
+}
+
+ccl_device_inline void kernel_path_stream_intersect(KernelGlobals *kg, PathStreamState *p)
+{
+	p->hit = kernel_path_scene_intersect(kg, &p->rng, &p->state, &p->ray, &p->isect);
+
+#ifdef __KERNEL_DEBUG__
+	if(p->state.flag & PATH_RAY_CAMERA) {
+		p->debug_data.num_bvh_traversal_steps += p->isect.num_traversal_steps;
+		p->debug_data.num_bvh_traversed_instances += p->isect.num_traversed_instances;
+	}
+	p->debug_data.num_ray_bounces++;
+#endif
+}
+
+#ifdef __SUBSURFACE__
+
+/* Indirect subsurface rays are traced one path at a time, as
+ * kernel_path_integrate() does, so that the stream does not have to keep
+ * their state for every path. */
+ccl_device_noinline void kernel_path_stream_subsurface(KernelGlobals *kg,
+                                                       PathStreamState *p,
+                                                       SubsurfaceIndirectRays *ss_indirect,
+                                                       ccl_global float *buffer,
+                                                       int sample)
+{
+	for(;;) {
+		kernel_path_subsurface_accum_indirect(ss_indirect, &p->L);
+
+		if(!ss_indirect->num_rays)
+			break;
+
+		kernel_path_subsurface_setup_indirect(kg,
+		                                      ss_indirect,
+		                                      &p->state,
+		                                      &p->ray,
+		                                      &p->L,
+		                                      &p->throughput);
+
+		do {
+			kernel_path_stream_intersect(kg, p);
+		} while(kernel_path_integrate_bounce(kg, &p->rng, sample, &p->state, &p->ray, &p->isect, p->hit,
+		                                     &p->L, &p->throughput, &p->L_transparent, buffer, ss_indirect));
+	}
+}
+
+#endif  /* __SUBSURFACE__ */
+
+ccl_device_inline void kernel_path_stream_write(KernelGlobals *kg,
+                                                ccl_global float *buffer,
+                                                ccl_global uint *rng_state,
+                                                int sample,
+                                                RNG rng,
+                                                float4 L)
+{
+	/* accumulate result in output buffer */
+	kernel_write_pass_float4(buffer, sample, L);
+	kernel_write_denoising_variance(kg, buffer, sample, L);
+
+	path_rng_end(kg, rng_state, rng);
+}
+
+ccl_device void kernel_path_trace_stream(KernelGlobals *kg,
+	ccl_global float *buffer, ccl_global uint *rng_state,
+	int sample, int x, int y, int w, int h, int offset, int stride,
+	PathStream *stream)
+{
+	int pass_stride = kernel_data.film.pass_stride;
+	int num_pixels = w*h;
+
+	for(int first = 0; first < num_pixels; first += PATH_STREAM_SIZE) {
+		int num_paths = min(num_pixels - first, PATH_STREAM_SIZE);
+		int num_active = 0;
+
+		/* initialize camera rays */
+		for(int i = 0; i < num_paths; i++) {
+			PathStreamState *p = &stream->paths[i];
+
+			p->x = x + (first + i) % w;
+			p->y = y + (first + i) / w;
+
+			int index = offset + p->x + p->y*stride;
+
+			kernel_path_trace_setup(kg, rng_state + index, sample, p->x, p->y, &p->rng, &p->ray);
+
+			if(p->ray.t == 0.0f) {
+				kernel_path_stream_write(kg, buffer + index*pass_stride, rng_state + index,
+				                         sample, p->rng, make_float4(0.0f, 0.0f, 0.0f, 0.0f));
+				continue;
+			}
+
+			path_radiance_init(&p->L, kernel_data.film.use_light_pass);
+			path_state_init(kg, &p->state, &p->rng, sample, &p->ray);
+			p->throughput = make_float3(1.0f, 1.0f, 1.0f);
+			p->L_transparent = 0.0f;
+
+#ifdef __KERNEL_DEBUG__
+			debug_data_init(&p->debug_data);
+#endif
+
+			stream->order[num_active++] = i;
+		}
+
+		/* path iteration, one bounce of all active paths at a time */
+		while(num_active) {
+			kernel_path_stream_sort(stream, num_active);
+
+			/* intersect scene */
+			for(int i = 0; i < num_active; i++)
+				kernel_path_stream_intersect(kg, &stream->paths[stream->order[i]]);
+
+			/* shade in the same order, keeping the paths that continue */
+			int num_next = 0;
+
+			for(int i = 0; i < num_active; i++) {
+				PathStreamState *p = &stream->paths[stream->order[i]];
+				int index = offset + p->x + p->y*stride;
+				ccl_global float *path_buffer = buffer + index*pass_stride;
+
+#ifdef __SUBSURFACE__
+				SubsurfaceIndirectRays ss_indirect;
+				kernel_path_subsurface_init_indirect(&ss_indirect);
+#endif
+
+				if(kernel_path_integrate_bounce(kg, &p->rng, sample, &p->state, &p->ray, &p->isect, p->hit,
+				                                &p->L, &p->throughput, &p->L_transparent, path_buffer
+#ifdef __SUBSURFACE__
+				                              , &ss_indirect
+#endif
+				                                ))
+				{
+					stream->order[num_next++] = stream->order[i];
+					continue;
+				}
+
+#ifdef __SUBSURFACE__
+				kernel_path_stream_subsurface(kg, p, &ss_indirect, path_buffer, sample);
+#endif
+
+				float3 L_sum = path_radiance_clamp_and_sum(kg, &p->L);
+
+				kernel_write_light_passes(kg, path_buffer, &p->L, sample);
+
+#ifdef __KERNEL_DEBUG__
+				kernel_write_debug_passes(kg, path_buffer, &p->state, &p->debug_data, sample);
+#endif
+
+				kernel_path_stream_write(kg, path_buffer, rng_state + index, sample, p->rng,
+				                         make_float4(L_sum.x, L_sum.y, L_sum.z, 1.0f - p->L_transparent));
+			}
+
+			num_active = num_next;
+		}
+	}
+}
+
+CCL_NAMESPACE_END
+
@@ -1016,6 +1016,10 @@ ccl_device void shader_eval_volume(KernelGlobals *kg, ShaderData *sd,
 			 * caching matrices instead of recomputing them each step */
 			shader_setup_object_transforms(kg, sd, sd->time);
 #endif
+
+			/* skip empty space of voxel attributes */
+			if((sd->flag & SD_HETEROGENEOUS_VOLUME) && !volume_grid_occupied(kg, sd))
+				continue;
 		}
 
 		/* evaluate shader */
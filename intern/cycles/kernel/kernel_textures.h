@@ -39,6 +39,7 @@ KERNEL_TEX(float4, texture_float4, __objects_vector)
 /* triangles */
 KERNEL_TEX(uint, texture_uint, __tri_shader)
 KERNEL_TEX(float4, texture_float4, __tri_vnormal)
+KERNEL_TEX(uint, texture_uint, __tri_vnormal_packed)
 KERNEL_TEX(float4, texture_float4, __tri_vindex)
 KERNEL_TEX(float4, texture_float4, __tri_verts)
 
@@ -52,6 +53,9 @@ KERNEL_TEX(float, texture_float, __attributes_float)
 KERNEL_TEX(float4, texture_float4, __attributes_float3)
 KERNEL_TEX(uchar4, texture_uchar4, __attributes_uchar4)
 
+/* volumes */
+KERNEL_TEX(uint, texture_uint, __volume_grid)
+
 /* lights */
 KERNEL_TEX(float4, texture_float4, __light_distribution)
 KERNEL_TEX(float4, texture_float4, __light_data)
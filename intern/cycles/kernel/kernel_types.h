@@ -60,6 +60,9 @@ CCL_NAMESPACE_BEGIN
 #  ifdef __KERNEL_SSE2__
 #    define __QBVH__
 #  endif
+#  ifdef __KERNEL_AVX2__
+#    define __OBVH__
+#  endif
 #  define __KERNEL_SHADING__
 #  define __KERNEL_ADV_SHADING__
 #  define __BRANCHED_PATH__
@@ -347,6 +350,7 @@ typedef enum PassType {
 	PASS_BVH_TRAVERSED_INSTANCES = (1 << 27),
 	PASS_RAY_BOUNCES = (1 << 28),
 #endif
+	PASS_DENOISING = (1 << 29), /* no Blender pass, features used by the denoiser */
 } PassType;
 
 #define PASS_ALL (~0)
@@ -1005,7 +1009,7 @@ typedef struct KernelFilm {
 	int pass_shadow;
 	float pass_shadow_scale;
 	int filter_table_offset;
-	int pass_pad2;
+	int pass_denoising;
 
 	int pass_mist;
 	float mist_start;
@@ -1113,7 +1117,8 @@ typedef struct KernelBVH {
 	int have_curves;
 	int have_instancing;
 	int use_qbvh;
-	int pad1, pad2;
+	int use_obvh;
+	int use_compact_geometry;
 } KernelBVH;
 
 typedef enum CurveFlag {
@@ -1160,6 +1165,43 @@ typedef ccl_addr_space struct DebugData {
 } DebugData;
 #endif
 
+/* Declarations required for the CPU ray stream kernel */
+
+#ifdef __KERNEL_CPU__
+
+/* Number of paths which are traced together by one thread. */
+#define PATH_STREAM_SIZE 1024
+
+/* State of one path in the stream, kept between its bounces. */
+typedef struct PathStreamState {
+	PathRadiance L;
+	PathState state;
+	Ray ray;
+	Intersection isect;
+	float3 throughput;
+	float L_transparent;
+	RNG rng;
+	int x, y;
+	bool hit;
+#ifdef __KERNEL_DEBUG__
+	DebugData debug_data;
+#endif
+} PathStreamState;
+
+typedef struct PathStream {
+	PathStreamState paths[PATH_STREAM_SIZE];
+
+	/* Indices of the active paths in traversal order, and scratch memory
+	 * for sorting them.
+	 */
+	int order[PATH_STREAM_SIZE];
+	int order_tmp[PATH_STREAM_SIZE];
+	uint key[PATH_STREAM_SIZE];
+	uint key_tmp[PATH_STREAM_SIZE];
+} PathStream;
+
+#endif  /* __KERNEL_CPU__ */
+
 /* Declarations required for split kernel */
 
 /* Macro for queues */
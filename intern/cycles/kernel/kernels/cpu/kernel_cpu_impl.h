@@ -27,6 +27,7 @@
 #include "kernel_film.h"
 #include "kernel_path.h"
 #include "kernel_path_branched.h"
+#include "kernel_path_stream.h"
 #include "kernel_bake.h"
 
 CCL_NAMESPACE_BEGIN
@@ -58,6 +59,46 @@ void KERNEL_FUNCTION_FULL_NAME(path_trace)(KernelGlobals *kg,
 	}
 }
 
+void KERNEL_FUNCTION_FULL_NAME(path_trace_stream)(KernelGlobals *kg,
+                                                  PathStream *stream,
+                                                  float *buffer,
+                                                  unsigned int *rng_state,
+                                                  int sample,
+                                                  int x, int y,
+                                                  int w, int h,
+                                                  int offset,
+                                                  int stride)
+{
+#ifdef __BRANCHED_PATH__
+	if(kernel_data.integrator.branched) {
+		/* branched paths are not streamed */
+		for(int py = y; py < y + h; py++) {
+			for(int px = x; px < x + w; px++) {
+				kernel_branched_path_trace(kg,
+				                           buffer,
+				                           rng_state,
+				                           sample,
+				                           px, py,
+				                           offset,
+				                           stride);
+			}
+		}
+	}
+	else
+#endif
+	{
+		kernel_path_trace_stream(kg,
+		                         buffer,
+		                         rng_state,
+		                         sample,
+		                         x, y,
+		                         w, h,
+		                         offset,
+		                         stride,
+		                         stream);
+	}
+}
+
 /* Film */
 
 void KERNEL_FUNCTION_FULL_NAME(convert_to_byte)(KernelGlobals *kg,
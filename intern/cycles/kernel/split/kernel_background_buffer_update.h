@@ -174,6 +174,7 @@ ccl_device char kernel_background_buffer_update(
 
 		/* accumulate result in output buffer */
 		kernel_write_pass_float4(per_sample_output_buffers, sample, L_rad);
+		kernel_write_denoising_variance(kg, per_sample_output_buffers, sample, L_rad);
 		path_rng_end(kg, rng_state, *rng);
 
 		ASSIGN_RAY_STATE(ray_state, ray_index, RAY_TO_REGENERATE);
@@ -237,6 +238,7 @@ ccl_device char kernel_background_buffer_update(
 				float4 L_rad = make_float4(0.0f, 0.0f, 0.0f, 0.0f);
 				/* Accumulate result in output buffer. */
 				kernel_write_pass_float4(per_sample_output_buffers, sample, L_rad);
+				kernel_write_denoising_variance(kg, per_sample_output_buffers, sample, L_rad);
 				path_rng_end(kg, rng_state, *rng);
 
 				ASSIGN_RAY_STATE(ray_state, ray_index, RAY_TO_REGENERATE);
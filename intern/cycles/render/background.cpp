@@ -18,6 +18,7 @@
 #include "device.h"
 #include "integrator.h"
 #include "graph.h"
+#include "light.h"
 #include "nodes.h"
 #include "scene.h"
 #include "shader.h"
@@ -117,6 +118,7 @@ bool Background::modified(const Background& background)
 void Background::tag_update(Scene *scene)
 {
 	scene->integrator->tag_update(scene);
+	scene->light_manager->need_update_background = true;
 	need_update = true;
 }
 
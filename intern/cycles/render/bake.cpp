@@ -97,7 +97,6 @@ uint4 BakeData::differentials(int i)
 
 BakeManager::BakeManager()
 {
-	m_bake_data = NULL;
 	m_is_baking = false;
 	need_update = true;
 	m_shader_limit = 512 * 512;
@@ -105,8 +104,6 @@ BakeManager::BakeManager()
 
 BakeManager::~BakeManager()
 {
-	if(m_bake_data)
-		delete m_bake_data;
 }
 
 bool BakeManager::get_baking()
@@ -119,12 +116,6 @@ void BakeManager::set_baking(const bool value)
 	m_is_baking = value;
 }
 
-BakeData *BakeManager::init(const int object, const size_t tri_offset, const size_t num_pixels)
-{
-	m_bake_data = new BakeData(object, tri_offset, num_pixels);
-	return m_bake_data;
-}
-
 void BakeManager::set_shader_limit(const size_t x, const size_t y)
 {
 	m_shader_limit = x * y;
@@ -138,9 +129,27 @@ bool BakeManager::bake(Device *device, DeviceScene *dscene, Scene *scene, Progre
 	progress.reset_sample();
 	this->num_parts = 0;
 
+	/* only pixels covered by the object are sent to the device, so empty
+	 * regions of the image neither take up device memory nor leave threads
+	 * idle while others are still shading the actual surface */
+	vector<size_t> pixels;
+	pixels.reserve(num_pixels);
+
+	for(size_t i = 0; i < num_pixels; i++) {
+		if(bake_data->is_valid(i))
+			pixels.push_back(i);
+	}
+
+	size_t num_valid = pixels.size();
+
+	if(num_valid == 0) {
+		m_is_baking = false;
+		return false;
+	}
+
 	/* calculate the total parts for the progress bar */
-	for(size_t shader_offset = 0; shader_offset < num_pixels; shader_offset += m_shader_limit) {
-		size_t shader_size = (size_t)fminf(num_pixels - shader_offset, m_shader_limit);
+	for(size_t shader_offset = 0; shader_offset < num_valid; shader_offset += m_shader_limit) {
+		size_t shader_size = (size_t)fminf(num_valid - shader_offset, m_shader_limit);
 
 		DeviceTask task(DeviceTask::SHADER);
 		task.shader_w = shader_size;
@@ -150,8 +159,11 @@ bool BakeManager::bake(Device *device, DeviceScene *dscene, Scene *scene, Progre
 
 	this->num_samples = is_aa_pass(shader_type)? scene->integrator->aa_samples : 1;
 
-	for(size_t shader_offset = 0; shader_offset < num_pixels; shader_offset += m_shader_limit) {
-		size_t shader_size = (size_t)fminf(num_pixels - shader_offset, m_shader_limit);
+	/* needs to be up to data for attribute access */
+	device->const_copy_to("__data", &dscene->data, sizeof(dscene->data));
+
+	for(size_t shader_offset = 0; shader_offset < num_valid; shader_offset += m_shader_limit) {
+		size_t shader_size = (size_t)fminf(num_valid - shader_offset, m_shader_limit);
 
 		/* setup input for device task */
 		device_vector<uint4> d_input;
@@ -159,22 +171,14 @@ bool BakeManager::bake(Device *device, DeviceScene *dscene, Scene *scene, Progre
 		size_t d_input_size = 0;
 
 		for(size_t i = shader_offset; i < (shader_offset + shader_size); i++) {
-			d_input_data[d_input_size++] = bake_data->data(i);
-			d_input_data[d_input_size++] = bake_data->differentials(i);
-		}
-
-		if(d_input_size == 0) {
-			m_is_baking = false;
-			return false;
+			d_input_data[d_input_size++] = bake_data->data(pixels[i]);
+			d_input_data[d_input_size++] = bake_data->differentials(pixels[i]);
 		}
 
 		/* run device task */
 		device_vector<float4> d_output;
 		d_output.resize(shader_size);
 
-		/* needs to be up to data for attribute access */
-		device->const_copy_to("__data", &dscene->data, sizeof(dscene->data));
-
 		device->mem_alloc(d_input, MEM_READ_ONLY);
 		device->mem_copy_to(d_input);
 		device->mem_alloc(d_output, MEM_WRITE_ONLY);
@@ -206,19 +210,15 @@ bool BakeManager::bake(Device *device, DeviceScene *dscene, Scene *scene, Progre
 		device->mem_free(d_output);
 
 		/* read result */
-		int k = 0;
-
 		float4 *offset = (float4*)d_output.data_pointer;
 
 		size_t depth = 4;
-		for(size_t i=shader_offset; i < (shader_offset + shader_size); i++) {
-			size_t index = i * depth;
-			float4 out = offset[k++];
-
-			if(bake_data->is_valid(i)) {
-				for(size_t j=0; j < 4; j++) {
-					result[index + j] = out[j];
-				}
+		for(size_t i = 0; i < shader_size; i++) {
+			size_t index = pixels[shader_offset + i] * depth;
+			float4 out = offset[i];
+
+			for(size_t j=0; j < 4; j++) {
+				result[index + j] = out[j];
 			}
 		}
 	}
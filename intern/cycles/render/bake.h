@@ -59,8 +59,6 @@ public:
 	bool get_baking();
 	void set_baking(const bool value);
 
-	BakeData *init(const int object, const size_t tri_offset, const size_t num_pixels);
-
 	void set_shader_limit(const size_t x, const size_t y);
 
 	bool bake(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress, ShaderEvalType shader_type, const int pass_filter, BakeData *bake_data, float result[]);
@@ -77,7 +75,6 @@ public:
 	int num_parts;
 
 private:
-	BakeData *m_bake_data;
 	bool m_is_baking;
 	size_t m_shader_limit;
 };
@@ -156,6 +156,16 @@ bool RenderBuffers::copy_from_device()
 	return true;
 }
 
+bool RenderBuffers::copy_to_device()
+{
+	if(!buffer.device_pointer)
+		return false;
+
+	device->mem_copy_to(buffer);
+
+	return true;
+}
+
 bool RenderBuffers::get_pass_rect(PassType type, float exposure, int sample, int components, float *pixels)
 {
 	int pass_offset = 0;
@@ -249,7 +259,18 @@ bool RenderBuffers::get_pass_rect(PassType type, float exposure, int sample, int
 			}
 			else {
 				/* RGB/vector */
-				for(int i = 0; i < size; i++, in += pass_stride, pixels += 3) {
+				int i = 0;
+
+#ifdef __KERNEL_SSE2__
+				/* the fourth written value is overwritten by the next pixel,
+				 * so the last pixel is left for the scalar loop below */
+				const ssef sse_scale = ssef(scale_exposure);
+
+				for(; i < size - 1; i++, in += pass_stride, pixels += 3)
+					storeu4f(pixels, loadu4f(in) * sse_scale);
+#endif
+
+				for(; i < size; i++, in += pass_stride, pixels += 3) {
 					float3 f = make_float3(in[0], in[1], in[2]);
 
 					pixels[0] = f.x*scale_exposure;
@@ -296,6 +317,16 @@ bool RenderBuffers::get_pass_rect(PassType type, float exposure, int sample, int
 				}
 			}
 			else {
+#ifdef __KERNEL_SSE2__
+				const ssef sse_scale = ssef(scale_exposure, scale_exposure, scale_exposure, scale);
+
+				for(int i = 0; i < size; i++, in += pass_stride, pixels += 4) {
+					storeu4f(pixels, loadu4f(in) * sse_scale);
+
+					/* clamp since alpha might be > 1.0 due to russian roulette */
+					pixels[3] = saturate(pixels[3]);
+				}
+#else
 				for(int i = 0; i < size; i++, in += pass_stride, pixels += 4) {
 					float4 f = make_float4(in[0], in[1], in[2], in[3]);
 
@@ -306,6 +337,7 @@ bool RenderBuffers::get_pass_rect(PassType type, float exposure, int sample, int
 					/* clamp since alpha might be > 1.0 due to russian roulette */
 					pixels[3] = saturate(f.w*scale);
 				}
+#endif
 			}
 		}
 
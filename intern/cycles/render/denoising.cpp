@@ -0,0 +1,415 @@
+/*
+ * Copyright 2011-2016 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "buffers.h"
+#include "denoising.h"
+
+#include "util_color.h"
+#include "util_foreach.h"
+#include "util_function.h"
+#include "util_math.h"
+#include "util_task.h"
+#include "util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Feature Guided Non-Local Means
+ *
+ * Every pixel is replaced by a weighted average of the pixels in a window
+ * around it. The color part of the weight compares small patches around both
+ * pixels, with squared differences normalized by the estimated variance of the
+ * pixels, so that noise alone does not keep pixels apart. The feature part
+ * compares normal, albedo and depth at the first hit, which have little noise
+ * and keep geometry and texture edges sharp.
+ *
+ * Tiles are denoised together with their neighbors, so the window and the
+ * patches reach across tile borders and the result has no seams. Only the
+ * frame border clips the window. */
+
+#define DENOISE_PATCH_RADIUS 2
+
+/* feature differences at which the weight drops by a factor e at the default
+ * feature strength, depth difference is relative to the depth of the pixel */
+#define DENOISE_NORMAL_SIGMA 0.2f
+#define DENOISE_ALBEDO_SIGMA 0.1f
+#define DENOISE_DEPTH_SIGMA 0.05f
+
+/* distance of pixels which must never be mixed, finite to avoid NaN */
+#define DENOISE_INVALID_DISTANCE 1e10f
+
+static int denoise_pass_offset(const BufferParams& params, PassType type)
+{
+	int offset = 0;
+
+	foreach(const Pass& pass, params.passes) {
+		if(pass.type == type)
+			return offset;
+
+		offset += pass.components;
+	}
+
+	return -1;
+}
+
+/* Pixel means gathered from the buffers of one or more tiles, pixels which
+ * are not covered by any tile are invalid. */
+struct DenoiseImage {
+	int x, y, w, h;
+
+	vector<float3> color;
+	vector<float3> normal;
+	vector<float3> albedo;
+	vector<float> depth;
+	vector<float> variance;
+	vector<bool> valid;
+};
+
+static void denoise_image_init(DenoiseImage& image, int x, int y, int w, int h)
+{
+	const int size = w*h;
+
+	image.x = x;
+	image.y = y;
+	image.w = w;
+	image.h = h;
+
+	image.color.assign(size, make_float3(0.0f, 0.0f, 0.0f));
+	image.normal.assign(size, make_float3(0.0f, 0.0f, 0.0f));
+	image.albedo.assign(size, make_float3(0.0f, 0.0f, 0.0f));
+	image.depth.assign(size, 0.0f);
+	image.variance.assign(size, 0.0f);
+	image.valid.assign(size, false);
+}
+
+static bool denoise_buffers_usable(RenderBuffers *buffers)
+{
+	const BufferParams& buffer_params = buffers->params;
+
+	return denoise_pass_offset(buffer_params, PASS_COMBINED) != -1 &&
+	       denoise_pass_offset(buffer_params, PASS_DENOISING) != -1 &&
+	       buffer_params.width*buffer_params.height != 0 &&
+	       buffers->buffer.data_pointer != 0;
+}
+
+/* Copy the pixels of the buffers which overlap the image. */
+static void denoise_image_gather(DenoiseImage& image, RenderBuffers *buffers, int sample)
+{
+	BufferParams& buffer_params = buffers->params;
+
+	const int combined_offset = denoise_pass_offset(buffer_params, PASS_COMBINED);
+	const int features_offset = denoise_pass_offset(buffer_params, PASS_DENOISING);
+	const int pass_stride = buffer_params.get_passes_size();
+	const float inv_sample = 1.0f/sample;
+	const float *buffer = (const float*)buffers->buffer.data_pointer;
+
+	const int x0 = max(image.x, buffer_params.full_x);
+	const int x1 = min(image.x + image.w, buffer_params.full_x + buffer_params.width);
+	const int y0 = max(image.y, buffer_params.full_y);
+	const int y1 = min(image.y + image.h, buffer_params.full_y + buffer_params.height);
+
+	for(int y = y0; y < y1; y++) {
+		for(int x = x0; x < x1; x++) {
+			const int i = (y - image.y)*image.w + (x - image.x);
+			const int b = (y - buffer_params.full_y)*buffer_params.width + (x - buffer_params.full_x);
+
+			const float *pixel = buffer + b*pass_stride;
+			const float *combined = pixel + combined_offset;
+			const float *features = pixel + features_offset;
+
+			float3 color = make_float3(combined[0], combined[1], combined[2]) * inv_sample;
+			float3 normal = make_float3(features[0], features[1], features[2]) * inv_sample;
+			float depth = features[3] * inv_sample;
+			float3 albedo = make_float3(features[4], features[5], features[6]) * inv_sample;
+
+			/* variance of the mean, from the mean of squared sample luminance */
+			float luminance = linear_rgb_to_gray(color);
+			float sample_variance = max(features[7] * inv_sample - luminance*luminance, 0.0f);
+			float variance = sample_variance / max(sample - 1, 1);
+
+			bool valid = isfinite(color.x) && isfinite(color.y) && isfinite(color.z) &&
+			             isfinite(variance) && isfinite(depth) &&
+			             isfinite(normal.x) && isfinite(normal.y) && isfinite(normal.z) &&
+			             isfinite(albedo.x) && isfinite(albedo.y) && isfinite(albedo.z);
+
+			/* invalid pixels are left untouched and never mixed into other pixels */
+			if(valid) {
+				image.color[i] = color;
+				image.normal[i] = normal;
+				image.albedo[i] = albedo;
+				image.depth[i] = depth;
+				image.variance[i] = variance;
+			}
+
+			image.valid[i] = valid;
+		}
+	}
+}
+
+/* Average of the patch around every pixel in the ox0..ox1, oy0..oy1 rectangle,
+ * patches are clipped to the x0..x1, y0..y1 rectangle which contains it. */
+static void denoise_patch_filter(const float *in, float *tmp, float *out, int w,
+                                 int x0, int x1, int y0, int y1,
+                                 int ox0, int ox1, int oy0, int oy1)
+{
+	const int r = DENOISE_PATCH_RADIUS;
+
+	for(int y = max(oy0 - r, y0); y < min(oy1 + r, y1); y++) {
+		for(int x = ox0; x < ox1; x++) {
+			int lo = max(x - r, x0), hi = min(x + r + 1, x1);
+			float sum = 0.0f;
+
+			for(int i = lo; i < hi; i++)
+				sum += in[y*w + i];
+
+			tmp[y*w + x] = sum / (float)(hi - lo);
+		}
+	}
+
+	for(int y = oy0; y < oy1; y++) {
+		int lo = max(y - r, y0), hi = min(y + r + 1, y1);
+		float inv_num = 1.0f / (float)(hi - lo);
+
+		for(int x = ox0; x < ox1; x++) {
+			float sum = 0.0f;
+
+			for(int i = lo; i < hi; i++)
+				sum += tmp[i*w + x];
+
+			out[y*w + x] = sum * inv_num;
+		}
+	}
+}
+
+/* Denoise the pixels of the image inside the given rectangle, which is in
+ * image coordinates. Pixels outside of it only take part in the search. */
+static void denoise_image_filter(const DenoiseImage& image, const DenoiseParams& params,
+                                 int rx, int ry, int rw, int rh,
+                                 vector<float3>& result, vector<bool>& result_valid)
+{
+	const int w = image.w;
+	const int h = image.h;
+	const int size = w*h;
+	const int r = DENOISE_PATCH_RADIUS;
+
+	const vector<float3>& color = image.color;
+	const vector<float3>& normal = image.normal;
+	const vector<float3>& albedo = image.albedo;
+	const vector<float>& depth = image.depth;
+	const vector<float>& variance = image.variance;
+	const vector<bool>& valid = image.valid;
+
+	const float k2 = params.strength * params.strength;
+	const float feature_scale = 2.0f * params.feature_strength;
+	const float inv_normal_sigma2 = 1.0f/(DENOISE_NORMAL_SIGMA*DENOISE_NORMAL_SIGMA);
+	const float inv_albedo_sigma2 = 1.0f/(DENOISE_ALBEDO_SIGMA*DENOISE_ALBEDO_SIGMA);
+	const float inv_depth_sigma2 = 1.0f/(DENOISE_DEPTH_SIGMA*DENOISE_DEPTH_SIGMA);
+
+	vector<float3> accum(size, make_float3(0.0f, 0.0f, 0.0f));
+	vector<float> weight_sum(size, 0.0f);
+	vector<float> distance(size);
+	vector<float> distance_tmp(size);
+	vector<float> patch_distance(size);
+
+	for(int dy = -params.radius; dy <= params.radius; dy++) {
+		for(int dx = -params.radius; dx <= params.radius; dx++) {
+			/* pixels which have a neighbor at this offset */
+			const int x0 = max(0, -dx), x1 = min(w, w - dx);
+			const int y0 = max(0, -dy), y1 = min(h, h - dy);
+			const int offset = dy*w + dx;
+
+			/* pixels to denoise, and the pixels their patches cover */
+			const int ox0 = max(x0, rx), ox1 = min(x1, rx + rw);
+			const int oy0 = max(y0, ry), oy1 = min(y1, ry + rh);
+			const int px0 = max(x0, ox0 - r), px1 = min(x1, ox1 + r);
+			const int py0 = max(y0, oy0 - r), py1 = min(y1, oy1 + r);
+
+			if(ox0 >= ox1 || oy0 >= oy1)
+				continue;
+
+			/* squared color difference with the expected difference due to
+			 * noise cancelled out, normalized by the variance */
+			for(int y = py0; y < py1; y++) {
+				for(int x = px0; x < px1; x++) {
+					int p = y*w + x, q = p + offset;
+
+					if(!valid[p] || !valid[q]) {
+						distance[p] = DENOISE_INVALID_DISTANCE;
+						continue;
+					}
+
+					float3 diff = color[p] - color[q];
+					float var_p = variance[p], var_q = variance[q];
+					float var_cancel = var_p + min(var_p, var_q);
+					float inv_norm = 1.0f/(1e-10f + k2*(var_p + var_q));
+
+					float d = (diff.x*diff.x - var_cancel) +
+					          (diff.y*diff.y - var_cancel) +
+					          (diff.z*diff.z - var_cancel);
+
+					distance[p] = min(d * inv_norm * (1.0f/3.0f), DENOISE_INVALID_DISTANCE);
+				}
+			}
+
+			denoise_patch_filter(&distance[0], &distance_tmp[0], &patch_distance[0], w,
+			                     x0, x1, y0, y1, ox0, ox1, oy0, oy1);
+
+			/* accumulate weighted neighbors */
+			for(int y = oy0; y < oy1; y++) {
+				for(int x = ox0; x < ox1; x++) {
+					int p = y*w + x, q = p + offset;
+					float d = max(patch_distance[p], 0.0f);
+
+					if(feature_scale > 0.0f) {
+						float3 dn = normal[p] - normal[q];
+						float3 da = albedo[p] - albedo[q];
+						float dd = depth[p] - depth[q];
+
+						float feature_distance = dot(dn, dn) * inv_normal_sigma2 +
+						                         dot(da, da) * inv_albedo_sigma2 +
+						                         dd*dd * inv_depth_sigma2 / (depth[p]*depth[p] + 1e-10f);
+
+						d += feature_scale * feature_distance;
+					}
+
+					float weight = expf(-d);
+
+					accum[p] += weight * color[q];
+					weight_sum[p] += weight;
+				}
+			}
+		}
+	}
+
+	/* denoised means of the rectangle */
+	result.resize(rw*rh);
+	result_valid.resize(rw*rh);
+
+	for(int y = 0; y < rh; y++) {
+		for(int x = 0; x < rw; x++) {
+			int p = (ry + y)*w + (rx + x);
+
+			result_valid[y*rw + x] = valid[p] && weight_sum[p] != 0.0f;
+
+			if(result_valid[y*rw + x])
+				result[y*rw + x] = accum[p] / weight_sum[p];
+		}
+	}
+}
+
+/* Denoise one tile, using the pixels of all tiles within the search window. */
+static void denoise_tile(const vector<RenderBuffers*> *tiles, int index, int sample,
+                         const DenoiseParams *params,
+                         vector<float3> *result, vector<bool> *result_valid)
+{
+	const BufferParams& tile_params = (*tiles)[index]->params;
+	const int border = params->radius + DENOISE_PATCH_RADIUS;
+
+	/* the search window and the patches may reach into neighboring tiles, the
+	 * image is clipped to the frame by the tiles which exist */
+	int x0 = tile_params.full_x - border, x1 = tile_params.full_x + tile_params.width + border;
+	int y0 = tile_params.full_y - border, y1 = tile_params.full_y + tile_params.height + border;
+	int fx0 = x1, fx1 = x0, fy0 = y1, fy1 = y0;
+
+	foreach(RenderBuffers *buffers, *tiles) {
+		const BufferParams& buffer_params = buffers->params;
+
+		fx0 = min(fx0, buffer_params.full_x);
+		fy0 = min(fy0, buffer_params.full_y);
+		fx1 = max(fx1, buffer_params.full_x + buffer_params.width);
+		fy1 = max(fy1, buffer_params.full_y + buffer_params.height);
+	}
+
+	x0 = max(x0, fx0); x1 = min(x1, fx1);
+	y0 = max(y0, fy0); y1 = min(y1, fy1);
+
+	DenoiseImage image;
+	denoise_image_init(image, x0, y0, x1 - x0, y1 - y0);
+
+	foreach(RenderBuffers *buffers, *tiles) {
+		const BufferParams& buffer_params = buffers->params;
+
+		if(buffer_params.full_x < x1 && buffer_params.full_x + buffer_params.width > x0 &&
+		   buffer_params.full_y < y1 && buffer_params.full_y + buffer_params.height > y0)
+		{
+			denoise_image_gather(image, buffers, sample);
+		}
+	}
+
+	denoise_image_filter(image, *params,
+	                     tile_params.full_x - x0, tile_params.full_y - y0,
+	                     tile_params.width, tile_params.height,
+	                     *result, *result_valid);
+}
+
+bool denoise_render_tiles(const vector<RenderBuffers*>& tiles, int sample, const DenoiseParams& params)
+{
+	if(sample < 1 || tiles.size() == 0)
+		return false;
+
+	foreach(RenderBuffers *buffers, tiles)
+		if(!denoise_buffers_usable(buffers))
+			return false;
+
+	/* all tiles are read while denoising, so results are only written back
+	 * once every tile is done */
+	vector<vector<float3> > results(tiles.size());
+	vector<vector<bool> > results_valid(tiles.size());
+
+	if(tiles.size() == 1) {
+		denoise_tile(&tiles, 0, sample, &params, &results[0], &results_valid[0]);
+	}
+	else {
+		TaskPool pool;
+
+		for(size_t i = 0; i < tiles.size(); i++)
+			pool.push(function_bind(&denoise_tile, &tiles, (int)i, sample, &params,
+			                        &results[i], &results_valid[i]));
+
+		pool.wait_work();
+	}
+
+	/* write back, the buffer holds the sum of all samples */
+	for(size_t i = 0; i < tiles.size(); i++) {
+		BufferParams& buffer_params = tiles[i]->params;
+		const int size = buffer_params.width*buffer_params.height;
+		const int combined_offset = denoise_pass_offset(buffer_params, PASS_COMBINED);
+		const int pass_stride = buffer_params.get_passes_size();
+		float *buffer = (float*)tiles[i]->buffer.data_pointer;
+
+		for(int j = 0; j < size; j++) {
+			if(!results_valid[i][j])
+				continue;
+
+			float *combined = buffer + j*pass_stride + combined_offset;
+			float3 result = results[i][j] * (float)sample;
+
+			combined[0] = result.x;
+			combined[1] = result.y;
+			combined[2] = result.z;
+		}
+	}
+
+	return true;
+}
+
+bool denoise_render_buffers(RenderBuffers *buffers, int sample, const DenoiseParams& params)
+{
+	vector<RenderBuffers*> tiles(1, buffers);
+	return denoise_render_tiles(tiles, sample, params);
+}
+
+CCL_NAMESPACE_END
+
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2011-2016 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __DENOISING_H__
+#define __DENOISING_H__
+
+#include "util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+class RenderBuffers;
+
+/* Denoising Parameters */
+
+class DenoiseParams {
+public:
+	/* radius of the window in which similar pixels are searched */
+	int radius;
+	/* how strongly pixels with different colors are still mixed, relative to
+	 * the estimated noise level */
+	float strength;
+	/* how strongly differences in normal, albedo and depth keep pixels from
+	 * being mixed, zero ignores the features */
+	float feature_strength;
+
+	DenoiseParams()
+	{
+		radius = 8;
+		strength = 0.5f;
+		feature_strength = 0.5f;
+	}
+
+	bool modified(const DenoiseParams& params) const
+	{ return !(radius == params.radius
+		&& strength == params.strength
+		&& feature_strength == params.feature_strength); }
+};
+
+/* Denoise the combined pass of render buffers in place, on the host, guided
+ * by the PASS_DENOISING features. Sample is the number of samples which were
+ * accumulated in the buffers. */
+
+bool denoise_render_buffers(RenderBuffers *buffers, int sample, const DenoiseParams& params);
+
+/* Denoise the tiles of a frame together, pixels of neighboring tiles are used
+ * so that the result has no seams at tile borders. All tiles must have
+ * accumulated the same number of samples. */
+
+bool denoise_render_tiles(const vector<RenderBuffers*>& tiles, int sample, const DenoiseParams& params);
+
+CCL_NAMESPACE_END
+
+#endif /* __DENOISING_H__ */
+
@@ -34,6 +34,9 @@ CCL_NAMESPACE_BEGIN
 
 static bool compare_pass_order(const Pass& a, const Pass& b)
 {
+	/* combined pass is always written at the start of the pixel */
+	if(a.type == PASS_COMBINED || b.type == PASS_COMBINED)
+		return (a.type == PASS_COMBINED && b.type != PASS_COMBINED);
 	if(a.components == b.components)
 		return (a.type < b.type);
 	return (a.components > b.components);
@@ -153,6 +156,11 @@ void Pass::add(PassType type, vector<Pass>& passes)
 			 */
 			pass.components = 0;
 			break;
+		case PASS_DENOISING:
+			/* normal, depth, albedo and squared luminance */
+			pass.components = 8;
+			pass.filter = false;
+			break;
 #ifdef WITH_CYCLES_DEBUG
 		case PASS_BVH_TRAVERSAL_STEPS:
 			pass.components = 1;
@@ -403,6 +411,9 @@ void Film::device_update(Device *device, DeviceScene *dscene, Scene *scene)
 			case PASS_LIGHT:
 				kfilm->use_light_pass = 1;
 				break;
+			case PASS_DENOISING:
+				kfilm->pass_denoising = kfilm->pass_stride;
+				break;
 
 #ifdef WITH_CYCLES_DEBUG
 			case PASS_BVH_TRAVERSAL_STEPS:
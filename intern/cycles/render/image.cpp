@@ -902,6 +902,25 @@ void ImageManager::device_update_slot(Device *device,
 	}
 }
 
+device_memory *ImageManager::image_memory(DeviceScene *dscene, int slot)
+{
+	device_memory *mem;
+
+	if(slot >= tex_image_byte_start) {
+		int byte_slot = slot - tex_image_byte_start;
+		if(byte_slot >= images.size() || !images[byte_slot])
+			return NULL;
+		mem = &dscene->tex_image[byte_slot];
+	}
+	else {
+		if(slot < 0 || slot >= float_images.size() || !float_images[slot])
+			return NULL;
+		mem = &dscene->tex_float_image[slot];
+	}
+
+	return (mem->data_pointer)? mem: NULL;
+}
+
 void ImageManager::device_pack_images(Device *device,
                                       DeviceScene *dscene,
                                       Progress& /*progess*/)
@@ -60,6 +60,9 @@ public:
 	void device_free(Device *device, DeviceScene *dscene);
 	void device_free_builtin(Device *device, DeviceScene *dscene);
 
+	/* Host copy of the pixels of a loaded image, NULL if not loaded. */
+	device_memory *image_memory(DeviceScene *dscene, int slot);
+
 	void set_osl_texture_system(void *texture_system);
 	void set_pack_images(bool pack_images_);
 	bool set_animation_frame_update(int frame);
@@ -230,9 +230,11 @@ bool Integrator::modified(const Integrator& integrator)
 void Integrator::tag_update(Scene *scene)
 {
 	foreach(Shader *shader, scene->shaders) {
+		/* graphs are simplified using integrator settings, compiled nodes of
+		 * the shader can not be reused */
 		if(shader->has_integrator_dependency) {
+			shader->need_update = true;
 			scene->shader_manager->need_update = true;
-			break;
 		}
 	}
 	need_update = true;
@@ -137,6 +137,8 @@ Light::Light()
 void Light::tag_update(Scene *scene)
 {
 	scene->light_manager->need_update = true;
+	if(type == LIGHT_BACKGROUND)
+		scene->light_manager->need_update_background = true;
 }
 
 bool Light::has_contribution(Scene *scene)
@@ -155,6 +157,7 @@ bool Light::has_contribution(Scene *scene)
 LightManager::LightManager()
 {
 	need_update = true;
+	need_update_background = true;
 	use_light_visibility = false;
 }
 
@@ -194,6 +197,55 @@ void LightManager::disable_ineffective_light(Device *device, Scene *scene)
 	}
 }
 
+/* Range of emissive triangles of an object, written to the light
+ * distribution starting at offset. */
+struct LightTriangleRange {
+	Object *object;
+	int object_id;
+	int shader_flag;
+	size_t start, end;
+	size_t offset;
+};
+
+/* Number of triangles of a mesh handled by a single task. */
+#define LIGHT_TRIANGLE_RANGE_SIZE 65536
+
+/* Fill in the distribution entries of a triangle range, storing the area of
+ * each triangle which is turned into the cumulative value afterwards. */
+static void light_triangle_range_area(const LightTriangleRange *range,
+                                      const vector<Shader*> *shaders,
+                                      float4 *distribution)
+{
+	const Object *object = range->object;
+	const Mesh *mesh = object->mesh;
+	bool transform_applied = mesh->transform_applied;
+	Transform tfm = object->tfm;
+	size_t offset = range->offset;
+
+	for(size_t i = range->start; i < range->end; i++) {
+		Shader *shader = (*shaders)[mesh->shader[i]];
+
+		if(shader->use_mis && shader->has_surface_emission) {
+			Mesh::Triangle t = mesh->triangles[i];
+			float3 p1 = mesh->verts[t.v[0]];
+			float3 p2 = mesh->verts[t.v[1]];
+			float3 p3 = mesh->verts[t.v[2]];
+
+			if(!transform_applied) {
+				p1 = transform_point(&tfm, p1);
+				p2 = transform_point(&tfm, p2);
+				p3 = transform_point(&tfm, p3);
+			}
+
+			distribution[offset].x = triangle_area(p1, p2, p3);
+			distribution[offset].y = __int_as_float(i + mesh->tri_offset);
+			distribution[offset].z = __int_as_float(range->shader_flag);
+			distribution[offset].w = __int_as_float(range->object_id);
+			offset++;
+		}
+	}
+}
+
 void LightManager::device_update_distribution(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress)
 {
 	progress.set_status("Updating Lights", "Computing distribution");
@@ -210,47 +262,9 @@ void LightManager::device_update_distribution(Device *device, DeviceScene *dscen
 			num_lights++;
 	}
 
-	foreach(Object *object, scene->objects) {
-		Mesh *mesh = object->mesh;
-		bool have_emission = false;
-
-		/* skip if we are not visible for BSDFs */
-		if(!(object->visibility & (PATH_RAY_DIFFUSE|PATH_RAY_GLOSSY|PATH_RAY_TRANSMIT)))
-			continue;
-
-		/* skip motion blurred deforming meshes, not supported yet */
-		if(mesh->has_motion_blur())
-			continue;
-
-		/* skip if we have no emission shaders */
-		foreach(uint sindex, mesh->used_shaders) {
-			Shader *shader = scene->shaders[sindex];
-
-			if(shader->use_mis && shader->has_surface_emission) {
-				have_emission = true;
-				break;
-			}
-		}
-
-		/* count triangles */
-		if(have_emission) {
-			for(size_t i = 0; i < mesh->triangles.size(); i++) {
-				Shader *shader = scene->shaders[mesh->shader[i]];
-
-				if(shader->use_mis && shader->has_surface_emission)
-					num_triangles++;
-			}
-		}
-	}
-
-	size_t num_distribution = num_triangles + num_lights;
-
-	/* emission area */
-	float4 *distribution = dscene->light_distribution.resize(num_distribution + 1);
-	float totarea = 0.0f;
-
-	/* triangles */
-	size_t offset = 0;
+	/* collect ranges of emissive triangles, their area is computed in
+	 * parallel and accumulated into the distribution afterwards */
+	vector<LightTriangleRange> ranges;
 	int j = 0;
 
 	foreach(Object *object, scene->objects) {
@@ -279,64 +293,90 @@ void LightManager::device_update_distribution(Device *device, DeviceScene *dscen
 			}
 		}
 
-		/* sum area */
 		if(have_emission) {
-			bool transform_applied = mesh->transform_applied;
-			Transform tfm = object->tfm;
-			int object_id = j;
-			int shader_flag = 0;
-
-			if(transform_applied)
-				object_id = ~object_id;
+			LightTriangleRange range;
+			range.object = object;
+			range.object_id = (mesh->transform_applied)? ~j: j;
+			range.shader_flag = 0;
 
 			if(!(object->visibility & PATH_RAY_DIFFUSE)) {
-				shader_flag |= SHADER_EXCLUDE_DIFFUSE;
+				range.shader_flag |= SHADER_EXCLUDE_DIFFUSE;
 				use_light_visibility = true;
 			}
 			if(!(object->visibility & PATH_RAY_GLOSSY)) {
-				shader_flag |= SHADER_EXCLUDE_GLOSSY;
+				range.shader_flag |= SHADER_EXCLUDE_GLOSSY;
 				use_light_visibility = true;
 			}
 			if(!(object->visibility & PATH_RAY_TRANSMIT)) {
-				shader_flag |= SHADER_EXCLUDE_TRANSMIT;
+				range.shader_flag |= SHADER_EXCLUDE_TRANSMIT;
 				use_light_visibility = true;
 			}
 			if(!(object->visibility & PATH_RAY_VOLUME_SCATTER)) {
-				shader_flag |= SHADER_EXCLUDE_SCATTER;
+				range.shader_flag |= SHADER_EXCLUDE_SCATTER;
 				use_light_visibility = true;
 			}
 
-			for(size_t i = 0; i < mesh->triangles.size(); i++) {
-				Shader *shader = scene->shaders[mesh->shader[i]];
+			/* count triangles, split in ranges of limited size so big
+			 * meshes are spread over multiple threads as well */
+			size_t num_mesh_triangles = mesh->triangles.size();
 
-				if(shader->use_mis && shader->has_surface_emission) {
-					distribution[offset].x = totarea;
-					distribution[offset].y = __int_as_float(i + mesh->tri_offset);
-					distribution[offset].z = __int_as_float(shader_flag);
-					distribution[offset].w = __int_as_float(object_id);
-					offset++;
+			for(size_t start = 0; start < num_mesh_triangles; start += LIGHT_TRIANGLE_RANGE_SIZE) {
+				range.start = start;
+				range.end = start + LIGHT_TRIANGLE_RANGE_SIZE;
+				range.offset = num_triangles;
 
-					Mesh::Triangle t = mesh->triangles[i];
-					float3 p1 = mesh->verts[t.v[0]];
-					float3 p2 = mesh->verts[t.v[1]];
-					float3 p3 = mesh->verts[t.v[2]];
+				if(range.end > num_mesh_triangles)
+					range.end = num_mesh_triangles;
 
-					if(!transform_applied) {
-						p1 = transform_point(&tfm, p1);
-						p2 = transform_point(&tfm, p2);
-						p3 = transform_point(&tfm, p3);
-					}
+				for(size_t i = range.start; i < range.end; i++) {
+					Shader *shader = scene->shaders[mesh->shader[i]];
 
-					totarea += triangle_area(p1, p2, p3);
+					if(shader->use_mis && shader->has_surface_emission)
+						num_triangles++;
 				}
+
+				if(num_triangles != range.offset)
+					ranges.push_back(range);
 			}
 		}
 
-		if(progress.get_cancel()) return;
-
 		j++;
 	}
 
+	if(progress.get_cancel()) return;
+
+	size_t num_distribution = num_triangles + num_lights;
+
+	/* emission area */
+	float4 *distribution = dscene->light_distribution.resize(num_distribution + 1);
+	float totarea = 0.0f;
+
+	/* triangles */
+	if(ranges.size() == 1) {
+		light_triangle_range_area(&ranges[0], &scene->shaders, distribution);
+	}
+	else if(ranges.size() > 1) {
+		TaskPool pool;
+		for(size_t i = 0; i < ranges.size(); i++) {
+			pool.push(function_bind(&light_triangle_range_area,
+			                        &ranges[i],
+			                        &scene->shaders,
+			                        distribution));
+		}
+		pool.wait_work();
+	}
+
+	if(progress.get_cancel()) return;
+
+	/* accumulate in the same order as serial summation would */
+	for(size_t i = 0; i < num_triangles; i++) {
+		float area = distribution[i].x;
+		distribution[i].x = totarea;
+		totarea += area;
+	}
+
+	size_t offset = num_triangles;
+
 	float trianglearea = totarea;
 
 	/* point lights */
@@ -512,19 +552,36 @@ void LightManager::device_update_background(Device *device,
 	/* no background light found, signal renderer to skip sampling */
 	if(!background_light || !background_light->is_enabled) {
 		kintegrator->pdf_background_res = 0;
+		device->tex_free(dscene->light_background_marginal_cdf);
+		device->tex_free(dscene->light_background_conditional_cdf);
+		dscene->light_background_marginal_cdf.clear();
+		dscene->light_background_conditional_cdf.clear();
 		return;
 	}
 
-	progress.set_status("Updating Lights", "Importance map");
-
 	assert(kintegrator->use_direct_light);
 
 	/* get the resolution from the light's size (we stuff it in there) */
 	int res = background_light->map_resolution;
-	kintegrator->pdf_background_res = res;
 
 	assert(res > 0);
 
+	/* keep the existing importance map if the background did not change */
+	if(!need_update_background &&
+	   kintegrator->pdf_background_res == res &&
+	   dscene->light_background_marginal_cdf.size() == res + 1)
+	{
+		VLOG(2) << "Reusing background importance map.";
+		return;
+	}
+
+	device->tex_free(dscene->light_background_marginal_cdf);
+	device->tex_free(dscene->light_background_conditional_cdf);
+
+	progress.set_status("Updating Lights", "Importance map");
+
+	kintegrator->pdf_background_res = res;
+
 	vector<float3> pixels;
 	shade_background_pixels(device, dscene, res, pixels, progress);
 
@@ -776,7 +833,7 @@ void LightManager::device_update(Device *device, DeviceScene *dscene, Scene *sce
 
 	VLOG(1) << "Total " << scene->lights.size() << " lights.";
 
-	device_free(device, dscene);
+	device_free(device, dscene, false);
 
 	use_light_visibility = false;
 
@@ -797,24 +854,32 @@ void LightManager::device_update(Device *device, DeviceScene *dscene, Scene *sce
 	}
 
 	need_update = false;
+	need_update_background = false;
 }
 
-void LightManager::device_free(Device *device, DeviceScene *dscene)
+void LightManager::device_free(Device *device,
+                               DeviceScene *dscene,
+                               const bool free_background)
 {
 	device->tex_free(dscene->light_distribution);
 	device->tex_free(dscene->light_data);
-	device->tex_free(dscene->light_background_marginal_cdf);
-	device->tex_free(dscene->light_background_conditional_cdf);
 
 	dscene->light_distribution.clear();
 	dscene->light_data.clear();
-	dscene->light_background_marginal_cdf.clear();
-	dscene->light_background_conditional_cdf.clear();
+
+	if(free_background) {
+		device->tex_free(dscene->light_background_marginal_cdf);
+		device->tex_free(dscene->light_background_conditional_cdf);
+
+		dscene->light_background_marginal_cdf.clear();
+		dscene->light_background_conditional_cdf.clear();
+	}
 }
 
 void LightManager::tag_update(Scene * /*scene*/)
 {
 	need_update = true;
+	need_update_background = true;
 }
 
 CCL_NAMESPACE_END
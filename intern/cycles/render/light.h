@@ -74,6 +74,10 @@ public:
 	bool use_light_visibility;
 	bool need_update;
 
+	/* Background importance map needs to be rebuilt, it is kept otherwise
+	 * when only other lights or objects changed. */
+	bool need_update_background;
+
 	LightManager();
 	~LightManager();
 
@@ -81,7 +85,9 @@ public:
 	                   DeviceScene *dscene,
 	                   Scene *scene,
 	                   Progress& progress);
-	void device_free(Device *device, DeviceScene *dscene);
+	void device_free(Device *device,
+	                 DeviceScene *dscene,
+	                 const bool free_background = true);
 
 	void tag_update(Scene *scene);
 
@@ -32,8 +32,10 @@
 
 #include "util_foreach.h"
 #include "util_logging.h"
+#include "util_map.h"
 #include "util_progress.h"
 #include "util_set.h"
+#include "util_task.h"
 
 #include "subd_split.h"
 #include "subd_patch.h"
@@ -101,6 +103,8 @@ Mesh::Mesh()
 
 	has_volume = false;
 	has_surface_bssrdf = false;
+
+	volume_clipping = 0.0f;
 }
 
 Mesh::~Mesh()
@@ -393,7 +397,7 @@ void Mesh::add_vertex_normals()
 	}
 }
 
-void Mesh::pack_normals(Scene *scene, uint *tri_shader, float4 *vnormal)
+void Mesh::pack_normals(Scene *scene, uint *tri_shader, float4 *vnormal, uint *vnormal_packed)
 {
 	Attribute *attr_vN = attributes.find(ATTR_STD_VERTEX_NORMAL);
 
@@ -427,7 +431,10 @@ void Mesh::pack_normals(Scene *scene, uint *tri_shader, float4 *vnormal)
 		if(do_transform)
 			vNi = normalize(transform_direction(&ntfm, vNi));
 
-		vnormal[i] = make_float4(vNi.x, vNi.y, vNi.z, 0.0f);
+		if(vnormal_packed)
+			vnormal_packed[i] = octahedral_encode(vNi);
+		else
+			vnormal[i] = make_float4(vNi.x, vNi.y, vNi.z, 0.0f);
 	}
 }
 
@@ -525,6 +532,8 @@ void Mesh::compute_bvh(SceneParams *params, Progress *progress, int n, int total
 			BVHParams bparams;
 			bparams.use_spatial_split = params->use_bvh_spatial_split;
 			bparams.use_qbvh = params->use_qbvh;
+			bparams.use_obvh = params->use_obvh;
+			bparams.use_compact_geometry = params->use_compact_geometry;
 
 			delete bvh;
 			bvh = BVH::create(bparams, objects);
@@ -704,18 +713,18 @@ void MeshManager::update_svm_attributes(Device *device, DeviceScene *dscene, Sce
 	uint4 *attr_map = dscene->attributes_map.resize(attr_map_stride*scene->objects.size());
 	memset(attr_map, 0, dscene->attributes_map.size()*sizeof(uint));
 
+	/* index of each mesh, to avoid a linear search per object */
+	map<Mesh*, size_t> mesh_index;
+
+	for(size_t i = 0; i < scene->meshes.size(); i++)
+		mesh_index[scene->meshes[i]] = i;
+
 	for(size_t i = 0; i < scene->objects.size(); i++) {
 		Object *object = scene->objects[i];
 		Mesh *mesh = object->mesh;
 
 		/* find mesh attributes */
-		size_t j;
-
-		for(j = 0; j < scene->meshes.size(); j++)
-			if(scene->meshes[j] == mesh)
-				break;
-
-		AttributeRequestSet& attributes = mesh_attributes[j];
+		AttributeRequestSet& attributes = mesh_attributes[mesh_index[mesh]];
 
 		/* set object attributes */
 		int index = i*attr_map_stride;
@@ -907,6 +916,43 @@ static void update_attribute_element_offset(Mesh *mesh,
 	}
 }
 
+/* Fill in all requested attributes of a single mesh, starting at the given
+ * offsets which are computed up front so meshes can be packed in parallel. */
+static void update_mesh_attributes(Mesh *mesh,
+                                   AttributeRequestSet *attributes,
+                                   vector<float> *attr_float,
+                                   size_t attr_float_offset,
+                                   vector<float4> *attr_float3,
+                                   size_t attr_float3_offset,
+                                   vector<uchar4> *attr_uchar4,
+                                   size_t attr_uchar4_offset)
+{
+	/* todo: we now store std and name attributes from requests even if
+	 * they actually refer to the same mesh attributes, optimize */
+	foreach(AttributeRequest& req, attributes->requests) {
+		Attribute *triangle_mattr = mesh->attributes.find(req);
+		Attribute *curve_mattr = mesh->curve_attributes.find(req);
+
+		update_attribute_element_offset(mesh,
+		                                *attr_float, attr_float_offset,
+		                                *attr_float3, attr_float3_offset,
+		                                *attr_uchar4, attr_uchar4_offset,
+		                                triangle_mattr,
+		                                req.triangle_type,
+		                                req.triangle_offset,
+		                                req.triangle_element);
+
+		update_attribute_element_offset(mesh,
+		                                *attr_float, attr_float_offset,
+		                                *attr_float3, attr_float3_offset,
+		                                *attr_uchar4, attr_uchar4_offset,
+		                                curve_mattr,
+		                                req.curve_type,
+		                                req.curve_offset,
+		                                req.curve_element);
+	}
+}
+
 void MeshManager::device_update_attributes(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress)
 {
 	progress.set_status("Updating Mesh", "Computing attributes");
@@ -937,9 +983,19 @@ void MeshManager::device_update_attributes(Device *device, DeviceScene *dscene,
 	size_t attr_float_size = 0;
 	size_t attr_float3_size = 0;
 	size_t attr_uchar4_size = 0;
+
+	vector<size_t> mesh_attr_float_offset(scene->meshes.size());
+	vector<size_t> mesh_attr_float3_offset(scene->meshes.size());
+	vector<size_t> mesh_attr_uchar4_offset(scene->meshes.size());
+
 	for(size_t i = 0; i < scene->meshes.size(); i++) {
 		Mesh *mesh = scene->meshes[i];
 		AttributeRequestSet& attributes = mesh_attributes[i];
+
+		mesh_attr_float_offset[i] = attr_float_size;
+		mesh_attr_float3_offset[i] = attr_float3_size;
+		mesh_attr_uchar4_offset[i] = attr_uchar4_size;
+
 		foreach(AttributeRequest& req, attributes.requests) {
 			Attribute *triangle_mattr = mesh->attributes.find(req);
 			Attribute *curve_mattr = mesh->curve_attributes.find(req);
@@ -970,42 +1026,24 @@ void MeshManager::device_update_attributes(Device *device, DeviceScene *dscene,
 	vector<float4> attr_float3(attr_float3_size);
 	vector<uchar4> attr_uchar4(attr_uchar4_size);
 
-	size_t attr_float_offset = 0;
-	size_t attr_float3_offset = 0;
-	size_t attr_uchar4_offset = 0;
+	/* Fill in attributes, every mesh writes into its own part of the arrays. */
+	TaskPool pool;
 
-	/* Fill in attributes. */
 	for(size_t i = 0; i < scene->meshes.size(); i++) {
-		Mesh *mesh = scene->meshes[i];
-		AttributeRequestSet& attributes = mesh_attributes[i];
+		pool.push(function_bind(&update_mesh_attributes,
+		                        scene->meshes[i],
+		                        &mesh_attributes[i],
+		                        &attr_float,
+		                        mesh_attr_float_offset[i],
+		                        &attr_float3,
+		                        mesh_attr_float3_offset[i],
+		                        &attr_uchar4,
+		                        mesh_attr_uchar4_offset[i]));
+	}
 
-		/* todo: we now store std and name attributes from requests even if
-		 * they actually refer to the same mesh attributes, optimize */
-		foreach(AttributeRequest& req, attributes.requests) {
-			Attribute *triangle_mattr = mesh->attributes.find(req);
-			Attribute *curve_mattr = mesh->curve_attributes.find(req);
+	pool.wait_work();
 
-			update_attribute_element_offset(mesh,
-			                                attr_float, attr_float_offset,
-			                                attr_float3, attr_float3_offset,
-			                                attr_uchar4, attr_uchar4_offset,
-			                                triangle_mattr,
-			                                req.triangle_type,
-			                                req.triangle_offset,
-			                                req.triangle_element);
-
-			update_attribute_element_offset(mesh,
-			                                attr_float, attr_float_offset,
-			                                attr_float3, attr_float3_offset,
-			                                attr_uchar4, attr_uchar4_offset,
-			                                curve_mattr,
-			                                req.curve_type,
-			                                req.curve_offset,
-			                                req.curve_element);
-
-			if(progress.get_cancel()) return;
-		}
-	}
+	if(progress.get_cancel()) return;
 
 	/* create attribute lookup maps */
 	if(scene->shader_manager->use_osl())
@@ -1059,23 +1097,47 @@ void MeshManager::device_update_mesh(Device *device, DeviceScene *dscene, Scene
 		/* normals */
 		progress.set_status("Updating Mesh", "Computing normals");
 
+		bool use_compact_geometry = scene->params.use_compact_geometry;
+
 		uint *tri_shader = dscene->tri_shader.resize(tri_size);
-		float4 *vnormal = dscene->tri_vnormal.resize(vert_size);
+		float4 *vnormal = NULL;
+		uint *vnormal_packed = NULL;
 		float4 *tri_verts = dscene->tri_verts.resize(vert_size);
 		float4 *tri_vindex = dscene->tri_vindex.resize(tri_size);
 
-		foreach(Mesh *mesh, scene->meshes) {
-			mesh->pack_normals(scene, &tri_shader[mesh->tri_offset], &vnormal[mesh->vert_offset]);
-			mesh->pack_verts(&tri_verts[mesh->vert_offset], &tri_vindex[mesh->tri_offset], mesh->vert_offset);
+		if(use_compact_geometry)
+			vnormal_packed = dscene->tri_vnormal_packed.resize(vert_size);
+		else
+			vnormal = dscene->tri_vnormal.resize(vert_size);
+
+		TaskPool pool;
 
-			if(progress.get_cancel()) return;
+		foreach(Mesh *mesh, scene->meshes) {
+			pool.push(function_bind(&Mesh::pack_normals,
+			                        mesh,
+			                        scene,
+			                        &tri_shader[mesh->tri_offset],
+			                        (vnormal)? &vnormal[mesh->vert_offset]: NULL,
+			                        (vnormal_packed)? &vnormal_packed[mesh->vert_offset]: NULL));
+			pool.push(function_bind(&Mesh::pack_verts,
+			                        mesh,
+			                        &tri_verts[mesh->vert_offset],
+			                        &tri_vindex[mesh->tri_offset],
+			                        mesh->vert_offset));
 		}
 
+		pool.wait_work();
+
+		if(progress.get_cancel()) return;
+
 		/* vertex coordinates */
 		progress.set_status("Updating Mesh", "Copying Mesh to device");
 
 		device->tex_alloc("__tri_shader", dscene->tri_shader);
-		device->tex_alloc("__tri_vnormal", dscene->tri_vnormal);
+		if(use_compact_geometry)
+			device->tex_alloc("__tri_vnormal_packed", dscene->tri_vnormal_packed);
+		else
+			device->tex_alloc("__tri_vnormal", dscene->tri_vnormal);
 		device->tex_alloc("__tri_verts", dscene->tri_verts);
 		device->tex_alloc("__tri_vindex", dscene->tri_vindex);
 	}
@@ -1086,11 +1148,21 @@ void MeshManager::device_update_mesh(Device *device, DeviceScene *dscene, Scene
 		float4 *curve_keys = dscene->curve_keys.resize(curve_key_size);
 		float4 *curves = dscene->curves.resize(curve_size);
 
+		TaskPool pool;
+
 		foreach(Mesh *mesh, scene->meshes) {
-			mesh->pack_curves(scene, &curve_keys[mesh->curvekey_offset], &curves[mesh->curve_offset], mesh->curvekey_offset);
-			if(progress.get_cancel()) return;
+			pool.push(function_bind(&Mesh::pack_curves,
+			                        mesh,
+			                        scene,
+			                        &curve_keys[mesh->curvekey_offset],
+			                        &curves[mesh->curve_offset],
+			                        mesh->curvekey_offset));
 		}
 
+		pool.wait_work();
+
+		if(progress.get_cancel()) return;
+
 		device->tex_alloc("__curve_keys", dscene->curve_keys);
 		device->tex_alloc("__curves", dscene->curves);
 	}
@@ -1101,12 +1173,15 @@ void MeshManager::device_update_bvh(Device *device, DeviceScene *dscene, Scene *
 	/* bvh build */
 	progress.set_status("Updating Scene BVH", "Building");
 
-	VLOG(1) << (scene->params.use_qbvh ? "Using QBVH optimization structure"
-	                                   : "Using regular BVH optimization structure");
+	VLOG(1) << (scene->params.use_obvh ? "Using OBVH optimization structure"
+	            : scene->params.use_qbvh ? "Using QBVH optimization structure"
+	                                     : "Using regular BVH optimization structure");
 
 	BVHParams bparams;
 	bparams.top_level = true;
 	bparams.use_qbvh = scene->params.use_qbvh;
+	bparams.use_obvh = scene->params.use_obvh;
+	bparams.use_compact_geometry = scene->params.use_compact_geometry;
 	bparams.use_spatial_split = scene->params.use_bvh_spatial_split;
 
 	delete bvh;
@@ -1155,6 +1230,8 @@ void MeshManager::device_update_bvh(Device *device, DeviceScene *dscene, Scene *
 
 	dscene->data.bvh.root = pack.root_index;
 	dscene->data.bvh.use_qbvh = scene->params.use_qbvh;
+	dscene->data.bvh.use_obvh = scene->params.use_obvh;
+	dscene->data.bvh.use_compact_geometry = scene->params.use_compact_geometry;
 }
 
 void MeshManager::device_update_flags(Device * /*device*/,
@@ -1230,6 +1307,12 @@ void MeshManager::device_update_displacement_images(Device *device,
 	pool.wait_work();
 }
 
+static void mesh_add_normals(Mesh *mesh)
+{
+	mesh->add_face_normals();
+	mesh->add_vertex_normals();
+}
+
 void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress)
 {
 	if(!need_update)
@@ -1238,20 +1321,22 @@ void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scen
 	VLOG(1) << "Total " << scene->meshes.size() << " meshes.";
 
 	/* update normals */
+	TaskPool normals_pool;
+
 	foreach(Mesh *mesh, scene->meshes) {
 		foreach(uint shader, mesh->used_shaders) {
 			if(scene->shaders[shader]->need_update_attributes)
 				mesh->need_update = true;
 		}
 
-		if(mesh->need_update) {
-			mesh->add_face_normals();
-			mesh->add_vertex_normals();
-
-			if(progress.get_cancel()) return;
-		}
+		if(mesh->need_update)
+			normals_pool.push(function_bind(&mesh_add_normals, mesh));
 	}
 
+	normals_pool.wait_work();
+
+	if(progress.get_cancel()) return;
+
 	/* Update images needed for true displacement. */
 	bool need_displacement_images = false;
 	bool old_need_object_flags_update = false;
@@ -1376,6 +1461,7 @@ void MeshManager::device_free(Device *device, DeviceScene *dscene)
 	device->tex_free(dscene->prim_object);
 	device->tex_free(dscene->tri_shader);
 	device->tex_free(dscene->tri_vnormal);
+	device->tex_free(dscene->tri_vnormal_packed);
 	device->tex_free(dscene->tri_vindex);
 	device->tex_free(dscene->tri_verts);
 	device->tex_free(dscene->curves);
@@ -1384,6 +1470,7 @@ void MeshManager::device_free(Device *device, DeviceScene *dscene)
 	device->tex_free(dscene->attributes_float);
 	device->tex_free(dscene->attributes_float3);
 	device->tex_free(dscene->attributes_uchar4);
+	device->tex_free(dscene->volume_grid);
 
 	dscene->bvh_nodes.clear();
 	dscene->object_node.clear();
@@ -1394,6 +1481,7 @@ void MeshManager::device_free(Device *device, DeviceScene *dscene)
 	dscene->prim_object.clear();
 	dscene->tri_shader.clear();
 	dscene->tri_vnormal.clear();
+	dscene->tri_vnormal_packed.clear();
 	dscene->tri_vindex.clear();
 	dscene->tri_verts.clear();
 	dscene->curves.clear();
@@ -1402,6 +1490,7 @@ void MeshManager::device_free(Device *device, DeviceScene *dscene)
 	dscene->attributes_float.clear();
 	dscene->attributes_float3.clear();
 	dscene->attributes_uchar4.clear();
+	dscene->volume_grid.clear();
 
 #ifdef WITH_OSL
 	OSLGlobals *og = (OSLGlobals*)device->osl_memory();
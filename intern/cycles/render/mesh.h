@@ -91,6 +91,11 @@ public:
 	bool has_volume;  /* Set in the device_update_flags(). */
 	bool has_surface_bssrdf;  /* Set in the device_update_flags(). */
 
+	/* voxel attribute values at or below which space is considered empty,
+	 * zero disables empty space skipping */
+	float volume_clipping;
+	vector<uint> volume_grid;  /* Set in device_update_volume_grids(). */
+
 	vector<float4> curve_keys; /* co + radius */
 	vector<Curve> curves;
 
@@ -135,7 +140,7 @@ public:
 	void add_face_normals();
 	void add_vertex_normals();
 
-	void pack_normals(Scene *scene, uint *shader, float4 *vnormal);
+	void pack_normals(Scene *scene, uint *shader, float4 *vnormal, uint *vnormal_packed);
 	void pack_verts(float4 *tri_verts, float4 *tri_vindex, size_t vert_offset);
 	void pack_curves(Scene *scene, float4 *curve_key_co, float4 *curve_data, size_t curvekey_offset);
 	void compute_bvh(SceneParams *params, Progress *progress, int n, int total);
@@ -188,6 +193,7 @@ public:
 	void device_update_bvh(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress);
 	void device_update_flags(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress);
 	void device_update_displacement_images(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress);
+	void device_update_volume_grids(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress);
 	void device_free(Device *device, DeviceScene *dscene);
 
 	void tag_update(Scene *scene);
@@ -0,0 +1,221 @@
+/*
+ * Copyright 2011-2016 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "attribute.h"
+#include "device.h"
+#include "image.h"
+#include "mesh.h"
+#include "object.h"
+#include "scene.h"
+
+#include "util_foreach.h"
+#include "util_logging.h"
+#include "util_map.h"
+#include "util_progress.h"
+#include "util_task.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Volume Grids
+ *
+ * For meshes with voxel attributes, a coarse grid over texture space marks
+ * the blocks of voxels in which any attribute exceeds the clipping value. The
+ * kernel skips volume shader evaluation outside of these blocks, which avoids
+ * most of the cost of ray marching through the empty space of sparse volumes
+ * like smoke and fire.
+ *
+ * Grid layout: resolution x, y and z followed by one bit per block. */
+
+#define VOLUME_GRID_BLOCK_SIZE 8
+
+/* voxels affect lookups up to two voxels away with cubic interpolation */
+#define VOLUME_GRID_PADDING 2
+
+static size_t volume_image_depth(device_memory *image)
+{
+	/* 2D images have zero depth */
+	return (image->data_depth)? image->data_depth: 1;
+}
+
+static void volume_grid_block_range(int voxel, int num_voxels, int num_blocks, int *lo, int *hi)
+{
+	/* blocks overlapping the padded voxel in texture space */
+	int begin = (voxel - VOLUME_GRID_PADDING) * num_blocks;
+	int end = (voxel + 1 + VOLUME_GRID_PADDING) * num_blocks;
+
+	*lo = (begin > 0)? begin / num_voxels: 0;
+	*hi = min((end + num_voxels - 1) / num_voxels, num_blocks) - 1;
+}
+
+static void volume_grid_mark_voxel(vector<uint>& grid, int3 res, int3 voxel, int3 num_voxels)
+{
+	int x0, x1, y0, y1, z0, z1;
+
+	volume_grid_block_range(voxel.x, num_voxels.x, res.x, &x0, &x1);
+	volume_grid_block_range(voxel.y, num_voxels.y, res.y, &y0, &y1);
+	volume_grid_block_range(voxel.z, num_voxels.z, res.z, &z0, &z1);
+
+	for(int z = z0; z <= z1; z++) {
+		for(int y = y0; y <= y1; y++) {
+			for(int x = x0; x <= x1; x++) {
+				size_t index = ((size_t)z*res.y + y)*res.x + x;
+				grid[3 + (index >> 5)] |= (1u << (index & 31));
+			}
+		}
+	}
+}
+
+static void mesh_volume_grid_build(Mesh *mesh, vector<device_memory*> images)
+{
+	/* block resolution to fit the highest resolution attribute */
+	int3 res = make_int3(1, 1, 1);
+
+	foreach(device_memory *image, images) {
+		res.x = max(res.x, (int)(image->data_width + VOLUME_GRID_BLOCK_SIZE - 1) / VOLUME_GRID_BLOCK_SIZE);
+		res.y = max(res.y, (int)(image->data_height + VOLUME_GRID_BLOCK_SIZE - 1) / VOLUME_GRID_BLOCK_SIZE);
+		res.z = max(res.z, (int)(volume_image_depth(image) + VOLUME_GRID_BLOCK_SIZE - 1) / VOLUME_GRID_BLOCK_SIZE);
+	}
+
+	size_t num_blocks = (size_t)res.x*res.y*res.z;
+	vector<uint>& grid = mesh->volume_grid;
+
+	grid.clear();
+	grid.resize(3 + (num_blocks + 31) / 32, 0);
+	grid[0] = res.x;
+	grid[1] = res.y;
+	grid[2] = res.z;
+
+	/* only color channels are used by the kernel, alpha is not
+	 * available as attribute */
+	const float clipping = mesh->volume_clipping;
+	const uchar byte_clipping = (uchar)clamp((int)(clipping * 255.0f), 0, 255);
+
+	foreach(device_memory *image, images) {
+		const int3 num_voxels = make_int3((int)image->data_width,
+		                                  (int)image->data_height,
+		                                  (int)volume_image_depth(image));
+		const float4 *float_pixels = (image->data_type == TYPE_FLOAT)? (float4*)image->data_pointer: NULL;
+		const uchar4 *byte_pixels = (image->data_type == TYPE_UCHAR)? (uchar4*)image->data_pointer: NULL;
+		size_t i = 0;
+
+		for(int z = 0; z < num_voxels.z; z++) {
+			for(int y = 0; y < num_voxels.y; y++) {
+				for(int x = 0; x < num_voxels.x; x++, i++) {
+					bool empty;
+
+					if(float_pixels) {
+						const float4& f = float_pixels[i];
+						empty = fabsf(f.x) <= clipping && fabsf(f.y) <= clipping && fabsf(f.z) <= clipping;
+					}
+					else {
+						const uchar4& b = byte_pixels[i];
+						empty = b.x <= byte_clipping && b.y <= byte_clipping && b.z <= byte_clipping;
+					}
+
+					if(!empty)
+						volume_grid_mark_voxel(grid, res, make_int3(x, y, z), num_voxels);
+				}
+			}
+		}
+	}
+}
+
+void MeshManager::device_update_volume_grids(Device *device,
+                                             DeviceScene *dscene,
+                                             Scene *scene,
+                                             Progress& progress)
+{
+	progress.set_status("Updating Volume Grids");
+
+	/* build grids for meshes with voxel attributes */
+	TaskPool pool;
+	size_t num_grids = 0;
+
+	foreach(Mesh *mesh, scene->meshes) {
+		mesh->volume_grid.clear();
+
+		if(!mesh->has_volume || mesh->volume_clipping <= 0.0f)
+			continue;
+
+		vector<device_memory*> images;
+		bool images_loaded = true;
+
+		foreach(Attribute& attr, mesh->attributes.attributes) {
+			if(attr.element != ATTR_ELEMENT_VOXEL)
+				continue;
+
+			VoxelAttribute *voxel = attr.data_voxel();
+			device_memory *image = scene->image_manager->image_memory(dscene, voxel->slot);
+
+			if(image == NULL || !(image->data_type == TYPE_FLOAT || image->data_type == TYPE_UCHAR)) {
+				images_loaded = false;
+				break;
+			}
+
+			images.push_back(image);
+		}
+
+		/* without all voxel data on the host nothing is known to be empty */
+		if(images.empty() || !images_loaded)
+			continue;
+
+		pool.push(function_bind(&mesh_volume_grid_build, mesh, images));
+		num_grids++;
+	}
+
+	pool.wait_work();
+
+	if(progress.get_cancel()) return;
+
+	/* pack, starting with the grid offset of every object, zero for none */
+	size_t size = scene->objects.size();
+
+	foreach(Mesh *mesh, scene->meshes)
+		size += mesh->volume_grid.size();
+
+	device->tex_free(dscene->volume_grid);
+
+	uint *volume_grid = dscene->volume_grid.resize((size)? size: 1);
+	map<Mesh*, uint> grid_offset;
+	size_t offset = scene->objects.size();
+
+	memset(volume_grid, 0, dscene->volume_grid.size()*sizeof(uint));
+
+	for(size_t i = 0; i < scene->objects.size(); i++) {
+		Mesh *mesh = scene->objects[i]->mesh;
+
+		if(mesh->volume_grid.empty())
+			continue;
+
+		map<Mesh*, uint>::iterator it = grid_offset.find(mesh);
+
+		if(it == grid_offset.end()) {
+			memcpy(volume_grid + offset, &mesh->volume_grid[0], mesh->volume_grid.size()*sizeof(uint));
+			it = grid_offset.insert(std::make_pair(mesh, (uint)offset)).first;
+			offset += mesh->volume_grid.size();
+		}
+
+		volume_grid[i] = it->second;
+	}
+
+	VLOG(1) << "Built " << num_grids << " volume grids, "
+	        << dscene->volume_grid.size()*sizeof(uint) << " bytes.";
+
+	device->tex_alloc("__volume_grid", dscene->volume_grid);
+}
+
+CCL_NAMESPACE_END
+
@@ -258,44 +258,46 @@ void ObjectManager::device_update_object_transform(UpdateObejctTransformState *s
 	        ? ob->particle_index + state->particle_offset[ob->particle_system]
 	        : 0;
 
-	if(transform_uniform_scale(tfm, uniform_scale)) {
-		map<Mesh*, float>::iterator it;
+	if(state->need_surface_area) {
+		if(transform_uniform_scale(tfm, uniform_scale)) {
+			map<Mesh*, float>::iterator it;
+
+			/* NOTE: This isn't fully optimal and could in theory lead to multiple
+			 * threads calculating area of the same mesh in parallel. However, this
+			 * also prevents suspending all the threads when some mesh's area is
+			 * not yet known.
+			 */
+			state->surface_area_lock.lock();
+			it = state->surface_area_map.find(mesh);
+			state->surface_area_lock.unlock();
 
-		/* NOTE: This isn't fully optimal and could in theory lead to multiple
-		 * threads calculating area of the same mesh in parallel. However, this
-		 * also prevents suspending all the threads when some mesh's area is
-		 * not yet known.
-		 */
-		state->surface_area_lock.lock();
-		it = state->surface_area_map.find(mesh);
-		state->surface_area_lock.unlock();
+			if(it == state->surface_area_map.end()) {
+				foreach(Mesh::Triangle& t, mesh->triangles) {
+					float3 p1 = mesh->verts[t.v[0]];
+					float3 p2 = mesh->verts[t.v[1]];
+					float3 p3 = mesh->verts[t.v[2]];
 
-		if(it == state->surface_area_map.end()) {
-			foreach(Mesh::Triangle& t, mesh->triangles) {
-				float3 p1 = mesh->verts[t.v[0]];
-				float3 p2 = mesh->verts[t.v[1]];
-				float3 p3 = mesh->verts[t.v[2]];
+					surface_area += triangle_area(p1, p2, p3);
+				}
 
-				surface_area += triangle_area(p1, p2, p3);
+				state->surface_area_lock.lock();
+				state->surface_area_map[mesh] = surface_area;
+				state->surface_area_lock.unlock();
+			}
+			else {
+				surface_area = it->second;
 			}
 
-			state->surface_area_lock.lock();
-			state->surface_area_map[mesh] = surface_area;
-			state->surface_area_lock.unlock();
+			surface_area *= uniform_scale;
 		}
 		else {
-			surface_area = it->second;
-		}
-
-		surface_area *= uniform_scale;
-	}
-	else {
-		foreach(Mesh::Triangle& t, mesh->triangles) {
-			float3 p1 = transform_point(&tfm, mesh->verts[t.v[0]]);
-			float3 p2 = transform_point(&tfm, mesh->verts[t.v[1]]);
-			float3 p3 = transform_point(&tfm, mesh->verts[t.v[2]]);
+			foreach(Mesh::Triangle& t, mesh->triangles) {
+				float3 p1 = transform_point(&tfm, mesh->verts[t.v[0]]);
+				float3 p2 = transform_point(&tfm, mesh->verts[t.v[1]]);
+				float3 p3 = transform_point(&tfm, mesh->verts[t.v[2]]);
 
-			surface_area += triangle_area(p1, p2, p3);
+				surface_area += triangle_area(p1, p2, p3);
+			}
 		}
 	}
 
@@ -416,6 +418,7 @@ void ObjectManager::device_update_transforms(Device *device,
 {
 	UpdateObejctTransformState state;
 	state.need_motion = scene->need_motion(device->info.advanced_shading);
+	state.need_surface_area = scene->shader_manager->use_osl();
 	state.have_motion = false;
 	state.have_curves = false;
 	state.scene = scene;
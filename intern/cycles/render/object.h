@@ -111,6 +111,11 @@ protected:
 		 */
 		map<ParticleSystem*, int> particle_offset;
 
+		/* Surface area is only read by OSL shaders, skip computing it
+		 * for every instance otherwise.
+		 */
+		bool need_surface_area;
+
 		/* Mesh area.
 		 * Used to avoid calculation of mesh area multiple times. Used for both
 		 * read and write. Acquire surface_area_lock to keep it all thread safe.
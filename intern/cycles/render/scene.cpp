@@ -147,10 +147,15 @@ void Scene::device_update(Device *device_, Progress& progress)
 	 * - Light manager needs lookup tables and final mesh data to compute emission CDF.
 	 * - Film needs light manager to run for use_light_visibility
 	 * - Lookup tables are done a second time to handle film tables
+	 * - Volume grids need both mesh attributes and loaded voxel images
 	 */
 	
 	image_manager->set_pack_images(device->info.pack_images);
 
+	bool need_volume_grid_update = mesh_manager->need_update ||
+	                               object_manager->need_update ||
+	                               image_manager->need_update;
+
 	progress.set_status("Updating Shaders");
 	shader_manager->device_update(device, &dscene, this, progress);
 
@@ -196,6 +201,12 @@ void Scene::device_update(Device *device_, Progress& progress)
 
 	if(progress.get_cancel() || device->have_error()) return;
 
+	if(need_volume_grid_update) {
+		mesh_manager->device_update_volume_grids(device, &dscene, this, progress);
+
+		if(progress.get_cancel() || device->have_error()) return;
+	}
+
 	progress.set_status("Updating Hair Systems");
 	curve_system_manager->device_update(device, &dscene, this, progress);
 
@@ -72,6 +72,7 @@ public:
 	/* mesh */
 	device_vector<uint> tri_shader;
 	device_vector<float4> tri_vnormal;
+	device_vector<uint> tri_vnormal_packed;
 	device_vector<float4> tri_vindex;
 	device_vector<float4> tri_verts;
 
@@ -88,6 +89,9 @@ public:
 	device_vector<float4> attributes_float3;
 	device_vector<uchar4> attributes_uchar4;
 
+	/* volumes */
+	device_vector<uint> volume_grid;
+
 	/* lights */
 	device_vector<float4> light_distribution;
 	device_vector<float4> light_data;
@@ -132,6 +136,8 @@ public:
 	} bvh_type;
 	bool use_bvh_spatial_split;
 	bool use_qbvh;
+	bool use_obvh;
+	bool use_compact_geometry;
 	bool persistent_data;
 
 	SceneParams()
@@ -140,6 +146,8 @@ public:
 		bvh_type = BVH_DYNAMIC;
 		use_bvh_spatial_split = false;
 		use_qbvh = false;
+		use_obvh = false;
+		use_compact_geometry = false;
 		persistent_data = false;
 	}
 
@@ -148,6 +156,8 @@ public:
 		&& bvh_type == params.bvh_type
 		&& use_bvh_spatial_split == params.use_bvh_spatial_split
 		&& use_qbvh == params.use_qbvh
+		&& use_obvh == params.use_obvh
+		&& use_compact_geometry == params.use_compact_geometry
 		&& persistent_data == params.persistent_data); }
 };
 
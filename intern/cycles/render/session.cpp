@@ -120,6 +120,9 @@ Session::~Session()
 	foreach(RenderBuffers *buffers, tile_buffers)
 		delete buffers;
 
+	foreach(RenderTile& rtile, denoise_tiles)
+		delete rtile.buffers;
+
 	delete buffers;
 	delete display;
 	delete scene;
@@ -461,16 +464,40 @@ void Session::update_tile_sample(RenderTile& rtile)
 	update_status_time();
 }
 
+void Session::denoise(const vector<RenderBuffers *>& buffers, int sample)
+{
+	/* buffers only contain the samples of the current range */
+	sample -= tile_manager.range_start_sample;
+
+	foreach(RenderBuffers *tilebuffers, buffers)
+		tilebuffers->copy_from_device();
+
+	if(denoise_render_tiles(buffers, sample, params.denoising)) {
+		foreach(RenderBuffers *tilebuffers, buffers)
+			tilebuffers->copy_to_device();
+	}
+}
+
 void Session::release_tile(RenderTile& rtile)
 {
 	thread_scoped_lock tile_lock(tile_mutex);
 
 	if(write_render_tile_cb) {
 		if(params.progressive_refine == false) {
-			/* todo: optimize this by making it thread safe and removing lock */
-			write_render_tile_cb(rtile);
+			if(params.use_denoising) {
+				/* denoising needs the neighboring tiles, show the tile as
+				 * rendered and write it once all tiles are done */
+				if(update_render_tile_cb)
+					update_render_tile_cb(rtile);
 
-			delete rtile.buffers;
+				denoise_tiles.push_back(rtile);
+			}
+			else {
+				/* todo: optimize this by making it thread safe and removing lock */
+				write_render_tile_cb(rtile);
+
+				delete rtile.buffers;
+			}
 		}
 	}
 
@@ -687,6 +714,9 @@ void Session::run()
 			run_cpu();
 	}
 
+	/* denoise and write tiles which were kept for denoising */
+	write_denoise_tiles(progress.get_cancel());
+
 	/* progress update */
 	if(progress.get_cancel())
 		progress.set_status("Cancel", progress.get_cancel_message());
@@ -965,6 +995,9 @@ bool Session::update_progressive_refine(bool cancel)
 	}
 
 	if(params.progressive_refine) {
+		if(write && params.use_denoising && write_render_tile_cb)
+			denoise(tile_buffers, sample);
+
 		foreach(RenderBuffers *buffers, tile_buffers) {
 			RenderTile rtile;
 			rtile.buffers = buffers;
@@ -986,6 +1019,30 @@ bool Session::update_progressive_refine(bool cancel)
 	return write;
 }
 
+void Session::write_denoise_tiles(bool cancel)
+{
+	if(denoise_tiles.size() == 0)
+		return;
+
+	if(!cancel) {
+		vector<RenderBuffers *> buffers;
+
+		foreach(RenderTile& rtile, denoise_tiles)
+			buffers.push_back(rtile.buffers);
+
+		progress.set_status("Denoising");
+		denoise(buffers, denoise_tiles[0].sample);
+	}
+
+	foreach(RenderTile& rtile, denoise_tiles) {
+		write_render_tile_cb(rtile);
+
+		delete rtile.buffers;
+	}
+
+	denoise_tiles.clear();
+}
+
 void Session::device_free()
 {
 	scene->device_free();
@@ -18,6 +18,7 @@
 #define __SESSION_H__
 
 #include "buffers.h"
+#include "denoising.h"
 #include "device.h"
 #include "shader.h"
 #include "tile.h"
@@ -64,6 +65,9 @@ public:
 
 	ShadingSystem shadingsystem;
 
+	bool use_denoising;
+	DenoiseParams denoising;
+
 	SessionParams()
 	{
 		background = false;
@@ -86,6 +90,8 @@ public:
 
 		shadingsystem = SHADINGSYSTEM_SVM;
 		tile_order = TILE_CENTER;
+
+		use_denoising = false;
 	}
 
 	bool modified(const SessionParams& params)
@@ -173,6 +179,8 @@ protected:
 	bool acquire_tile(Device *tile_device, RenderTile& tile);
 	void update_tile_sample(RenderTile& tile);
 	void release_tile(RenderTile& tile);
+	void denoise(const vector<RenderBuffers *>& buffers, int sample);
+	void write_denoise_tiles(bool cancel);
 
 	void update_progress_sample();
 
@@ -206,6 +214,9 @@ protected:
 
 	vector<RenderBuffers *> tile_buffers;
 
+	/* tiles kept until all are rendered, for denoising across tile borders */
+	vector<RenderTile> denoise_tiles;
+
 	DeviceRequestedFeatures get_requested_device_features();
 
 	/* ** Split kernel routines ** */
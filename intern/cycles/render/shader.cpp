@@ -196,6 +196,10 @@ void Shader::tag_update(Scene *scene)
 	if(use_mis && has_surface_emission)
 		scene->light_manager->need_update = true;
 
+	/* changes to the world shader invalidate the background importance map */
+	if(scene->shaders[scene->default_background] == this)
+		scene->light_manager->need_update_background = true;
+
 	/* quick detection of which kind of shaders we have to avoid loading
 	 * e.g. surface attributes when there is only a volume shader. this could
 	 * be more fine grained but it's better than nothing */
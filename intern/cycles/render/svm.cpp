@@ -42,6 +42,7 @@ SVMShaderManager::~SVMShaderManager()
 
 void SVMShaderManager::reset(Scene * /*scene*/)
 {
+	compiled_shaders.clear();
 }
 
 void SVMShaderManager::device_update(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress)
@@ -66,6 +67,11 @@ void SVMShaderManager::device_update(Device *device, DeviceScene *dscene, Scene
 		svm_nodes.push_back(make_int4(NODE_SHADER_JUMP, 0, 0, 0));
 	}
 	
+	map<Shader*, CompiledShader> prev_compiled_shaders;
+	prev_compiled_shaders.swap(compiled_shaders);
+
+	int num_reused = 0;
+
 	for(i = 0; i < scene->shaders.size(); i++) {
 		Shader *shader = scene->shaders[i];
 
@@ -73,19 +79,59 @@ void SVMShaderManager::device_update(Device *device, DeviceScene *dscene, Scene
 
 		assert(shader->graph);
 
+		bool background = ((int)i == scene->default_background);
+		int start = svm_nodes.size();
+
+		/* reuse nodes of shaders that did not change since the last update,
+		 * only the jump table entries need to be relocated */
+		map<Shader*, CompiledShader>::iterator it = prev_compiled_shaders.find(shader);
+
+		if(it != prev_compiled_shaders.end() &&
+		   !shader->need_update &&
+		   it->second.used == shader->used &&
+		   it->second.background == background)
+		{
+			CompiledShader& compiled = it->second;
+
+			for(int j = 0; j < 2; j++) {
+				svm_nodes[i*2 + j] = make_int4(compiled.jump[j].x,
+				                               compiled.jump[j].y + start,
+				                               compiled.jump[j].z + start,
+				                               compiled.jump[j].w + start);
+			}
+
+			svm_nodes.insert(svm_nodes.end(), compiled.svm_nodes.begin(), compiled.svm_nodes.end());
+			compiled_shaders[shader] = compiled;
+			num_reused++;
+			continue;
+		}
+
 		if(shader->use_mis && shader->has_surface_emission)
 			scene->light_manager->need_update = true;
 
 		SVMCompiler::Summary summary;
 		SVMCompiler compiler(scene->shader_manager, scene->image_manager);
-		compiler.background = ((int)i == scene->default_background);
+		compiler.background = background;
 		compiler.compile(scene, shader, svm_nodes, i, &summary);
 
 		VLOG(1) << "Compilation summary:\n"
 		        << "Shader name: " << shader->name << "\n"
 		        << summary.full_report();
+
+		/* store for reuse in the next update */
+		CompiledShader& compiled = compiled_shaders[shader];
+		compiled.svm_nodes.assign(svm_nodes.begin() + start, svm_nodes.end());
+		compiled.used = shader->used;
+		compiled.background = background;
+
+		for(int j = 0; j < 2; j++) {
+			int4 jump = svm_nodes[i*2 + j];
+			compiled.jump[j] = make_int4(jump.x, jump.y - start, jump.z - start, jump.w - start);
+		}
 	}
 
+	VLOG(1) << "Reused " << num_reused << " compiled shaders.";
+
 	dscene->svm_nodes.copy((uint4*)&svm_nodes[0], svm_nodes.size());
 	device->tex_alloc("__svm_nodes", dscene->svm_nodes);
 
@@ -21,6 +21,7 @@
 #include "graph.h"
 #include "shader.h"
 
+#include "util_map.h"
 #include "util_set.h"
 #include "util_string.h"
 
@@ -46,6 +47,20 @@ public:
 
 	void device_update(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress);
 	void device_free(Device *device, DeviceScene *dscene, Scene *scene);
+
+protected:
+	/* Nodes of a compiled shader, with the shader jump table entries relative
+	 * to the start of the nodes. SVM jumps are relative, so these can be
+	 * placed anywhere in the node array without recompiling the shader. */
+	struct CompiledShader {
+		vector<int4> svm_nodes;
+		int4 jump[2];
+		bool used;
+		bool background;
+	};
+
+	/* Shaders compiled in a previous update, reused while not modified. */
+	map<Shader*, CompiledShader> compiled_shaders;
 };
 
 /* Graph Compiler */
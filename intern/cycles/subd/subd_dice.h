@@ -44,6 +44,10 @@ struct SubdParams {
 	Camera *camera;
 	Transform objecttoworld;
 
+	/* multiplier for the dicing rate of geometry outside of the camera
+	 * view, reached at one image size distance from the view border */
+	float offscreen_dicing_scale;
+
 	SubdParams(Mesh *mesh_, int shader_, bool smooth_ = true, bool ptex_ = false)
 	{
 		mesh = mesh_;
@@ -56,6 +60,7 @@ struct SubdParams {
 		dicing_rate = 0.1f;
 		max_level = 12;
 		camera = NULL;
+		offscreen_dicing_scale = 1.0f;
 	}
 
 };
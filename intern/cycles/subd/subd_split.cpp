@@ -57,6 +57,29 @@ float3 DiagSplit::to_world(Patch *patch, float2 uv)
 	return P;
 }
 
+/* Factor to scale the pixel width with for points outside of the camera view,
+ * increasing with the distance to the view so there's no visible seam in the
+ * tessellation density at the border of the image. */
+static float offscreen_dicing_factor(Camera *cam, float3 P, float scale)
+{
+	if(cam->type == CAMERA_PANORAMA)
+		return 1.0f;
+
+	float3 Pcamera = transform_point(&cam->worldtocamera, P);
+
+	if(Pcamera.z <= 0.0f)
+		return scale;
+
+	float3 Praster = transform_perspective(&cam->worldtoraster, P);
+	float width = (float)cam->width;
+	float height = (float)cam->height;
+	float dx = max(max(-Praster.x, Praster.x - width), 0.0f) / width;
+	float dy = max(max(-Praster.y, Praster.y - height), 0.0f) / height;
+	float offscreen = min(max(dx, dy), 1.0f);
+
+	return 1.0f + (scale - 1.0f) * offscreen;
+}
+
 int DiagSplit::T(Patch *patch, float2 Pstart, float2 Pend)
 {
 	float3 Plast = make_float3(0.0f, 0.0f, 0.0f);
@@ -77,7 +100,12 @@ int DiagSplit::T(Patch *patch, float2 Pstart, float2 Pend)
 			else {
 				Camera* cam = params.camera;
 
-				float pixel_width = cam->world_to_raster_size((P + Plast) * 0.5f);
+				float3 Pmid = (P + Plast) * 0.5f;
+				float pixel_width = cam->world_to_raster_size(Pmid);
+
+				if(params.offscreen_dicing_scale > 1.0f)
+					pixel_width *= offscreen_dicing_factor(cam, Pmid, params.offscreen_dicing_scale);
+
 				L = len(P - Plast) / pixel_width;
 			}
 
@@ -222,6 +222,41 @@ ccl_device ssef color_srgb_to_scene_linear(const ssef &c)
 	ssef gte = fastpow24(gtebase);
 	return select(cmp, lt, gte);
 }
+
+/* Improve x ^ 5.0f/12.0f solution with Newton-Raphson method, x5 = x^5 */
+ccl_device_inline ssef improve_5_12_solution(const ssef &old_result, const ssef &x5)
+{
+	ssef approx2 = old_result * old_result;
+	ssef approx4 = approx2 * approx2;
+	ssef approx8 = approx4 * approx4;
+	ssef approx11 = approx8 * approx2 * old_result;
+	ssef t = x5 / approx11;
+	ssef summ = madd(ssef(11.0f), old_result, t);
+	return summ * ssef(1.0f/12.0f);
+}
+
+/* Calculate powf(x, 1.0f/2.4f). Working domain: 1e-7 < x < 1e+7 */
+ccl_device_inline ssef fastpow_inv24(const ssef &arg)
+{
+	/* Initial guess from the float representation, the exponent is too far
+	 * from 1 for fastpow() so the bias is applied directly on the bits.
+	 * 0x3F800000 = 1.0f */
+	ssef x = cast(ssei(madd(ssef(cast(arg)), ssef(5.0f/12.0f), ssef((7.0f/12.0f) * (float)0x3F800000))));
+	ssef arg2 = arg * arg;
+	ssef arg5 = arg2 * arg2 * arg;
+	x = improve_5_12_solution(x, arg5); /* error max = 0.034 */
+	x = improve_5_12_solution(x, arg5); /* error max = 0.0018 */
+	x = improve_5_12_solution(x, arg5); /* error max = 1.3e-05 */
+	return x;
+}
+
+ccl_device ssef color_scene_linear_to_srgb(const ssef &c)
+{
+	sseb cmp = c < ssef(0.0031308f);
+	ssef lt = max(c * ssef(12.92f), ssef(0.0f));
+	ssef gte = madd(ssef(1.055f), fastpow_inv24(max(c, ssef(0.0031308f))), ssef(-0.055f));
+	return select(cmp, lt, gte);
+}
 #endif
 
 ccl_device float3 color_scene_linear_to_srgb(float3 c)
@@ -44,6 +44,11 @@ public:
 
 		/* Whether QBVH usage is allowed or not. */
 		bool qbvh;
+
+		/* Whether path tracing is done on streams of sorted rays instead of
+		 * one path at a time.
+		 */
+		bool stream;
 	};
 
 	/* Descriptor of OpenCL feature-set to be used. */
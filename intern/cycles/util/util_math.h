@@ -1184,6 +1184,53 @@ ccl_device_inline void make_orthonormals(const float3 N, float3 *a, float3 *b)
 	*b = cross(N, *a);
 }
 
+/* Octahedral normal encoding
+ *
+ * Unit vector projected on an octahedron and unfolded to a square, stored
+ * as two 16 bit fixed point coordinates in a single uint. */
+
+ccl_device_inline float octahedral_sign(float f)
+{
+	return (f >= 0.0f)? 1.0f: -1.0f;
+}
+
+ccl_device_inline uint octahedral_encode(const float3 N)
+{
+	float sum = fabsf(N.x) + fabsf(N.y) + fabsf(N.z);
+
+	if(sum == 0.0f)
+		return 0x7fff7fff;
+
+	float u = N.x / sum;
+	float v = N.y / sum;
+
+	if(N.z < 0.0f) {
+		float fold_u = (1.0f - fabsf(v)) * octahedral_sign(u);
+		float fold_v = (1.0f - fabsf(u)) * octahedral_sign(v);
+		u = fold_u;
+		v = fold_v;
+	}
+
+	uint iu = (uint)(clamp(u*0.5f + 0.5f, 0.0f, 1.0f)*65535.0f + 0.5f);
+	uint iv = (uint)(clamp(v*0.5f + 0.5f, 0.0f, 1.0f)*65535.0f + 0.5f);
+
+	return iu | (iv << 16);
+}
+
+ccl_device_inline float3 octahedral_decode(uint packed)
+{
+	float u = (float)(packed & 0xffff) * (2.0f/65535.0f) - 1.0f;
+	float v = (float)(packed >> 16) * (2.0f/65535.0f) - 1.0f;
+	float3 N = make_float3(u, v, 1.0f - fabsf(u) - fabsf(v));
+
+	if(N.z < 0.0f) {
+		N.x = (1.0f - fabsf(v)) * octahedral_sign(u);
+		N.y = (1.0f - fabsf(u)) * octahedral_sign(v);
+	}
+
+	return normalize(N);
+}
+
 /* Color division */
 
 ccl_device_inline float3 safe_invert_color(float3 a)
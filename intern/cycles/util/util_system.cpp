@@ -16,8 +16,12 @@
 
 #include "util_system.h"
 #include "util_debug.h"
+#include "util_foreach.h"
 #include "util_types.h"
 #include "util_string.h"
+#include "util_vector.h"
+
+#include <stdio.h>
 
 #ifdef _WIN32
 #  if(!defined(FREE_WINDOWS))
@@ -28,6 +32,7 @@
 #  include <sys/sysctl.h>
 #  include <sys/types.h>
 #else
+#  include <sched.h>
 #  include <unistd.h>
 #endif
 
@@ -59,6 +64,146 @@ int system_cpu_thread_count()
 	return count;
 }
 
+/* NUMA topology */
+
+struct NUMATopology {
+	/* Processor indices of every node, empty when NUMA is not available. */
+	vector<vector<int> > node_processors;
+};
+
+#if !defined(_WIN32) && !defined(__APPLE__)
+/* Parse list in the kernel's cpulist format, for example "0-3,8-11". */
+static bool system_parse_cpulist(const char *filename, vector<int>& list)
+{
+	FILE *f = fopen(filename, "r");
+	if(f == NULL) {
+		return false;
+	}
+	list.clear();
+	int first, last;
+	while(fscanf(f, "%d", &first) == 1) {
+		last = first;
+		int c = fgetc(f);
+		if(c == '-') {
+			if(fscanf(f, "%d", &last) != 1) {
+				break;
+			}
+			c = fgetc(f);
+		}
+		for(int i = first; i <= last; i++) {
+			list.push_back(i);
+		}
+		if(c != ',') {
+			break;
+		}
+	}
+	fclose(f);
+	return !list.empty();
+}
+#endif
+
+static NUMATopology& system_numa_topology()
+{
+	static NUMATopology topology;
+	static bool topology_init = false;
+
+	if(topology_init) {
+		return topology;
+	}
+
+#ifdef _WIN32
+	ULONG highest_node;
+	if(GetNumaHighestNodeNumber(&highest_node)) {
+		for(ULONG node = 0; node <= highest_node; node++) {
+			ULONGLONG mask = 0;
+			vector<int> processors;
+			if(GetNumaNodeProcessorMask((UCHAR)node, &mask)) {
+				for(int i = 0; i < (int)sizeof(mask) * 8; i++) {
+					if(mask & ((ULONGLONG)1 << i)) {
+						processors.push_back(i);
+					}
+				}
+			}
+			if(!processors.empty()) {
+				topology.node_processors.push_back(processors);
+			}
+		}
+	}
+#elif !defined(__APPLE__)
+	vector<int> nodes;
+	if(system_parse_cpulist("/sys/devices/system/node/online", nodes)) {
+		foreach(int node, nodes) {
+			vector<int> processors;
+			string filename = string_printf(
+			        "/sys/devices/system/node/node%d/cpulist", node);
+			if(system_parse_cpulist(filename.c_str(), processors)) {
+				topology.node_processors.push_back(processors);
+			}
+		}
+	}
+#endif
+
+	/* Nothing to be gained from pinning on a single node. */
+	if(topology.node_processors.size() < 2) {
+		topology.node_processors.clear();
+	}
+
+	topology_init = true;
+	return topology;
+}
+
+bool system_cpu_is_numa_available()
+{
+	return !system_numa_topology().node_processors.empty();
+}
+
+int system_cpu_num_numa_nodes()
+{
+	if(!system_cpu_is_numa_available()) {
+		return 1;
+	}
+	return system_numa_topology().node_processors.size();
+}
+
+int system_cpu_num_numa_node_processors(int node)
+{
+	if(!system_cpu_is_numa_available()) {
+		return system_cpu_thread_count();
+	}
+	NUMATopology& topology = system_numa_topology();
+	assert(node >= 0 && node < (int)topology.node_processors.size());
+	return topology.node_processors[node].size();
+}
+
+bool system_cpu_run_thread_on_node(int node)
+{
+	if(!system_cpu_is_numa_available()) {
+		return false;
+	}
+	NUMATopology& topology = system_numa_topology();
+	if(node < 0 || node >= (int)topology.node_processors.size()) {
+		return false;
+	}
+	const vector<int>& processors = topology.node_processors[node];
+#ifdef _WIN32
+	DWORD_PTR mask = 0;
+	foreach(int processor, processors) {
+		mask |= (DWORD_PTR)1 << processor;
+	}
+	return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif !defined(__APPLE__)
+	cpu_set_t cpu_set;
+	CPU_ZERO(&cpu_set);
+	foreach(int processor, processors) {
+		CPU_SET(processor, &cpu_set);
+	}
+	return sched_setaffinity(0, sizeof(cpu_set), &cpu_set) == 0;
+#else
+	(void)processors;
+	return false;
+#endif
+}
+
 #if !defined(_WIN32) || defined(FREE_WINDOWS)
 static void __cpuid(int data[4], int selector)
 {
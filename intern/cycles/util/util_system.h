@@ -22,6 +22,15 @@
 CCL_NAMESPACE_BEGIN
 
 int system_cpu_thread_count();
+
+/* NUMA topology. When NUMA is not available the whole system is reported
+ * as a single node containing all the processors. */
+bool system_cpu_is_numa_available();
+int system_cpu_num_numa_nodes();
+int system_cpu_num_numa_node_processors(int node);
+/* Pin the calling thread to the processors of the given NUMA node. */
+bool system_cpu_run_thread_on_node(int node);
+
 string system_cpu_brand_string();
 int system_cpu_bits();
 bool system_cpu_support_sse2();
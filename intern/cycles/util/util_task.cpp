@@ -202,8 +202,22 @@ void TaskScheduler::init(int num_threads)
 		/* launch threads that will be waiting for work */
 		threads.resize(num_threads);
 
-		for(size_t i = 0; i < threads.size(); i++)
-			threads[i] = new thread(function_bind(&TaskScheduler::thread_run, i + 1));
+		/* on NUMA systems threads are grouped per node, filling up the
+		 * processors of one node before moving to the next one, so memory
+		 * touched by a thread tends to stay local to it. */
+		const bool use_numa = system_cpu_is_numa_available();
+		const int num_nodes = system_cpu_num_numa_nodes();
+		int node = 0, node_threads = 0;
+
+		for(size_t i = 0; i < threads.size(); i++) {
+			threads[i] = new thread(function_bind(&TaskScheduler::thread_run, i + 1),
+			                        use_numa ? node : -1);
+
+			if(use_numa && ++node_threads >= system_cpu_num_numa_node_processors(node)) {
+				node = (node + 1) % num_nodes;
+				node_threads = 0;
+			}
+		}
 	}
 	
 	users++;
@@ -260,7 +274,7 @@ void TaskScheduler::thread_run(int thread_id)
 {
 	Entry entry;
 
-	/* todo: test affinity/denormal mask */
+	/* todo: test denormal mask */
 
 	/* keep popping off tasks */
 	while(thread_wait_pop(entry)) {
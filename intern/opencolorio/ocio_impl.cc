@@ -437,13 +437,46 @@ void OCIOImpl::processorApply_predivide(OCIO_ConstProcessorRcPtr *processor, OCI
 			int width = img->getWidth();
 			int height = img->getHeight();
 
+			/* unpremultiply whole rows so the processor is applied to a row at once
+			 * instead of a single pixel, the processor may change alpha so it's
+			 * stored to premultiply the row back afterwards
+			 */
+			float *row_alpha = (float *) MEM_mallocN(sizeof(float) * width, __func__);
+
 			for (int y = 0; y < height; y++) {
+				float *row = pixels + 4 * ((size_t) y * width);
+
 				for (int x = 0; x < width; x++) {
-					float *pixel = pixels + 4 * (y * width + x);
+					float *pixel = row + 4 * x;
+					float alpha = pixel[3];
+
+					row_alpha[x] = alpha;
 
-					processorApplyRGBA_predivide(processor, pixel);
+					if (alpha != 1.0f && alpha != 0.0f) {
+						float inv_alpha = 1.0f / alpha;
+
+						pixel[0] *= inv_alpha;
+						pixel[1] *= inv_alpha;
+						pixel[2] *= inv_alpha;
+					}
+				}
+
+				PackedImageDesc row_img(row, width, 1, 4);
+				(*(ConstProcessorRcPtr *) processor)->apply(row_img);
+
+				for (int x = 0; x < width; x++) {
+					float *pixel = row + 4 * x;
+					float alpha = row_alpha[x];
+
+					if (alpha != 1.0f && alpha != 0.0f) {
+						pixel[0] *= alpha;
+						pixel[1] *= alpha;
+						pixel[2] *= alpha;
+					}
 				}
 			}
+
+			MEM_freeN(row_alpha);
 		}
 		else {
 			(*(ConstProcessorRcPtr *) processor)->apply(*img);
@@ -190,7 +190,18 @@ struct ImBuf *BKE_sequencer_give_ibuf(const SeqRenderData *context, float cfra,
 struct ImBuf *BKE_sequencer_give_ibuf_threaded(const SeqRenderData *context, float cfra, int chanshown);
 struct ImBuf *BKE_sequencer_give_ibuf_direct(const SeqRenderData *context, float cfra, struct Sequence *seq);
 struct ImBuf *BKE_sequencer_give_ibuf_seqbase(const SeqRenderData *context, float cfra, int chan_shown, struct ListBase *seqbasep);
-void BKE_sequencer_give_ibuf_prefetch_request(const SeqRenderData *context, float cfra, int chan_shown);
+bool BKE_sequencer_is_cached(const SeqRenderData *context, int cfra, int chanshown);
+
+/* **********************************************************************
+ * sequencer.c
+ *
+ * rendering of frames ahead of the current frame into the cache
+ * ********************************************************************** */
+
+bool BKE_sequencer_prefetch_needed(const SeqRenderData *context, int num_frames, int chanshown);
+void BKE_sequencer_prefetch(const SeqRenderData *context, int num_frames, int chanshown,
+                            short *stop, short *do_update, float *progress);
+void BKE_sequencer_prefetch_stop(void);
 
 /* **********************************************************************
  * sequencer.c
@@ -272,6 +283,7 @@ void BKE_sequencer_cache_cleanup(void);
 
 /* returned ImBuf is properly refed and has to be freed */
 struct ImBuf *BKE_sequencer_cache_get(const SeqRenderData *context, struct Sequence *seq, float cfra, eSeqStripElemIBuf type);
+bool BKE_sequencer_cache_has(const SeqRenderData *context, struct Sequence *seq, float cfra, eSeqStripElemIBuf type);
 
 /* passed ImBuf is properly refed, so ownership is *not* 
  * transferred to the cache.
@@ -281,6 +293,7 @@ struct ImBuf *BKE_sequencer_cache_get(const SeqRenderData *context, struct Seque
 void BKE_sequencer_cache_put(const SeqRenderData *context, struct Sequence *seq, float cfra, eSeqStripElemIBuf type, struct ImBuf *nval);
 
 void BKE_sequencer_cache_cleanup_sequence(struct Sequence *seq);
+void BKE_sequencer_cache_cleanup_before_frame(struct Scene *scene, float cfra);
 
 struct ImBuf *BKE_sequencer_preprocessed_cache_get(const SeqRenderData *context, struct Sequence *seq, float cfra, eSeqStripElemIBuf type);
 void BKE_sequencer_preprocessed_cache_put(const SeqRenderData *context, struct Sequence *seq, float cfra, eSeqStripElemIBuf type, struct ImBuf *ibuf);
@@ -265,6 +265,9 @@ static void movieclip_open_anim_file(MovieClip *clip)
 		clip->anim = openanim(str, IB_rect, 0, clip->colorspace_settings.name);
 
 		if (clip->anim) {
+			/* decode ahead during playback */
+			IMB_anim_set_prefetch(clip->anim, 8);
+
 			if (clip->flag & MCLIP_USE_PROXY_CUSTOM_DIR) {
 				char dir[FILE_MAX];
 				BLI_strncpy(dir, clip->proxy.dir, sizeof(dir));
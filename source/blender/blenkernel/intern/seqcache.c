@@ -40,6 +40,7 @@
 #include "IMB_imbuf_types.h"
 
 #include "BLI_listbase.h"
+#include "BLI_threads.h"
 
 #include "BKE_sequencer.h"
 #include "BKE_scene.h"
@@ -69,6 +70,9 @@ typedef struct SeqPreprocessCache {
 static struct MovieCache *moviecache = NULL;
 static struct SeqPreprocessCache *preprocess_cache = NULL;
 
+/* caches are used by the prefetch job and the main thread at the same time */
+static ThreadMutex cache_lock = BLI_MUTEX_INITIALIZER;
+
 static void preprocessed_cache_destruct(void);
 
 static bool seq_cmp_render_data(const SeqRenderData *a, const SeqRenderData *b)
@@ -131,10 +135,15 @@ void BKE_sequencer_cache_destruct(void)
 
 void BKE_sequencer_cache_cleanup(void)
 {
+	/* frames rendered ahead would use the old data */
+	BKE_sequencer_prefetch_stop();
+
+	BLI_mutex_lock(&cache_lock);
 	if (moviecache) {
 		IMB_moviecache_free(moviecache);
 		moviecache = IMB_moviecache_create("seqcache", sizeof(SeqCacheKey), seqcache_hashhash, seqcache_hashcmp);
 	}
+	BLI_mutex_unlock(&cache_lock);
 
 	BKE_sequencer_preprocessed_cache_cleanup();
 }
@@ -149,13 +158,45 @@ static bool seqcache_key_check_seq(ImBuf *UNUSED(ibuf), void *userkey, void *use
 
 void BKE_sequencer_cache_cleanup_sequence(Sequence *seq)
 {
+	BKE_sequencer_prefetch_stop();
+
+	BLI_mutex_lock(&cache_lock);
 	if (moviecache)
 		IMB_moviecache_cleanup(moviecache, seqcache_key_check_seq, seq);
+	BLI_mutex_unlock(&cache_lock);
+}
+
+typedef struct SeqCacheCheckFrameData {
+	Scene *scene;
+	float cfra;
+} SeqCacheCheckFrameData;
+
+static bool seqcache_key_check_before_frame(ImBuf *UNUSED(ibuf), void *userkey, void *userdata)
+{
+	SeqCacheKey *key = (SeqCacheKey *) userkey;
+	SeqCacheCheckFrameData *data = (SeqCacheCheckFrameData *) userdata;
+
+	return (key->context.scene == data->scene) && (key->seq->start + key->cfra < data->cfra);
+}
+
+void BKE_sequencer_cache_cleanup_before_frame(Scene *scene, float cfra)
+{
+	SeqCacheCheckFrameData data;
+
+	data.scene = scene;
+	data.cfra = cfra;
+
+	BLI_mutex_lock(&cache_lock);
+	if (moviecache)
+		IMB_moviecache_cleanup(moviecache, seqcache_key_check_before_frame, &data);
+	BLI_mutex_unlock(&cache_lock);
 }
 
 struct ImBuf *BKE_sequencer_cache_get(const SeqRenderData *context, Sequence *seq, float cfra, eSeqStripElemIBuf type)
 {
-	if (moviecache && seq) {
+	ImBuf *ibuf = NULL;
+
+	if (seq) {
 		SeqCacheKey key;
 
 		key.seq = seq;
@@ -163,10 +204,34 @@ struct ImBuf *BKE_sequencer_cache_get(const SeqRenderData *context, Sequence *se
 		key.cfra = cfra - seq->start;
 		key.type = type;
 
-		return IMB_moviecache_get(moviecache, &key);
+		BLI_mutex_lock(&cache_lock);
+		if (moviecache)
+			ibuf = IMB_moviecache_get(moviecache, &key);
+		BLI_mutex_unlock(&cache_lock);
 	}
 
-	return NULL;
+	return ibuf;
+}
+
+bool BKE_sequencer_cache_has(const SeqRenderData *context, Sequence *seq, float cfra, eSeqStripElemIBuf type)
+{
+	bool has_frame = false;
+
+	if (seq) {
+		SeqCacheKey key;
+
+		key.seq = seq;
+		key.context = *context;
+		key.cfra = cfra - seq->start;
+		key.type = type;
+
+		BLI_mutex_lock(&cache_lock);
+		if (moviecache)
+			has_frame = IMB_moviecache_has_frame(moviecache, &key);
+		BLI_mutex_unlock(&cache_lock);
+	}
+
+	return has_frame;
 }
 
 void BKE_sequencer_cache_put(const SeqRenderData *context, Sequence *seq, float cfra, eSeqStripElemIBuf type, ImBuf *i)
@@ -177,19 +242,23 @@ void BKE_sequencer_cache_put(const SeqRenderData *context, Sequence *seq, float
 		return;
 	}
 
-	if (!moviecache) {
-		moviecache = IMB_moviecache_create("seqcache", sizeof(SeqCacheKey), seqcache_hashhash, seqcache_hashcmp);
-	}
-
 	key.seq = seq;
 	key.context = *context;
 	key.cfra = cfra - seq->start;
 	key.type = type;
 
+	BLI_mutex_lock(&cache_lock);
+
+	if (!moviecache) {
+		moviecache = IMB_moviecache_create("seqcache", sizeof(SeqCacheKey), seqcache_hashhash, seqcache_hashcmp);
+	}
+
 	IMB_moviecache_put(moviecache, &key, i);
+
+	BLI_mutex_unlock(&cache_lock);
 }
 
-void BKE_sequencer_preprocessed_cache_cleanup(void)
+static void preprocessed_cache_cleanup(void)
 {
 	SeqPreprocessCacheElem *elem;
 
@@ -204,12 +273,19 @@ void BKE_sequencer_preprocessed_cache_cleanup(void)
 	BLI_listbase_clear(&preprocess_cache->elems);
 }
 
+void BKE_sequencer_preprocessed_cache_cleanup(void)
+{
+	BLI_mutex_lock(&cache_lock);
+	preprocessed_cache_cleanup();
+	BLI_mutex_unlock(&cache_lock);
+}
+
 static void preprocessed_cache_destruct(void)
 {
 	if (!preprocess_cache)
 		return;
 
-	BKE_sequencer_preprocessed_cache_cleanup();
+	preprocessed_cache_cleanup();
 
 	MEM_freeN(preprocess_cache);
 	preprocess_cache = NULL;
@@ -218,12 +294,14 @@ static void preprocessed_cache_destruct(void)
 ImBuf *BKE_sequencer_preprocessed_cache_get(const SeqRenderData *context, Sequence *seq, float cfra, eSeqStripElemIBuf type)
 {
 	SeqPreprocessCacheElem *elem;
+	ImBuf *ibuf = NULL;
 
-	if (!preprocess_cache)
-		return NULL;
+	BLI_mutex_lock(&cache_lock);
 
-	if (preprocess_cache->cfra != cfra)
+	if (!preprocess_cache || preprocess_cache->cfra != cfra) {
+		BLI_mutex_unlock(&cache_lock);
 		return NULL;
+	}
 
 	for (elem = preprocess_cache->elems.first; elem; elem = elem->next) {
 		if (elem->seq != seq)
@@ -236,22 +314,27 @@ ImBuf *BKE_sequencer_preprocessed_cache_get(const SeqRenderData *context, Sequen
 			continue;
 
 		IMB_refImBuf(elem->ibuf);
-		return elem->ibuf;
+		ibuf = elem->ibuf;
+		break;
 	}
 
-	return NULL;
+	BLI_mutex_unlock(&cache_lock);
+
+	return ibuf;
 }
 
 void BKE_sequencer_preprocessed_cache_put(const SeqRenderData *context, Sequence *seq, float cfra, eSeqStripElemIBuf type, ImBuf *ibuf)
 {
 	SeqPreprocessCacheElem *elem;
 
+	BLI_mutex_lock(&cache_lock);
+
 	if (!preprocess_cache) {
 		preprocess_cache = MEM_callocN(sizeof(SeqPreprocessCache), "sequencer preprocessed cache");
 	}
 	else {
 		if (preprocess_cache->cfra != cfra)
-			BKE_sequencer_preprocessed_cache_cleanup();
+			preprocessed_cache_cleanup();
 	}
 
 	elem = MEM_callocN(sizeof(SeqPreprocessCacheElem), "sequencer preprocessed cache element");
@@ -266,22 +349,27 @@ void BKE_sequencer_preprocessed_cache_put(const SeqRenderData *context, Sequence
 	IMB_refImBuf(ibuf);
 
 	BLI_addtail(&preprocess_cache->elems, elem);
+
+	BLI_mutex_unlock(&cache_lock);
 }
 
 void BKE_sequencer_preprocessed_cache_cleanup_sequence(Sequence *seq)
 {
 	SeqPreprocessCacheElem *elem, *elem_next;
 
-	if (!preprocess_cache)
-		return;
+	BLI_mutex_lock(&cache_lock);
 
-	for (elem = preprocess_cache->elems.first; elem; elem = elem_next) {
-		elem_next = elem->next;
+	if (preprocess_cache) {
+		for (elem = preprocess_cache->elems.first; elem; elem = elem_next) {
+			elem_next = elem->next;
 
-		if (elem->seq == seq) {
-			IMB_freeImBuf(elem->ibuf);
+			if (elem->seq == seq) {
+				IMB_freeImBuf(elem->ibuf);
 
-			BLI_freelinkN(&preprocess_cache->elems, elem);
+				BLI_freelinkN(&preprocess_cache->elems, elem);
+			}
 		}
 	}
+
+	BLI_mutex_unlock(&cache_lock);
 }
@@ -40,6 +40,7 @@
 #include "BLI_utildefines.h"
 #include "BLI_rect.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
 
 #include "DNA_scene_types.h"
 #include "DNA_sequence_types.h"
@@ -1561,8 +1562,8 @@ static void copy_wipe_effect(Sequence *dst, Sequence *src)
 	dst->effectdata = MEM_dupallocN(src->effectdata);
 }
 
-static void do_wipe_effect_byte(Sequence *seq, float facf0, float UNUSED(facf1),  int x, int y, unsigned char *rect1,
-                                unsigned char *rect2, unsigned char *out)
+static void do_wipe_effect_byte(Sequence *seq, float facf0, float UNUSED(facf1), int x, int y, int start_line,
+                                int total_lines, unsigned char *rect1, unsigned char *rect2, unsigned char *out)
 {
 	WipeZone wipezone;
 	WipeVars *wipe = (WipeVars *)seq->effectdata;
@@ -1575,9 +1576,10 @@ static void do_wipe_effect_byte(Sequence *seq, float facf0, float UNUSED(facf1),
 	cp2 = rect2;
 	rt = out;
 
+	/* the wipe zone depends on the full frame, only the lines of the slice are done */
 	xo = x;
-	yo = y;
-	for (y = 0; y < yo; y++) {
+	yo = start_line + total_lines;
+	for (y = start_line; y < yo; y++) {
 		for (x = 0; x < xo; x++) {
 			float check = check_zone(&wipezone, x, y, seq, facf0);
 			if (check) {
@@ -1627,8 +1629,8 @@ static void do_wipe_effect_byte(Sequence *seq, float facf0, float UNUSED(facf1),
 	}
 }
 
-static void do_wipe_effect_float(Sequence *seq, float facf0, float UNUSED(facf1), int x, int y, float *rect1,
-                                 float *rect2, float *out)
+static void do_wipe_effect_float(Sequence *seq, float facf0, float UNUSED(facf1), int x, int y, int start_line,
+                                 int total_lines, float *rect1, float *rect2, float *out)
 {
 	WipeZone wipezone;
 	WipeVars *wipe = (WipeVars *)seq->effectdata;
@@ -1642,8 +1644,8 @@ static void do_wipe_effect_float(Sequence *seq, float facf0, float UNUSED(facf1)
 	rt = out;
 
 	xo = x;
-	yo = y;
-	for (y = 0; y < yo; y++) {
+	yo = start_line + total_lines;
+	for (y = start_line; y < yo; y++) {
 		for (x = 0; x < xo; x++) {
 			float check = check_zone(&wipezone, x, y, seq, facf0);
 			if (check) {
@@ -1686,21 +1688,26 @@ static void do_wipe_effect_float(Sequence *seq, float facf0, float UNUSED(facf1)
 	}
 }
 
-static ImBuf *do_wipe_effect(const SeqRenderData *context, Sequence *seq, float UNUSED(cfra), float facf0, float facf1,
-                             ImBuf *ibuf1, ImBuf *ibuf2, ImBuf *ibuf3)
+static void do_wipe_effect(const SeqRenderData *context, Sequence *seq, float UNUSED(cfra), float facf0, float facf1,
+                           ImBuf *ibuf1, ImBuf *ibuf2, ImBuf *UNUSED(ibuf3), int start_line, int total_lines, ImBuf *out)
 {
-	ImBuf *out = prepare_effect_imbufs(context, ibuf1, ibuf2, ibuf3);
+	int offset = 4 * start_line * context->rectx;
 
+	/* inputs without a buffer of the type of the output are treated as black */
 	if (out->rect_float) {
-		do_wipe_effect_float(seq, facf0, facf1, context->rectx, context->recty, ibuf1->rect_float,
-		                     ibuf2->rect_float, out->rect_float);
+		float *rect1 = ibuf1->rect_float ? ibuf1->rect_float + offset : NULL;
+		float *rect2 = ibuf2->rect_float ? ibuf2->rect_float + offset : NULL;
+
+		do_wipe_effect_float(seq, facf0, facf1, context->rectx, context->recty, start_line, total_lines,
+		                     rect1, rect2, out->rect_float + offset);
 	}
 	else {
-		do_wipe_effect_byte(seq, facf0, facf1, context->rectx, context->recty, (unsigned char *) ibuf1->rect,
-		                    (unsigned char *) ibuf2->rect, (unsigned char *) out->rect);
-	}
+		unsigned char *rect1 = ibuf1->rect ? (unsigned char *) ibuf1->rect + offset : NULL;
+		unsigned char *rect2 = ibuf2->rect ? (unsigned char *) ibuf2->rect + offset : NULL;
 
-	return out;
+		do_wipe_effect_byte(seq, facf0, facf1, context->rectx, context->recty, start_line, total_lines,
+		                    rect1, rect2, (unsigned char *) out->rect + offset);
+	}
 }
 
 /*********************** Transform *************************/
@@ -1745,8 +1752,9 @@ static void copy_transform_effect(Sequence *dst, Sequence *src)
 	dst->effectdata = MEM_dupallocN(src->effectdata);
 }
 
-static void transform_image(int x, int y, ImBuf *ibuf1, ImBuf *out,  float scale_x, float scale_y,
-                            float translate_x, float translate_y, float rotate, int interpolation)
+static void transform_image(int x, int y, int start_line, int total_lines, ImBuf *ibuf1, ImBuf *out,
+                            float scale_x, float scale_y, float translate_x, float translate_y,
+                            float rotate, int interpolation)
 {
 	int xo, yo, xi, yi;
 	float xt, yt, xr, yr;
@@ -1759,7 +1767,7 @@ static void transform_image(int x, int y, ImBuf *ibuf1, ImBuf *out,  float scale
 	s = sinf(rotate);
 	c = cosf(rotate);
 
-	for (yi = 0; yi < yo; yi++) {
+	for (yi = start_line; yi < start_line + total_lines; yi++) {
 		for (xi = 0; xi < xo; xi++) {
 			/* translate point */
 			xt = xi - translate_x;
@@ -1793,7 +1801,8 @@ static void transform_image(int x, int y, ImBuf *ibuf1, ImBuf *out,  float scale
 	}
 }
 
-static void do_transform(Scene *scene, Sequence *seq, float UNUSED(facf0), int x, int y,  ImBuf *ibuf1, ImBuf *out)
+static void do_transform(Scene *scene, Sequence *seq, float UNUSED(facf0), int x, int y, int start_line,
+                         int total_lines, ImBuf *ibuf1, ImBuf *out)
 {
 	TransformVars *transform = (TransformVars *) seq->effectdata;
 	float scale_x, scale_y, translate_x, translate_y, rotate_radians;
@@ -1822,22 +1831,144 @@ static void do_transform(Scene *scene, Sequence *seq, float UNUSED(facf0), int x
 	/* Rotate */
 	rotate_radians = DEG2RADF(transform->rotIni);
 
-	transform_image(x, y, ibuf1, out, scale_x, scale_y, translate_x, translate_y, rotate_radians, transform->interpolation);
+	transform_image(x, y, start_line, total_lines, ibuf1, out, scale_x, scale_y, translate_x, translate_y,
+	                rotate_radians, transform->interpolation);
 }
 
 
-static ImBuf *do_transform_effect(const SeqRenderData *context, Sequence *seq, float UNUSED(cfra), float facf0,
-                                  float UNUSED(facf1), ImBuf *ibuf1, ImBuf *ibuf2, ImBuf *ibuf3)
+static void do_transform_effect(const SeqRenderData *context, Sequence *seq, float UNUSED(cfra), float facf0,
+                                float UNUSED(facf1), ImBuf *ibuf1, ImBuf *UNUSED(ibuf2), ImBuf *UNUSED(ibuf3),
+                                int start_line, int total_lines, ImBuf *out)
 {
-	ImBuf *out = prepare_effect_imbufs(context, ibuf1, ibuf2, ibuf3);
-
-	do_transform(context->scene, seq, facf0, context->rectx, context->recty, ibuf1, out);
-
-	return out;
+	do_transform(context->scene, seq, facf0, context->rectx, context->recty, start_line, total_lines, ibuf1, out);
 }
 
 /*********************** Glow *************************/
 
+/* images smaller than this are not worth threading */
+#define GLOW_THREAD_MIN_LINES 64
+
+typedef struct GlowBlurData {
+	const float *map;
+	float *temp;
+	const float *filter;
+	int width, height;
+	int halfWidth;
+} GlowBlurData;
+
+static void glow_blur_row_cb(void *userdata, const int y)
+{
+	GlowBlurData *data = userdata;
+	const float *map = data->map;
+	const float *filter = data->filter;
+	float *temp = data->temp;
+	const int width = data->width;
+	const int halfWidth = data->halfWidth;
+	int x, i, fx, index;
+	float curColor[3], curColor2[3];
+
+	/* Do the left & right strips */
+	for (x = 0; x < halfWidth; x++) {
+		index = (x + y * width) * 4;
+		fx = 0;
+		zero_v3(curColor);
+		zero_v3(curColor2);
+
+		for (i = x - halfWidth; i < x + halfWidth; i++) {
+			if ((i >= 0) && (i < width)) {
+				curColor[0] += map[(i + y * width) * 4 + GlowR] * filter[fx];
+				curColor[1] += map[(i + y * width) * 4 + GlowG] * filter[fx];
+				curColor[2] += map[(i + y * width) * 4 + GlowB] * filter[fx];
+
+				curColor2[0] += map[(width - 1 - i + y * width) * 4 + GlowR] * filter[fx];
+				curColor2[1] += map[(width - 1 - i + y * width) * 4 + GlowG] * filter[fx];
+				curColor2[2] += map[(width - 1 - i + y * width) * 4 + GlowB] * filter[fx];
+			}
+			fx++;
+		}
+		temp[index + GlowR] = curColor[0];
+		temp[index + GlowG] = curColor[1];
+		temp[index + GlowB] = curColor[2];
+
+		temp[((width - 1 - x + y * width) * 4) + GlowR] = curColor2[0];
+		temp[((width - 1 - x + y * width) * 4) + GlowG] = curColor2[1];
+		temp[((width - 1 - x + y * width) * 4) + GlowB] = curColor2[2];
+	}
+
+	/* Do the main body */
+	for (x = halfWidth; x < width - halfWidth; x++) {
+		const float *in = map + (x - halfWidth + y * width) * 4;
+
+		index = (x + y * width) * 4;
+		zero_v3(curColor);
+		for (fx = 0; fx < 2 * halfWidth; fx++, in += 4) {
+			curColor[0] += in[GlowR] * filter[fx];
+			curColor[1] += in[GlowG] * filter[fx];
+			curColor[2] += in[GlowB] * filter[fx];
+		}
+		temp[index + GlowR] = curColor[0];
+		temp[index + GlowG] = curColor[1];
+		temp[index + GlowB] = curColor[2];
+	}
+}
+
+static void glow_blur_column_cb(void *userdata, const int x)
+{
+	GlowBlurData *data = userdata;
+	const float *map = data->map;
+	const float *filter = data->filter;
+	float *temp = data->temp;
+	const int width = data->width;
+	const int height = data->height;
+	const int halfWidth = data->halfWidth;
+	int y, i, fy, index;
+	float curColor[3], curColor2[3];
+
+	/* Do the top & bottom strips */
+	for (y = 0; y < halfWidth; y++) {
+		index = (x + y * width) * 4;
+		fy = 0;
+		zero_v3(curColor);
+		zero_v3(curColor2);
+		for (i = y - halfWidth; i < y + halfWidth; i++) {
+			if ((i >= 0) && (i < height)) {
+				/* Bottom */
+				curColor[0] += map[(x + i * width) * 4 + GlowR] * filter[fy];
+				curColor[1] += map[(x + i * width) * 4 + GlowG] * filter[fy];
+				curColor[2] += map[(x + i * width) * 4 + GlowB] * filter[fy];
+
+				/* Top */
+				curColor2[0] += map[(x + (height - 1 - i) * width) * 4 + GlowR] * filter[fy];
+				curColor2[1] += map[(x + (height - 1 - i) * width) * 4 + GlowG] * filter[fy];
+				curColor2[2] += map[(x + (height - 1 - i) * width) * 4 + GlowB] * filter[fy];
+			}
+			fy++;
+		}
+		temp[index + GlowR] = curColor[0];
+		temp[index + GlowG] = curColor[1];
+		temp[index + GlowB] = curColor[2];
+		temp[((x + (height - 1 - y) * width) * 4) + GlowR] = curColor2[0];
+		temp[((x + (height - 1 - y) * width) * 4) + GlowG] = curColor2[1];
+		temp[((x + (height - 1 - y) * width) * 4) + GlowB] = curColor2[2];
+	}
+
+	/* Do the main body */
+	for (y = halfWidth; y < height - halfWidth; y++) {
+		const float *in = map + (x + (y - halfWidth) * width) * 4;
+
+		index = (x + y * width) * 4;
+		zero_v3(curColor);
+		for (fy = 0; fy < 2 * halfWidth; fy++, in += 4 * width) {
+			curColor[0] += in[GlowR] * filter[fy];
+			curColor[1] += in[GlowG] * filter[fy];
+			curColor[2] += in[GlowB] * filter[fy];
+		}
+		temp[index + GlowR] = curColor[0];
+		temp[index + GlowG] = curColor[1];
+		temp[index + GlowB] = curColor[2];
+	}
+}
+
 static void RVBlurBitmap2_float(float *map, int width, int height, float blur, int quality)
 /*	MUUUCCH better than the previous blur. */
 /*	We do the blurring in two passes which is a whole lot faster. */
@@ -1848,11 +1979,11 @@ static void RVBlurBitmap2_float(float *map, int width, int height, float blur, i
 /*	a small bitmap.  Avoid avoid avoid. */
 /*=============================== */
 {
-	float *temp = NULL, *swap;
+	GlowBlurData data;
+	float *temp = NULL;
 	float *filter = NULL;
-	int x, y, i, fx, fy;
-	int index, ix, halfWidth;
-	float fval, k, curColor[3], curColor2[3], weight = 0;
+	int ix, halfWidth;
+	float fval, k, weight = 0;
 
 	/* If we're not really blurring, bail out */
 	if (blur <= 0)
@@ -1893,154 +2024,105 @@ static void RVBlurBitmap2_float(float *map, int width, int height, float blur, i
 	for (ix = 0; ix < halfWidth * 2; ix++)
 		filter[ix] /= fval;
 
-	/* Blur the rows */
-	for (y = 0; y < height; y++) {
-		/* Do the left & right strips */
-		for (x = 0; x < halfWidth; x++) {
-			index = (x + y * width) * 4;
-			fx = 0;
-			curColor[0] = curColor[1] = curColor[2] = 0.0f;
-			curColor2[0] = curColor2[1] = curColor2[2] = 0.0f;
-
-			for (i = x - halfWidth; i < x + halfWidth; i++) {
-				if ((i >= 0) && (i < width)) {
-					curColor[0] += map[(i + y * width) * 4 + GlowR] * filter[fx];
-					curColor[1] += map[(i + y * width) * 4 + GlowG] * filter[fx];
-					curColor[2] += map[(i + y * width) * 4 + GlowB] * filter[fx];
-
-					curColor2[0] += map[(width - 1 - i + y * width) * 4 + GlowR] * filter[fx];
-					curColor2[1] += map[(width - 1 - i + y * width) * 4 + GlowG] * filter[fx];
-					curColor2[2] += map[(width - 1 - i + y * width) * 4 + GlowB] * filter[fx];
-				}
-				fx++;
-			}
-			temp[index + GlowR] = curColor[0];
-			temp[index + GlowG] = curColor[1];
-			temp[index + GlowB] = curColor[2];
-
-			temp[((width - 1 - x + y * width) * 4) + GlowR] = curColor2[0];
-			temp[((width - 1 - x + y * width) * 4) + GlowG] = curColor2[1];
-			temp[((width - 1 - x + y * width) * 4) + GlowB] = curColor2[2];
+	data.filter = filter;
+	data.width = width;
+	data.height = height;
+	data.halfWidth = halfWidth;
 
-		}
+	/* Blur the rows into the tempmap, every row is independent of the others */
+	data.map = map;
+	data.temp = temp;
+	BLI_task_parallel_range(0, height, &data, glow_blur_row_cb, height > GLOW_THREAD_MIN_LINES);
 
-		/* Do the main body */
-		for (x = halfWidth; x < width - halfWidth; x++) {
-			index = (x + y * width) * 4;
-			fx = 0;
-			zero_v3(curColor);
-			for (i = x - halfWidth; i < x + halfWidth; i++) {
-				curColor[0] += map[(i + y * width) * 4 + GlowR] * filter[fx];
-				curColor[1] += map[(i + y * width) * 4 + GlowG] * filter[fx];
-				curColor[2] += map[(i + y * width) * 4 + GlowB] * filter[fx];
-				fx++;
-			}
-			temp[index + GlowR] = curColor[0];
-			temp[index + GlowG] = curColor[1];
-			temp[index + GlowB] = curColor[2];
-		}
-	}
-
-	/* Swap buffers */
-	swap = temp; temp = map; map = swap;
-
-	/* Blur the columns */
-	for (x = 0; x < width; x++) {
-		/* Do the top & bottom strips */
-		for (y = 0; y < halfWidth; y++) {
-			index = (x + y * width) * 4;
-			fy = 0;
-			zero_v3(curColor);
-			zero_v3(curColor2);
-			for (i = y - halfWidth; i < y + halfWidth; i++) {
-				if ((i >= 0) && (i < height)) {
-					/* Bottom */
-					curColor[0] += map[(x + i * width) * 4 + GlowR] * filter[fy];
-					curColor[1] += map[(x + i * width) * 4 + GlowG] * filter[fy];
-					curColor[2] += map[(x + i * width) * 4 + GlowB] * filter[fy];
-
-					/* Top */
-					curColor2[0] += map[(x + (height - 1 - i) * width) * 4 + GlowR] * filter[fy];
-					curColor2[1] += map[(x + (height - 1 - i) * width) * 4 + GlowG] * filter[fy];
-					curColor2[2] += map[(x + (height - 1 - i) * width) * 4 + GlowB] * filter[fy];
-				}
-				fy++;
-			}
-			temp[index + GlowR] = curColor[0];
-			temp[index + GlowG] = curColor[1];
-			temp[index + GlowB] = curColor[2];
-			temp[((x + (height - 1 - y) * width) * 4) + GlowR] = curColor2[0];
-			temp[((x + (height - 1 - y) * width) * 4) + GlowG] = curColor2[1];
-			temp[((x + (height - 1 - y) * width) * 4) + GlowB] = curColor2[2];
-		}
-	
-		/* Do the main body */
-		for (y = halfWidth; y < height - halfWidth; y++) {
-			index = (x + y * width) * 4;
-			fy = 0;
-			zero_v3(curColor);
-			for (i = y - halfWidth; i < y + halfWidth; i++) {
-				curColor[0] += map[(x + i * width) * 4 + GlowR] * filter[fy];
-				curColor[1] += map[(x + i * width) * 4 + GlowG] * filter[fy];
-				curColor[2] += map[(x + i * width) * 4 + GlowB] * filter[fy];
-				fy++;
-			}
-			temp[index + GlowR] = curColor[0];
-			temp[index + GlowG] = curColor[1];
-			temp[index + GlowB] = curColor[2];
-		}
-	}
-
-	/* Swap buffers */
-	swap = temp; temp = map; /* map = swap; */ /* UNUSED */
+	/* Blur the columns back into the map */
+	data.map = temp;
+	data.temp = map;
+	BLI_task_parallel_range(0, width, &data, glow_blur_column_cb, width > GLOW_THREAD_MIN_LINES);
 
 	/* Tidy up	 */
 	MEM_freeN(filter);
 	MEM_freeN(temp);
 }
 
-static void RVAddBitmaps_float(float *a, float *b, float *c, int width, int height)
+typedef struct GlowPixelData {
+	const float *a, *b;
+	float *c;
+	int width;
+	float threshold, boost, clamp;
+} GlowPixelData;
+
+static void glow_add_bitmaps_cb(void *userdata, const int y)
 {
-	int x, y, index;
+	GlowPixelData *data = userdata;
+	const int offset = 4 * y * data->width;
+	const float *a = data->a + offset;
+	const float *b = data->b + offset;
+	float *c = data->c + offset;
+	int index;
 
-	for (y = 0; y < height; y++) {
-		for (x = 0; x < width; x++) {
-			index = (x + y * width) * 4;
-			c[index + GlowR] = MIN2(1.0f, a[index + GlowR] + b[index + GlowR]);
-			c[index + GlowG] = MIN2(1.0f, a[index + GlowG] + b[index + GlowG]);
-			c[index + GlowB] = MIN2(1.0f, a[index + GlowB] + b[index + GlowB]);
-			c[index + GlowA] = MIN2(1.0f, a[index + GlowA] + b[index + GlowA]);
-		}
+	/* plain loop over all channels, so the compiler can vectorize it */
+	for (index = 0; index < 4 * data->width; index++) {
+		c[index] = min_ff(1.0f, a[index] + b[index]);
 	}
 }
 
-static void RVIsolateHighlights_float(float *in, float *out, int width, int height, float threshold, float boost, float clamp)
+static void RVAddBitmaps_float(float *a, float *b, float *c, int width, int height)
+{
+	GlowPixelData data;
+
+	data.a = a;
+	data.b = b;
+	data.c = c;
+	data.width = width;
+
+	BLI_task_parallel_range(0, height, &data, glow_add_bitmaps_cb, height > GLOW_THREAD_MIN_LINES);
+}
+
+static void glow_isolate_highlights_cb(void *userdata, const int y)
 {
-	int x, y, index;
+	GlowPixelData *data = userdata;
+	const int offset = 4 * y * data->width;
+	const float *in = data->a + offset;
+	float *out = data->c + offset;
+	const float threshold = data->threshold;
+	const float boost = data->boost;
+	const float clamp = data->clamp;
+	int x;
 	float intensity;
 
-	for (y = 0; y < height; y++) {
-		for (x = 0; x < width; x++) {
-			index = (x + y * width) * 4;
-
-			/* Isolate the intensity */
-			intensity = (in[index + GlowR] + in[index + GlowG] + in[index + GlowB] - threshold);
-			if (intensity > 0) {
-				out[index + GlowR] = MIN2(clamp, (in[index + GlowR] * boost * intensity));
-				out[index + GlowG] = MIN2(clamp, (in[index + GlowG] * boost * intensity));
-				out[index + GlowB] = MIN2(clamp, (in[index + GlowB] * boost * intensity));
-				out[index + GlowA] = MIN2(clamp, (in[index + GlowA] * boost * intensity));
-			}
-			else {
-				out[index + GlowR] = 0;
-				out[index + GlowG] = 0;
-				out[index + GlowB] = 0;
-				out[index + GlowA] = 0;
-			}
+	for (x = 0; x < data->width; x++, in += 4, out += 4) {
+		/* Isolate the intensity */
+		intensity = (in[GlowR] + in[GlowG] + in[GlowB] - threshold);
+		if (intensity > 0) {
+			out[GlowR] = MIN2(clamp, (in[GlowR] * boost * intensity));
+			out[GlowG] = MIN2(clamp, (in[GlowG] * boost * intensity));
+			out[GlowB] = MIN2(clamp, (in[GlowB] * boost * intensity));
+			out[GlowA] = MIN2(clamp, (in[GlowA] * boost * intensity));
+		}
+		else {
+			out[GlowR] = 0;
+			out[GlowG] = 0;
+			out[GlowB] = 0;
+			out[GlowA] = 0;
 		}
 	}
 }
 
+static void RVIsolateHighlights_float(float *in, float *out, int width, int height, float threshold, float boost, float clamp)
+{
+	GlowPixelData data;
+
+	data.a = in;
+	data.b = NULL;
+	data.c = out;
+	data.width = width;
+	data.threshold = threshold;
+	data.boost = boost;
+	data.clamp = clamp;
+
+	BLI_task_parallel_range(0, height, &data, glow_isolate_highlights_cb, height > GLOW_THREAD_MIN_LINES);
+}
+
 static void init_glow_effect(Sequence *seq)
 {
 	GlowVars *glow;
@@ -2171,84 +2253,63 @@ static int early_out_color(Sequence *UNUSED(seq), float UNUSED(facf0), float UNU
 	return EARLY_NO_INPUT;
 }
 
-static ImBuf *do_solid_color(const SeqRenderData *context, Sequence *seq, float UNUSED(cfra), float facf0, float facf1,
-                             ImBuf *ibuf1, ImBuf *ibuf2, ImBuf *ibuf3)
+static void do_solid_color(const SeqRenderData *UNUSED(context), Sequence *seq, float UNUSED(cfra), float facf0,
+                           float facf1, ImBuf *UNUSED(ibuf1), ImBuf *UNUSED(ibuf2), ImBuf *UNUSED(ibuf3),
+                           int start_line, int total_lines, ImBuf *out)
 {
-	ImBuf *out = prepare_effect_imbufs(context, ibuf1, ibuf2, ibuf3);
-
 	SolidColorVars *cv = (SolidColorVars *)seq->effectdata;
 
-	unsigned char *rect;
-	float *rect_float;
-	int x; /*= context->rectx;*/ /*UNUSED*/
-	int y; /*= context->recty;*/ /*UNUSED*/
+	int x, y;
 
+	/* even lines use the first field factor, odd lines the second one */
 	if (out->rect) {
-		unsigned char col0[3];
-		unsigned char col1[3];
+		unsigned char col[2][4];
+		unsigned char *rect;
 
-		col0[0] = facf0 * cv->col[0] * 255;
-		col0[1] = facf0 * cv->col[1] * 255;
-		col0[2] = facf0 * cv->col[2] * 255;
+		col[0][0] = facf0 * cv->col[0] * 255;
+		col[0][1] = facf0 * cv->col[1] * 255;
+		col[0][2] = facf0 * cv->col[2] * 255;
+		col[0][3] = 255;
 
-		col1[0] = facf1 * cv->col[0] * 255;
-		col1[1] = facf1 * cv->col[1] * 255;
-		col1[2] = facf1 * cv->col[2] * 255;
+		col[1][0] = facf1 * cv->col[0] * 255;
+		col[1][1] = facf1 * cv->col[1] * 255;
+		col[1][2] = facf1 * cv->col[2] * 255;
+		col[1][3] = 255;
+
+		rect = (unsigned char *)out->rect + 4 * (size_t)start_line * out->x;
+
+		for (y = start_line; y < start_line + total_lines; y++) {
+			const unsigned char *c = col[y & 1];
 
-		rect = (unsigned char *)out->rect;
-		
-		for (y = 0; y < out->y; y++) {
 			for (x = 0; x < out->x; x++, rect += 4) {
-				rect[0] = col0[0];
-				rect[1] = col0[1];
-				rect[2] = col0[2];
-				rect[3] = 255;
-			}
-			y++;
-			if (y < out->y) {
-				for (x = 0; x < out->x; x++, rect += 4) {
-					rect[0] = col1[0];
-					rect[1] = col1[1];
-					rect[2] = col1[2];
-					rect[3] = 255;
-				}
+				copy_v4_v4_uchar(rect, c);
 			}
 		}
-
 	}
 	else if (out->rect_float) {
-		float col0[3];
-		float col1[3];
+		float col[2][4];
+		float *rect_float;
 
-		col0[0] = facf0 * cv->col[0];
-		col0[1] = facf0 * cv->col[1];
-		col0[2] = facf0 * cv->col[2];
+		col[0][0] = facf0 * cv->col[0];
+		col[0][1] = facf0 * cv->col[1];
+		col[0][2] = facf0 * cv->col[2];
+		col[0][3] = 1.0f;
 
-		col1[0] = facf1 * cv->col[0];
-		col1[1] = facf1 * cv->col[1];
-		col1[2] = facf1 * cv->col[2];
+		col[1][0] = facf1 * cv->col[0];
+		col[1][1] = facf1 * cv->col[1];
+		col[1][2] = facf1 * cv->col[2];
+		col[1][3] = 1.0f;
+
+		rect_float = out->rect_float + 4 * (size_t)start_line * out->x;
+
+		for (y = start_line; y < start_line + total_lines; y++) {
+			const float *c = col[y & 1];
 
-		rect_float = out->rect_float;
-		
-		for (y = 0; y < out->y; y++) {
 			for (x = 0; x < out->x; x++, rect_float += 4) {
-				rect_float[0] = col0[0];
-				rect_float[1] = col0[1];
-				rect_float[2] = col0[2];
-				rect_float[3] = 1.0;
-			}
-			y++;
-			if (y < out->y) {
-				for (x = 0; x < out->x; x++, rect_float += 4) {
-					rect_float[0] = col1[0];
-					rect_float[1] = col1[1];
-					rect_float[2] = col1[2];
-					rect_float[3] = 1.0;
-				}
+				copy_v4_v4(rect_float, c);
 			}
 		}
 	}
-	return out;
 }
 
 /*********************** Mulitcam *************************/
@@ -3352,13 +3413,14 @@ static struct SeqEffectHandle get_sequence_effect_impl(int seq_type)
 			rval.execute_slice = do_alphaunder_effect;
 			break;
 		case SEQ_TYPE_WIPE:
+			rval.multithreaded = true;
 			rval.init = init_wipe_effect;
 			rval.num_inputs = num_inputs_wipe;
 			rval.free = free_wipe_effect;
 			rval.copy = copy_wipe_effect;
 			rval.early_out = early_out_fade;
 			rval.get_default_fac = get_default_fac_fade;
-			rval.execute = do_wipe_effect;
+			rval.execute_slice = do_wipe_effect;
 			break;
 		case SEQ_TYPE_GLOW:
 			rval.init = init_glow_effect;
@@ -3368,11 +3430,12 @@ static struct SeqEffectHandle get_sequence_effect_impl(int seq_type)
 			rval.execute = do_glow_effect;
 			break;
 		case SEQ_TYPE_TRANSFORM:
+			rval.multithreaded = true;
 			rval.init = init_transform_effect;
 			rval.num_inputs = num_inputs_transform;
 			rval.free = free_transform_effect;
 			rval.copy = copy_transform_effect;
-			rval.execute = do_transform_effect;
+			rval.execute_slice = do_transform_effect;
 			break;
 		case SEQ_TYPE_SPEED:
 			rval.init = init_speed_effect;
@@ -3385,12 +3448,13 @@ static struct SeqEffectHandle get_sequence_effect_impl(int seq_type)
 			rval.store_icu_yrange = store_icu_yrange_speed;
 			break;
 		case SEQ_TYPE_COLOR:
+			rval.multithreaded = true;
 			rval.init = init_solid_color;
 			rval.num_inputs = num_inputs_color;
 			rval.early_out = early_out_color;
 			rval.free = free_solid_color;
 			rval.copy = copy_solid_color;
-			rval.execute = do_solid_color;
+			rval.execute_slice = do_solid_color;
 			break;
 		case SEQ_TYPE_MULTICAM:
 			rval.num_inputs = num_inputs_multicam;
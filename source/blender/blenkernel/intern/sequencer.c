@@ -35,6 +35,7 @@
 #include <math.h>
 
 #include "MEM_guardedalloc.h"
+#include "MEM_CacheLimiterC-Api.h"
 
 #include "DNA_sequence_types.h"
 #include "DNA_movieclip_types.h"
@@ -51,6 +52,7 @@
 #include "BLI_path_util.h"
 #include "BLI_string.h"
 #include "BLI_string_utf8.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
@@ -84,6 +86,7 @@
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
 #include "IMB_colormanagement.h"
+#include "IMB_moviecache.h"
 
 #include "BKE_context.h"
 #include "BKE_sound.h"
@@ -104,9 +107,11 @@ static ImBuf *seq_render_strip(
         const SeqRenderData *context, SeqRenderState *state,
         Sequence *seq, float cfra);
 static void seq_free_animdata(Scene *scene, Sequence *seq);
+static void seq_free_anims(Sequence *seq);
 static ImBuf *seq_render_mask(const SeqRenderData *context, Mask *mask, float nr, bool make_float);
 static int seq_num_files(Scene *scene, char views_format, const bool is_multiview);
 static void seq_anim_add_suffix(Scene *scene, struct anim *anim, const int view_id);
+static ListBase *seq_render_seqbase_get(Editing *ed, int chanshown);
 
 /* **** XXX ******** */
 #define SELECT 1
@@ -201,10 +206,14 @@ static void seq_free_strip(Strip *strip)
 /* only give option to skip cache locally (static func) */
 static void BKE_sequence_free_ex(Scene *scene, Sequence *seq, const bool do_cache)
 {
+	/* strips of the clipboard and of the proxy job are never prefetched */
+	if (scene)
+		BKE_sequencer_prefetch_stop();
+
 	if (seq->strip)
 		seq_free_strip(seq->strip);
 
-	BKE_sequence_free_anim(seq);
+	seq_free_anims(seq);
 
 	if (seq->type & SEQ_TYPE_EFFECT) {
 		struct SeqEffectHandle sh = BKE_sequence_get_effect(seq);
@@ -264,8 +273,7 @@ void BKE_sequence_free(Scene *scene, Sequence *seq)
 	BKE_sequence_free_ex(scene, seq, true);
 }
 
-/* Function to free imbuf and anim data on changes */
-void BKE_sequence_free_anim(Sequence *seq)
+static void seq_free_anims(Sequence *seq)
 {
 	while (seq->anims.last) {
 		StripAnim *sanim = seq->anims.last;
@@ -280,6 +288,18 @@ void BKE_sequence_free_anim(Sequence *seq)
 	BLI_listbase_clear(&seq->anims);
 }
 
+/* Function to free imbuf and anim data on changes */
+void BKE_sequence_free_anim(Sequence *seq)
+{
+	if (seq->anims.first == NULL)
+		return;
+
+	/* the prefetch job might be decoding the animation */
+	BKE_sequencer_prefetch_stop();
+
+	seq_free_anims(seq);
+}
+
 /* cache must be freed before calling this function
  * since it leaves the seqbase in an invalid state */
 static void seq_free_sequence_recurse(Scene *scene, Sequence *seq)
@@ -837,6 +857,8 @@ void BKE_sequence_reload_new_file(Scene *scene, Sequence *seq, const bool lock_r
 		return;
 	}
 
+	BKE_sequencer_prefetch_stop();
+
 	if (lock_range) {
 		/* keep so we don't have to move the actual start and end points (only the data) */
 		BKE_sequence_calc_disp(scene, seq);
@@ -997,6 +1019,9 @@ void BKE_sequencer_sort(Scene *scene)
 	if (ed == NULL)
 		return;
 
+	/* the prefetch job iterates over the strips */
+	BKE_sequencer_prefetch_stop();
+
 	BLI_listbase_clear(&seqbase);
 	BLI_listbase_clear(&effbase);
 
@@ -1217,41 +1242,50 @@ static void make_black_ibuf(ImBuf *ibuf)
 	}
 }
 
-static void multibuf(ImBuf *ibuf, const float fmul)
-{
-	char *rt;
-	float *rt_float;
+typedef struct MultibufData {
+	ImBuf *ibuf;
+	float fmul;
+	int imul;
+} MultibufData;
 
+static void multibuf_line_cb(void *userdata, const int y)
+{
+	MultibufData *data = userdata;
+	ImBuf *ibuf = data->ibuf;
+	const size_t offset = 4 * (size_t)y * ibuf->x;
+	const int len = 4 * ibuf->x;
 	int a;
 
-	rt = (char *)ibuf->rect;
-	rt_float = ibuf->rect_float;
+	/* all channels are scaled the same way, plain loops which the compiler vectorizes */
+	if (ibuf->rect) {
+		unsigned char *rt = (unsigned char *)ibuf->rect + offset;
+		const int imul = data->imul;
 
-	if (rt) {
-		const int imul = (int)(256.0f * fmul);
-		a = ibuf->x * ibuf->y;
-		while (a--) {
-			rt[0] = min_ii((imul * rt[0]) >> 8, 255);
-			rt[1] = min_ii((imul * rt[1]) >> 8, 255);
-			rt[2] = min_ii((imul * rt[2]) >> 8, 255);
-			rt[3] = min_ii((imul * rt[3]) >> 8, 255);
-
-			rt += 4;
+		for (a = 0; a < len; a++) {
+			rt[a] = min_ii((imul * rt[a]) >> 8, 255);
 		}
 	}
-	if (rt_float) {
-		a = ibuf->x * ibuf->y;
-		while (a--) {
-			rt_float[0] *= fmul;
-			rt_float[1] *= fmul;
-			rt_float[2] *= fmul;
-			rt_float[3] *= fmul;
-			
-			rt_float += 4;
+	if (ibuf->rect_float) {
+		float *rt_float = ibuf->rect_float + offset;
+		const float fmul = data->fmul;
+
+		for (a = 0; a < len; a++) {
+			rt_float[a] *= fmul;
 		}
 	}
 }
 
+static void multibuf(ImBuf *ibuf, const float fmul)
+{
+	MultibufData data;
+
+	data.ibuf = ibuf;
+	data.fmul = fmul;
+	data.imul = (int)(256.0f * fmul);
+
+	BLI_task_parallel_range(0, ibuf->y, &data, multibuf_line_cb, ibuf->y > 64);
+}
+
 static float give_stripelem_index(Sequence *seq, float cfra)
 {
 	float nr;
@@ -1507,8 +1541,9 @@ static void seq_open_anim_file(Scene *scene, Sequence *seq, bool openfile)
 		return;
 	}
 
-	/* reset all the previously created anims */
-	BKE_sequence_free_anim(seq);
+	/* reset all the previously created anims,
+	 * this happens while rendering so the render lock is held already */
+	seq_free_anims(seq);
 
 	BLI_join_dirfile(name, sizeof(name),
 	                 seq->strip->dir, seq->strip->stripdata->name);
@@ -1800,7 +1835,8 @@ static void seq_proxy_build_frame(
 		ibuf = IMB_dupImBuf(ibuf_tmp);
 		IMB_metadata_copy(ibuf, ibuf_tmp);
 		IMB_freeImBuf(ibuf_tmp);
-		IMB_scalefastImBuf(ibuf, (short)rectx, (short)recty);
+		/* proxies are built once and shown for every frame, filter instead of picking pixels */
+		IMB_scaleImBuf_filter(ibuf, (short)rectx, (short)recty, IMB_SCALE_FILTER_BICUBIC);
 	}
 	else {
 		ibuf = ibuf_tmp;
@@ -2727,7 +2763,10 @@ static ImBuf *seq_render_effect_strip_impl(
 
 	switch (early_out) {
 		case EARLY_NO_INPUT:
-			out = sh.execute(context, seq, cfra, fac, facf, NULL, NULL, NULL);
+			if (sh.multithreaded)
+				out = seq_render_effect_execute_threaded(&sh, context, seq, cfra, fac, facf, NULL, NULL, NULL);
+			else
+				out = sh.execute(context, seq, cfra, fac, facf, NULL, NULL, NULL);
 			break;
 		case EARLY_DO_EFFECT:
 			for (i = 0; i < 3; i++) {
@@ -2895,6 +2934,9 @@ monoview_image:
 	return ibuf;
 }
 
+/* frames of movies decoded ahead in the background while playing */
+#define SEQ_ANIM_PREFETCH_FRAMES 8
+
 static ImBuf *seq_render_movie_strip(const SeqRenderData *context, Sequence *seq, float nr, float cfra)
 {
 	ImBuf *ibuf = NULL;
@@ -2921,6 +2963,7 @@ static ImBuf *seq_render_movie_strip(const SeqRenderData *context, Sequence *seq
 			if (sanim->anim) {
 				IMB_Proxy_Size proxy_size = seq_rendersize_to_proxysize(context->preview_render_size);
 				IMB_anim_set_preseek(sanim->anim, seq->anim_preseek);
+				IMB_anim_set_prefetch(sanim->anim, SEQ_ANIM_PREFETCH_FRAMES);
 
 				ibuf_arr[i] = IMB_anim_absolute(sanim->anim, nr + seq->anim_startofs,
 				                                seq->strip->proxy ? seq->strip->proxy->tc : IMB_TC_RECORD_RUN,
@@ -2987,6 +3030,7 @@ monoview_movie:
 		if (sanim && sanim->anim) {
 			IMB_Proxy_Size proxy_size = seq_rendersize_to_proxysize(context->preview_render_size);
 			IMB_anim_set_preseek(sanim->anim, seq->anim_preseek);
+			IMB_anim_set_prefetch(sanim->anim, SEQ_ANIM_PREFETCH_FRAMES);
 
 			ibuf = IMB_anim_absolute(sanim->anim, nr + seq->anim_startofs,
 			                         seq->strip->proxy ? seq->strip->proxy->tc : IMB_TC_RECORD_RUN,
@@ -3819,14 +3863,7 @@ ImBuf *BKE_sequencer_give_ibuf(const SeqRenderData *context, float cfra, int cha
 	
 	if (ed == NULL) return NULL;
 
-	if ((chanshown < 0) && !BLI_listbase_is_empty(&ed->metastack)) {
-		int count = BLI_listbase_count(&ed->metastack);
-		count = max_ii(count + chanshown, 0);
-		seqbasep = ((MetaStack *)BLI_findlink(&ed->metastack, count))->oldbasep;
-	}
-	else {
-		seqbasep = ed->seqbasep;
-	}
+	seqbasep = seq_render_seqbase_get(ed, chanshown);
 
 	SeqRenderState state;
 	sequencer_state_init(&state);
@@ -3851,156 +3888,266 @@ ImBuf *BKE_sequencer_give_ibuf_direct(const SeqRenderData *context, float cfra,
 	return seq_render_strip(context, &state, seq, cfra);
 }
 
-/* *********************** threading api ******************* */
-
-static ListBase running_threads;
-static ListBase prefetch_wait;
-static ListBase prefetch_done;
+/* *********************** prefetch api ******************* */
 
-static pthread_mutex_t queue_lock          = PTHREAD_MUTEX_INITIALIZER;
-static pthread_mutex_t wakeup_lock         = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t wakeup_cond          = PTHREAD_COND_INITIALIZER;
+/* Frames after the current frame are rendered into the cache by a job during playback.
+ * Rendering is not safe to do from multiple threads at once, so the job and rendering
+ * for display take the render lock. Changes of the sequencer data stop the job. */
 
-//static pthread_mutex_t prefetch_ready_lock = PTHREAD_MUTEX_INITIALIZER;
-//static pthread_cond_t  prefetch_ready_cond = PTHREAD_COND_INITIALIZER;
+static ThreadMutex seq_render_lock = BLI_MUTEX_INITIALIZER;
+static pthread_t seq_render_lock_owner;
+static bool seq_render_lock_held = false;
 
-static pthread_mutex_t frame_done_lock     = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t frame_done_cond      = PTHREAD_COND_INITIALIZER;
+/* increased every time the job is stopped */
+static int seq_prefetch_generation = 0;
 
-static volatile bool seq_thread_shutdown = true; 
-static volatile int seq_last_given_monoton_cfra = 0;
-static int monoton_cfra = 0;
+static void seq_render_lock_acquire(void)
+{
+	BLI_mutex_lock(&seq_render_lock);
+	seq_render_lock_owner = pthread_self();
+	seq_render_lock_held = true;
+}
 
-typedef struct PrefetchThread {
-	struct PrefetchThread *next, *prev;
-	
-	Scene *scene;
-	struct PrefetchQueueElem *current;
-	pthread_t pthread;
-	int running;
-	
-} PrefetchThread;
+static void seq_render_lock_release(void)
+{
+	seq_render_lock_held = false;
+	BLI_mutex_unlock(&seq_render_lock);
+}
 
-typedef struct PrefetchQueueElem {
-	struct PrefetchQueueElem *next, *prev;
-	
-	int rectx;
-	int recty;
-	float cfra;
-	int chanshown;
-	int preview_render_size;
+void BKE_sequencer_prefetch_stop(void)
+{
+	/* rendering a scene strip for display may free caches itself */
+	if (seq_render_lock_held && pthread_equal(seq_render_lock_owner, pthread_self())) {
+		seq_prefetch_generation++;
+		return;
+	}
 
-	int monoton_cfra;
+	/* wait for the frame which is being rendered by the job */
+	seq_render_lock_acquire();
+	seq_prefetch_generation++;
+	seq_render_lock_release();
+}
 
+ImBuf *BKE_sequencer_give_ibuf_threaded(const SeqRenderData *context, float cfra, int chanshown)
+{
 	ImBuf *ibuf;
-} PrefetchQueueElem;
 
-void BKE_sequencer_give_ibuf_prefetch_request(const SeqRenderData *context, float cfra, int chanshown)
+	seq_render_lock_acquire();
+	ibuf = BKE_sequencer_give_ibuf(context, cfra, chanshown);
+	seq_render_lock_release();
+
+	return ibuf;
+}
+
+static int seq_prefetch_check_strip(Sequence *seq, void *UNUSED(arg))
 {
-	PrefetchQueueElem *e;
-	if (seq_thread_shutdown) {
-		return;
+	SequenceModifierData *smd;
+
+	/* scene strips change the scene and use OpenGL, text strips use the font library
+	 * and masks are copied for rasterizing while the mask editor may change them,
+	 * none of them can be rendered from a thread */
+	if (ELEM(seq->type, SEQ_TYPE_SCENE, SEQ_TYPE_TEXT, SEQ_TYPE_MASK))
+		return -1;
+
+	/* modifiers rasterize their mask the same way as mask strips */
+	for (smd = seq->modifiers.first; smd; smd = smd->next) {
+		if (smd->mask_input_type == SEQUENCE_MASK_INPUT_ID && smd->mask_id)
+			return -1;
 	}
 
-	e = MEM_callocN(sizeof(PrefetchQueueElem), "prefetch_queue_elem");
-	e->rectx = context->rectx;
-	e->recty = context->recty;
-	e->cfra = cfra;
-	e->chanshown = chanshown;
-	e->preview_render_size = context->preview_render_size;
-	e->monoton_cfra = monoton_cfra++;
+	return 1;
+}
 
-	pthread_mutex_lock(&queue_lock);
-	BLI_addtail(&prefetch_wait, e);
-	pthread_mutex_unlock(&queue_lock);
-	
-	pthread_mutex_lock(&wakeup_lock);
-	pthread_cond_signal(&wakeup_cond);
-	pthread_mutex_unlock(&wakeup_lock);
+static bool seq_prefetch_check_fcurves(ListBase *fcurves)
+{
+	FCurve *fcu;
+
+	for (fcu = fcurves->first; fcu; fcu = fcu->next) {
+		/* the effect fader is the only property evaluated for the rendered frame,
+		 * others have the value of the current frame */
+		if (fcu->rna_path && strstr(fcu->rna_path, "sequence_editor.sequences_all[") &&
+		    !strstr(fcu->rna_path, "effect_fader"))
+		{
+			return false;
+		}
+	}
+
+	return true;
 }
 
-ImBuf *BKE_sequencer_give_ibuf_threaded(const SeqRenderData *context, float cfra, int chanshown)
+static bool seq_prefetch_is_supported(Scene *scene, Editing *ed)
 {
-	PrefetchQueueElem *e = NULL;
-	bool found_something = false;
+	AnimData *adt = scene->adt;
+
+	if (BKE_sequencer_base_recursive_apply(&ed->seqbase, seq_prefetch_check_strip, NULL) == -1)
+		return false;
+
+	if (adt) {
+		if (adt->action && !seq_prefetch_check_fcurves(&adt->action->curves))
+			return false;
 
-	if (seq_thread_shutdown) {
-		return BKE_sequencer_give_ibuf(context, cfra, chanshown);
+		if (!seq_prefetch_check_fcurves(&adt->drivers))
+			return false;
 	}
 
-	while (!e) {
-		bool success = false;
-		pthread_mutex_lock(&queue_lock);
+	return true;
+}
 
-		for (e = prefetch_done.first; e; e = e->next) {
-			if (cfra == e->cfra &&
-			    chanshown == e->chanshown &&
-			    context->rectx == e->rectx &&
-			    context->recty == e->recty &&
-			    context->preview_render_size == e->preview_render_size)
-			{
-				success = true;
-				found_something = true;
-				break;
-			}
-		}
+static ListBase *seq_render_seqbase_get(Editing *ed, int chanshown)
+{
+	if ((chanshown < 0) && !BLI_listbase_is_empty(&ed->metastack)) {
+		int count = BLI_listbase_count(&ed->metastack);
+		count = max_ii(count + chanshown, 0);
+		return ((MetaStack *)BLI_findlink(&ed->metastack, count))->oldbasep;
+	}
 
-		if (!e) {
-			for (e = prefetch_wait.first; e; e = e->next) {
-				if (cfra == e->cfra &&
-				    chanshown == e->chanshown &&
-				    context->rectx == e->rectx &&
-				    context->recty == e->recty &&
-				    context->preview_render_size == e->preview_render_size)
-				{
-					found_something = true;
-					break;
-				}
-			}
-		}
+	return ed->seqbasep;
+}
+
+/* the final image of a frame is cached for the top strip of the stack */
+static bool seq_frame_is_cached(const SeqRenderData *context, ListBase *seqbasep, int cfra, int chanshown,
+                                bool *r_is_empty)
+{
+	Sequence *seq_arr[MAXSEQ + 1];
+	int count;
 
-		if (!e) {
-			PrefetchThread *tslot;
+	count = get_shown_sequences(seqbasep, cfra, chanshown, (Sequence **)&seq_arr);
 
-			for (tslot = running_threads.first;
-			     tslot;
-			     tslot = tslot->next)
-			{
-				if (tslot->current &&
-				    cfra == tslot->current->cfra &&
-				    chanshown == tslot->current->chanshown &&
-				    context->rectx == tslot->current->rectx &&
-				    context->recty == tslot->current->recty &&
-				    context->preview_render_size == tslot->current->preview_render_size)
-				{
-					found_something = true;
-					break;
-				}
-			}
+	if (r_is_empty) {
+		*r_is_empty = (count == 0);
+	}
+
+	if (count == 0) {
+		return false;
+	}
+
+	return BKE_sequencer_cache_has(context, seq_arr[count - 1], cfra, SEQ_STRIPELEM_IBUF_COMP);
+}
+
+bool BKE_sequencer_is_cached(const SeqRenderData *context, int cfra, int chanshown)
+{
+	Editing *ed = BKE_sequencer_editing_get(context->scene, false);
+
+	if (ed == NULL) {
+		return false;
+	}
+
+	return seq_frame_is_cached(context, seq_render_seqbase_get(ed, chanshown), cfra, chanshown, NULL);
+}
+
+/* find the next frame to render after from_frame, frames the playhead has passed are skipped */
+static bool seq_prefetch_next_frame(const SeqRenderData *context, Editing *ed, int from_frame, int num_frames,
+                                    int chanshown, int *r_frame)
+{
+	Scene *scene = context->scene;
+	ListBase *seqbasep = seq_render_seqbase_get(ed, chanshown);
+	const int end_frame = min_ii(CFRA + num_frames, PEFRA);
+	int frame;
+
+	for (frame = max_ii(from_frame, CFRA) + 1; frame <= end_frame; frame++) {
+		bool is_empty;
+
+		if (!seq_frame_is_cached(context, seqbasep, frame, chanshown, &is_empty) && !is_empty) {
+			*r_frame = frame;
+			return true;
 		}
+	}
+
+	return false;
+}
 
-		/* e->ibuf is unrefed by render thread on next round. */
+static bool seq_prefetch_has_space(Scene *scene, size_t frame_size)
+{
+	const size_t mem_limit = MEM_CacheLimiter_get_maximum();
+
+	/* without a limit the cache is never freed */
+	if (MEM_CacheLimiter_is_disabled() || mem_limit == 0) {
+		return false;
+	}
+
+	if (IMB_moviecache_get_memory_in_use() + frame_size <= mem_limit) {
+		return true;
+	}
+
+	/* rather than the least recently used frames, which would be the frames rendered
+	 * ahead, free the frames the playhead has passed already */
+	BKE_sequencer_cache_cleanup_before_frame(scene, CFRA);
+
+	return IMB_moviecache_get_memory_in_use() + frame_size <= mem_limit;
+}
+
+bool BKE_sequencer_prefetch_needed(const SeqRenderData *context, int num_frames, int chanshown)
+{
+	Scene *scene = context->scene;
+	Editing *ed = BKE_sequencer_editing_get(scene, false);
+	int frame;
+	bool needed;
+
+	if (ed == NULL || num_frames <= 0 || context->skip_cache) {
+		return false;
+	}
 
-		if (e) {
-			seq_last_given_monoton_cfra = e->monoton_cfra;
+	seq_render_lock_acquire();
+	needed = seq_prefetch_is_supported(scene, ed) &&
+	         seq_prefetch_next_frame(context, ed, CFRA, num_frames, chanshown, &frame) &&
+	         seq_prefetch_has_space(scene, (size_t)context->rectx * context->recty * 4);
+	seq_render_lock_release();
+
+	return needed;
+}
+
+/* render up to num_frames frames after the current frame into the cache,
+ * stops when the memory cache limit is reached or BKE_sequencer_prefetch_stop() is called */
+void BKE_sequencer_prefetch(const SeqRenderData *context, int num_frames, int chanshown,
+                            short *stop, short *do_update, float *progress)
+{
+	Scene *scene = context->scene;
+	size_t frame_size = (size_t)context->rectx * context->recty * 4;
+	int generation, frame, tot_frames = 0;
+
+	seq_render_lock_acquire();
+	generation = seq_prefetch_generation;
+	frame = CFRA;
+	seq_render_lock_release();
+
+	while (!*stop) {
+		Editing *ed;
+		ImBuf *ibuf;
+		size_t mem_in_use;
+
+		seq_render_lock_acquire();
+
+		/* the data might have been freed since the job was stopped, check before using it */
+		if (generation != seq_prefetch_generation ||
+		    (ed = BKE_sequencer_editing_get(scene, false)) == NULL ||
+		    !seq_prefetch_is_supported(scene, ed) ||
+		    !seq_prefetch_next_frame(context, ed, frame, num_frames, chanshown, &frame) ||
+		    !seq_prefetch_has_space(scene, frame_size))
+		{
+			seq_render_lock_release();
+			break;
 		}
 
-		pthread_mutex_unlock(&queue_lock);
+		mem_in_use = IMB_moviecache_get_memory_in_use();
 
-		if (!success) {
-			e = NULL;
+		ibuf = BKE_sequencer_give_ibuf(context, frame, chanshown);
 
-			if (!found_something) {
-				fprintf(stderr, "SEQ-THREAD: Requested frame not in queue ???\n");
-				break;
-			}
-			pthread_mutex_lock(&frame_done_lock);
-			pthread_cond_wait(&frame_done_cond, &frame_done_lock);
-			pthread_mutex_unlock(&frame_done_lock);
+		/* a frame uses more than its final image, the images of the strips are cached too */
+		if (IMB_moviecache_get_memory_in_use() > mem_in_use) {
+			frame_size = MAX2(frame_size, IMB_moviecache_get_memory_in_use() - mem_in_use);
 		}
+
+		seq_render_lock_release();
+
+		if (ibuf) {
+			IMB_freeImBuf(ibuf);
+		}
+
+		tot_frames++;
+
+		*progress = min_ff((float)tot_frames / num_frames, 1.0f);
+		*do_update = true;
 	}
-	
-	return e ? e->ibuf : NULL;
 }
 
 /* check whether sequence cur depends on seq */
@@ -4052,6 +4199,9 @@ static void sequence_invalidate_cache(Scene *scene, Sequence *seq, bool invalida
 {
 	Editing *ed = scene->ed;
 
+	/* the prefetch job might be using the animation of the strip */
+	BKE_sequencer_prefetch_stop();
+
 	/* invalidate cache for current sequence */
 	if (invalidate_self) {
 		/* Animation structure holds some buffers inside,
@@ -4171,6 +4321,9 @@ void BKE_sequencer_update_changed_seq_and_deps(Scene *scene, Sequence *changed_s
 	Sequence *seq;
 	
 	if (ed == NULL) return;
+
+	/* anims and effect data of the changed strips are freed */
+	BKE_sequencer_prefetch_stop();
 	
 	for (seq = ed->seqbase.first; seq; seq = seq->next)
 		update_changed_seq_recurs(scene, seq, changed_seq, len_change, ibuf_change);
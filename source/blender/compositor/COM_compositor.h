@@ -69,6 +69,14 @@ extern "C" {
  * Ranging from low-end machines to very high-end machines.
  * The system should work on high-end machines and on low-end machines.
  *
+ * @section buffercache Buffer cache
+ * When editing, the buffers between ExecutionGroup's are kept in the BufferCache after execution.
+ * They are identified by a hash of all operations and node settings they are calculated from,
+ * so that the next execution only calculates the buffers that depend on changed nodes.
+ * The memory of the cache is limited by the cache limit of the user preferences.
+ * @see NodeOperationBuilder.add_buffer_cache_keys
+ * @see MemoryProxy.addToCache
+ *
  *
  * @page executing Executing
  * @section prepare Prepare execution
@@ -140,12 +148,15 @@ extern "C" {
  * </pre>
  *
  * In the above example ExecutionGroup B has an outputoperation (ViewerOperation) and is being executed.
- * The first chunk is evaluated [@ref ExecutionGroup.scheduleChunkWhenPossible],
+ * The first chunk is evaluated [@ref ExecutionGroup.scheduleChunkDependencies],
  * but not all input chunks are available. The relevant ExecutionGroup (that can calculate the missing chunks;
- * ExecutionGroup A) is asked to calculate the area ExecutionGroup B is missing.
- * [@ref ExecutionGroup.scheduleAreaWhenPossible]
- * ExecutionGroup B checks what chunks the area spans, and tries to schedule these chunks.
- * If all input data is available these chunks are scheduled [@ref ExecutionGroup.scheduleChunk]
+ * ExecutionGroup A) is asked to schedule the area ExecutionGroup B is missing.
+ * [@ref ExecutionGroup.scheduleAreaDependencies]
+ * ExecutionGroup A checks what chunks the area spans, schedules these chunks and makes the chunk of
+ * ExecutionGroup B dependent on them. Chunks without missing input data are added to the WorkScheduler
+ * right away [@ref ExecutionGroup.scheduleChunk], the others as soon as their last input chunk is executed
+ * [@ref ExecutionGroup.finalizeChunkExecution]. The chunks of all output ExecutionGroups with the same
+ * priority are scheduled together.
  *
  * <pre>
  *
@@ -154,17 +165,17 @@ extern "C" {
  * +-------------------------+        | (B)            |                           | (A)            |
  *            O                       +----------------+                           +----------------+
  *            O                                |                                            |
- *            O       ExecutionGroup.execute   |                                            |
+ *            O       ExecutionGroup.schedule  |                                            |
  *            O------------------------------->O                                            |
  *            .                                O                                            |
  *            .                                O-------\                                    |
- *            .                                .       | ExecutionGroup.scheduleChunkWhenPossible
+ *            .                                .       | ExecutionGroup.scheduleChunkDependencies
  *            .                                .  O----/ (*)                                |
  *            .                                .  O                                         |
  *            .                                .  O                                         |
- *            .                                .  O  ExecutionGroup.scheduleAreaWhenPossible|
+ *            .                                .  O  ExecutionGroup.scheduleAreaDependencies|
  *            .                                .  O---------------------------------------->O
- *            .                                .  .                                         O----------\ ExecutionGroup.scheduleChunkWhenPossible
+ *            .                                .  .                                         O----------\ ExecutionGroup.scheduleChunkDependencies
  *            .                                .  .                                         .          | (*)
  *            .                                .  .                                         .  O-------/
  *            .                                .  .                                         .  O
@@ -183,6 +194,7 @@ extern "C" {
  * </pre>
  *
  * This happens until all chunks of (ExecutionGroup B) are finished executing or the user break's the process.
+ * Executed chunks are not scheduled again.
  *
  * NodeOperation like the ScaleOperation can influence the area of interest by reimplementing the
  * [@ref NodeOperation.determineAreaOfInterest] method
@@ -206,12 +218,13 @@ extern "C" {
  *
  * </pre>
  *
- * @see ExecutionGroup.execute Execute a complete ExecutionGroup. Halts until finished or breaked by user
- * @see ExecutionGroup.scheduleChunkWhenPossible Tries to schedule a single chunk,
- * checks if all input data is available. Can trigger dependent chunks to be calculated
- * @see ExecutionGroup.scheduleAreaWhenPossible Tries to schedule an area. This can be multiple chunks
- * (is called from [@ref ExecutionGroup.scheduleChunkWhenPossible])
+ * @see ExecutionGroup.schedule Schedule all chunks of an output ExecutionGroup
+ * @see ExecutionGroup.scheduleChunkDependencies Schedules a single chunk,
+ * and the chunks of other ExecutionGroups it depends on
+ * @see ExecutionGroup.scheduleAreaDependencies Schedules an area. This can be multiple chunks
+ * (is called from [@ref ExecutionGroup.scheduleChunkDependencies])
  * @see ExecutionGroup.scheduleChunk Schedule a chunk on the WorkScheduler
+ * @see ExecutionGroup.finalizeChunkExecution Schedules the chunks that depend on an executed chunk
  * @see NodeOperation.determineDependingAreaOfInterest Influence the area of interest of a chunk.
  * @see WriteBufferOperation Operation to write to a MemoryProxy/MemoryBuffer
  * @see ReadBufferOperation Operation to read from a MemoryProxy/MemoryBuffer
@@ -224,10 +237,10 @@ extern "C" {
  * the work-scheduler can work in 2 states. For witching these between the state you need to recompile blender
  *
  * @subsection multithread Multi threaded
- * Default the work-scheduler will place all work as WorkPackage in a queue.
- * For every CPUcore a working thread is created. These working threads will ask the WorkScheduler if there is work
- * for a specific Device.
- * the work-scheduler will find work for the device and the device will be asked to execute the WorkPackage
+ * Default the work-scheduler will push all work for the CPU as WorkPackage in a task pool of the shared
+ * task scheduler (BLI_task). Every thread of the task scheduler has a CPUDevice, that will be asked
+ * to execute the WorkPackage. Work for OpenCL devices is placed in a queue, for every OpenCL device a
+ * working thread is created that asks the WorkScheduler for work.
  *
  * @subsection singlethread Single threaded
  * For debugging reasons the multi-threading can be disabled. This is done by changing the COM_CURRENT_THREADING_MODEL
@@ -72,7 +72,7 @@ typedef enum CompositorPriority {
 
 // workscheduler threading models
 /**
- * COM_TM_QUEUE is a multithreaded model, which uses the BLI_thread_queue pattern. This is the default option.
+ * COM_TM_QUEUE is a multithreaded model, which uses a BLI_task pool (and a BLI_thread_queue for OpenCL). This is the default option.
  */
 #define COM_TM_QUEUE 1
 
@@ -109,6 +109,12 @@ typedef enum OrderOfChunks {
 #define COM_NUM_CHANNELS_VECTOR 3
 #define COM_NUM_CHANNELS_COLOR 4
 
+/**
+ * @brief maximum number of pixels in a row calculated at once
+ * @see SocketReader.executeRow
+ */
+#define COM_ROW_WIDTH 256
+
 #define COM_BLUR_BOKEH_PIXELS 512
 
 #endif  /* __COM_DEFINES_H__ */
@@ -0,0 +1,217 @@
+/*
+ * Copyright 2016, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <map>
+
+#include "COM_BufferCache.h"
+#include "COM_MemoryBuffer.h"
+
+#include "MEM_CacheLimiterC-Api.h"
+
+extern "C" {
+#include "BLI_threads.h"
+#include "DNA_node_types.h"
+}
+
+struct BufferCacheEntry {
+	uint64_t key;
+	MemoryBuffer *buffer;
+	MEM_CacheLimiterHandleC *handle;
+};
+
+struct NodeGeneration {
+	unsigned int generation;
+	unsigned int lastExecution;
+};
+
+typedef std::map<uint64_t, BufferCacheEntry *> BufferCacheEntries;
+typedef std::map<bNode *, NodeGeneration> NodeGenerations;
+
+/* generations of nodes not executed for this many executions are forgotten */
+#define COM_BUFFER_CACHE_NODE_GENERATION_KEEP 64
+
+static ThreadMutex s_cacheMutex = BLI_MUTEX_INITIALIZER;
+static MEM_CacheLimiterC *s_limiter = NULL;
+static BufferCacheEntries s_entries;
+static NodeGenerations s_nodeGenerations;
+/* generations are unique, a forgotten node gets a new one and never reuses stale buffers */
+static unsigned int s_lastGeneration = 0;
+static unsigned int s_execution = 0;
+
+/* called by the cache limiter, with the cache mutex locked */
+static void buffer_cache_entry_free(void *data)
+{
+	BufferCacheEntry *entry = (BufferCacheEntry *)data;
+
+	s_entries.erase(entry->key);
+	delete entry->buffer;
+	delete entry;
+}
+
+static size_t buffer_cache_entry_size(void *data)
+{
+	BufferCacheEntry *entry = (BufferCacheEntry *)data;
+	MemoryBuffer *buffer = entry->buffer;
+
+	return sizeof(float) * buffer->getWidth() * buffer->getHeight() * buffer->get_num_channels();
+}
+
+bool BufferCache::isEnabled()
+{
+	/* the cache limiter never frees anything without a limit */
+	return !MEM_CacheLimiter_is_disabled() && MEM_CacheLimiter_get_maximum() != 0;
+}
+
+BufferCacheEntry *BufferCache::acquire(uint64_t key, int width, int height)
+{
+	BufferCacheEntry *entry = NULL;
+
+	BLI_mutex_lock(&s_cacheMutex);
+
+	BufferCacheEntries::iterator it = s_entries.find(key);
+	if (it != s_entries.end()) {
+		MemoryBuffer *buffer = it->second->buffer;
+		if (buffer->getWidth() == width && buffer->getHeight() == height) {
+			entry = it->second;
+			MEM_CacheLimiter_ref(entry->handle);
+			MEM_CacheLimiter_touch(entry->handle);
+		}
+	}
+
+	BLI_mutex_unlock(&s_cacheMutex);
+
+	return entry;
+}
+
+BufferCacheEntry *BufferCache::insert(uint64_t key, MemoryBuffer *buffer)
+{
+	BufferCacheEntry *entry = NULL;
+
+	BLI_mutex_lock(&s_cacheMutex);
+
+	if (s_entries.find(key) == s_entries.end()) {
+		if (s_limiter == NULL) {
+			s_limiter = new_MEM_CacheLimiter(buffer_cache_entry_free, buffer_cache_entry_size);
+		}
+
+		entry = new BufferCacheEntry();
+		entry->key = key;
+		entry->buffer = buffer;
+		entry->handle = MEM_CacheLimiter_insert(s_limiter, entry);
+		s_entries[key] = entry;
+
+		MEM_CacheLimiter_ref(entry->handle);
+		MEM_CacheLimiter_enforce_limits(s_limiter);
+	}
+
+	BLI_mutex_unlock(&s_cacheMutex);
+
+	return entry;
+}
+
+void BufferCache::release(BufferCacheEntry *entry)
+{
+	BLI_mutex_lock(&s_cacheMutex);
+
+	MEM_CacheLimiter_unref(entry->handle);
+	/* buffers in use may have exceeded the limit */
+	MEM_CacheLimiter_enforce_limits(s_limiter);
+
+	BLI_mutex_unlock(&s_cacheMutex);
+}
+
+MemoryBuffer *BufferCache::getBuffer(BufferCacheEntry *entry)
+{
+	return entry->buffer;
+}
+
+unsigned int BufferCache::getNodeGeneration(bNode *node)
+{
+	/* nodes of a localized tree refer to the node in the tree that is edited */
+	bNode *original = (node->original) ? node->original : node;
+	unsigned int generation;
+
+	BLI_mutex_lock(&s_cacheMutex);
+
+	NodeGenerations::iterator it = s_nodeGenerations.find(original);
+	if (it == s_nodeGenerations.end()) {
+		it = s_nodeGenerations.insert(std::make_pair(original, NodeGeneration())).first;
+		it->second.generation = ++s_lastGeneration;
+	}
+	else if (node->need_exec) {
+		it->second.generation = ++s_lastGeneration;
+	}
+	it->second.lastExecution = s_execution;
+	generation = it->second.generation;
+
+	BLI_mutex_unlock(&s_cacheMutex);
+
+	return generation;
+}
+
+void BufferCache::beginExecution()
+{
+	BLI_mutex_lock(&s_cacheMutex);
+
+	s_execution++;
+
+	/* nodes are not known to be freed, forget the ones which were not used for a while */
+	NodeGenerations::iterator it = s_nodeGenerations.begin();
+	while (it != s_nodeGenerations.end()) {
+		if (s_execution - it->second.lastExecution > COM_BUFFER_CACHE_NODE_GENERATION_KEEP)
+			s_nodeGenerations.erase(it++);
+		else
+			++it;
+	}
+
+	BLI_mutex_unlock(&s_cacheMutex);
+}
+
+void BufferCache::deinitialize()
+{
+	BLI_mutex_lock(&s_cacheMutex);
+
+	for (BufferCacheEntries::iterator it = s_entries.begin(); it != s_entries.end(); ++it) {
+		BufferCacheEntry *entry = it->second;
+		MEM_CacheLimiter_unmanage(entry->handle);
+		delete entry->buffer;
+		delete entry;
+	}
+	s_entries.clear();
+	s_nodeGenerations.clear();
+
+	if (s_limiter) {
+		delete_MEM_CacheLimiter(s_limiter);
+		s_limiter = NULL;
+	}
+
+	BLI_mutex_unlock(&s_cacheMutex);
+}
+
+uint64_t BufferCache::hash(uint64_t hash, const void *data, size_t size)
+{
+	const unsigned char *bytes = (const unsigned char *)data;
+
+	/* FNV-1a */
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
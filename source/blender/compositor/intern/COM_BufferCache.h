@@ -0,0 +1,106 @@
+/*
+ * Copyright 2016, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _COM_BufferCache_h_
+#define _COM_BufferCache_h_
+
+#include <stddef.h>
+
+extern "C" {
+#include "BLI_sys_types.h"
+}
+
+class MemoryBuffer;
+struct bNode;
+
+/**
+ * @brief handle of a buffer in the BufferCache
+ */
+struct BufferCacheEntry;
+
+/**
+ * @brief cache of intermediate buffers, kept between executions of the compositor.
+ *
+ * Buffers are identified by a key, a hash of the operations and node settings they are
+ * calculated from, so that when editing the node tree only the buffers depending on the
+ * changed nodes are calculated again.
+ * The memory is limited by the cache limit of the user preferences,
+ * the least recently used buffers are freed first.
+ * @ingroup Memory
+ */
+class BufferCache {
+public:
+	/**
+	 * @brief check if buffers can be cached, the cache limit of the user preferences must be set
+	 */
+	static bool isEnabled();
+
+	/**
+	 * @brief find the buffer with the given key and resolution
+	 * the buffer is not freed until the entry is released
+	 * @return the entry of the buffer or NULL when it is not cached
+	 */
+	static BufferCacheEntry *acquire(uint64_t key, int width, int height);
+
+	/**
+	 * @brief add a fully calculated buffer to the cache, the cache takes ownership of the buffer
+	 * the buffer is not freed until the entry is released
+	 * @return the entry of the buffer or NULL when a buffer with the key was cached already
+	 */
+	static BufferCacheEntry *insert(uint64_t key, MemoryBuffer *buffer);
+
+	/**
+	 * @brief release an acquired or inserted entry, the buffer may be freed afterwards
+	 */
+	static void release(BufferCacheEntry *entry);
+
+	/**
+	 * @brief get the buffer of an entry
+	 */
+	static MemoryBuffer *getBuffer(BufferCacheEntry *entry);
+
+	/**
+	 * @brief get the generation of the data of a node
+	 * the generation changes every time the node is tagged for execution (bNode.need_exec)
+	 * which is used to detect changes of the data blocks used by the node.
+	 */
+	static unsigned int getNodeGeneration(bNode *node);
+
+	/**
+	 * @brief called when the compositor starts an execution using the cache,
+	 * forgets generations of nodes which were not executed for a while
+	 */
+	static void beginExecution();
+
+	/**
+	 * @brief free all cached buffers
+	 */
+	static void deinitialize();
+
+	/**
+	 * @brief add data to a hash, use COM_BUFFER_CACHE_HASH_INIT as initial value
+	 */
+	static uint64_t hash(uint64_t hash, const void *data, size_t size);
+};
+
+/* FNV-1a offset basis */
+#define COM_BUFFER_CACHE_HASH_INIT 14695981039346656037ULL
+/* key of buffers which are not cached, see MemoryProxy::setCacheKey */
+#define COM_BUFFER_CACHE_NO_KEY 0
+
+#endif
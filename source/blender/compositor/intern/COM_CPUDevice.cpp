@@ -21,11 +21,62 @@
  */
 
 #include "COM_CPUDevice.h"
+#include "COM_WorkScheduler.h"
+#include "COM_defines.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_utildefines.h"
 
 CPUDevice::CPUDevice(int thread_id)
   : Device(),
-    m_thread_id(thread_id)
+    m_thread_id(thread_id),
+    m_rowsUsed(0)
+{
+}
+
+CPUDevice::~CPUDevice()
+{
+	for (unsigned int i = 0; i < this->m_rows.size(); i++) {
+		MEM_freeN(this->m_rows[i]);
+	}
+}
+
+float *CPUDevice::takeRow()
+{
+	if (this->m_rowsUsed == this->m_rows.size()) {
+		this->m_rows.push_back((float *)MEM_mallocN(sizeof(float) * COM_ROW_WIDTH * COM_NUM_CHANNELS_COLOR,
+		                                            "COM_CPUDevice row"));
+	}
+	return this->m_rows[this->m_rowsUsed++];
+}
+
+void CPUDevice::releaseRow()
+{
+	BLI_assert(this->m_rowsUsed > 0);
+	this->m_rowsUsed--;
+}
+
+RowBuffer::RowBuffer()
+{
+	this->m_device = WorkScheduler::current_device();
+	if (this->m_device) {
+		this->m_row = this->m_device->takeRow();
+	}
+	else {
+		this->m_row = (float *)MEM_mallocN(sizeof(float) * COM_ROW_WIDTH * COM_NUM_CHANNELS_COLOR,
+		                                   "COM_RowBuffer");
+	}
+}
+
+RowBuffer::~RowBuffer()
 {
+	if (this->m_device) {
+		this->m_device->releaseRow();
+	}
+	else {
+		MEM_freeN(this->m_row);
+	}
 }
 
 void CPUDevice::execute(WorkPackage *work)
@@ -36,7 +87,11 @@ void CPUDevice::execute(WorkPackage *work)
 
 	executionGroup->determineChunkRect(&rect, chunkNumber);
 
-	executionGroup->getOutputOperation()->executeRegion(&rect, chunkNumber);
+	/* all chunks are scheduled up front, skip the remaining ones when the user breaks */
+	NodeOperation *operation = executionGroup->getOutputOperation();
+	if (!operation->isBreaked()) {
+		operation->executeRegion(&rect, chunkNumber);
+	}
 
 	executionGroup->finalizeChunkExecution(chunkNumber, NULL);
 }
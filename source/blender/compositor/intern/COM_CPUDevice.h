@@ -23,6 +23,8 @@
 #ifndef _COM_CPUDevice_h
 #define _COM_CPUDevice_h
 
+#include <vector>
+
 #include "COM_Device.h"
 
 /**
@@ -32,6 +34,7 @@
 class CPUDevice : public Device {
 public:
 	CPUDevice(int thread_id);
+	~CPUDevice();
 
 	/**
 	 * @brief execute a WorkPackage
@@ -41,8 +44,37 @@ public:
 
 	int thread_id() { return m_thread_id; }
 
+	/**
+	 * @brief take a scratch row of COM_ROW_WIDTH pixels, rows must be released in reverse order
+	 */
+	float *takeRow();
+	void releaseRow();
+
 protected:
 	int m_thread_id;
+
+	/**
+	 * @brief scratch rows of the thread, as many as the deepest chain of executeRow calls
+	 */
+	std::vector<float *> m_rows;
+	unsigned int m_rowsUsed;
+};
+
+/**
+ * @brief scratch row of COM_ROW_WIDTH pixels for SocketReader::executeRow implementations
+ * @note executeRow calls are nested as deep as the chain of operations, so the rows are taken
+ * from the CPUDevice of the executing thread instead of the stack.
+ */
+class RowBuffer {
+public:
+	RowBuffer();
+	~RowBuffer();
+
+	operator float *() { return m_row; }
+
+private:
+	CPUDevice *m_device;
+	float *m_row;
 };
 
 #endif
@@ -50,6 +50,7 @@ ExecutionGroup::ExecutionGroup()
 	this->m_isOutput = false;
 	this->m_complex = false;
 	this->m_chunkExecutionStates = NULL;
+	this->m_chunkUnfinishedInputs = NULL;
 	this->m_bTree = NULL;
 	this->m_height = 0;
 	this->m_width = 0;
@@ -113,15 +114,22 @@ void ExecutionGroup::initExecution()
 	if (this->m_chunkExecutionStates != NULL) {
 		MEM_freeN(this->m_chunkExecutionStates);
 	}
+	if (this->m_chunkUnfinishedInputs != NULL) {
+		MEM_freeN(this->m_chunkUnfinishedInputs);
+	}
 	unsigned int index;
 	determineNumberOfChunks();
 
 	this->m_chunkExecutionStates = NULL;
+	this->m_chunkUnfinishedInputs = NULL;
+	this->m_chunkDependents.clear();
 	if (this->m_numberOfChunks != 0) {
 		this->m_chunkExecutionStates = (ChunkExecutionState *)MEM_mallocN(sizeof(ChunkExecutionState) * this->m_numberOfChunks, __func__);
 		for (index = 0; index < this->m_numberOfChunks; index++) {
 			this->m_chunkExecutionStates[index] = COM_ES_NOT_SCHEDULED;
 		}
+		this->m_chunkUnfinishedInputs = (unsigned int *)MEM_callocN(sizeof(unsigned int) * this->m_numberOfChunks, __func__);
+		this->m_chunkDependents.resize(this->m_numberOfChunks);
 	}
 
 
@@ -146,6 +154,11 @@ void ExecutionGroup::deinitExecution()
 		MEM_freeN(this->m_chunkExecutionStates);
 		this->m_chunkExecutionStates = NULL;
 	}
+	if (this->m_chunkUnfinishedInputs != NULL) {
+		MEM_freeN(this->m_chunkUnfinishedInputs);
+		this->m_chunkUnfinishedInputs = NULL;
+	}
+	this->m_chunkDependents.clear();
 	this->m_numberOfChunks = 0;
 	this->m_numberOfXChunks = 0;
 	this->m_numberOfYChunks = 0;
@@ -181,7 +194,7 @@ void ExecutionGroup::determineNumberOfChunks()
 /**
  * this method is called for the top execution groups. containing the compositor node or the preview node or the viewer node)
  */
-void ExecutionGroup::execute(ExecutionSystem *graph)
+void ExecutionGroup::schedule(ExecutionSystem *graph, ChunkReferences *readyChunks)
 {
 	const CompositorContext &context = graph->getContext();
 	const bNodeTree *bTree = context.getbNodeTree();
@@ -304,48 +317,9 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
 	DebugInfo::execution_group_started(this);
 	DebugInfo::graphviz(graph);
 
-	bool breaked = false;
-	bool finished = false;
-	unsigned int startIndex = 0;
-	const int maxNumberEvaluated = BLI_system_thread_count() * 2;
-
-	while (!finished && !breaked) {
-		bool startEvaluated = false;
-		finished = true;
-		int numberEvaluated = 0;
-
-		for (index = startIndex; index < this->m_numberOfChunks && numberEvaluated < maxNumberEvaluated; index++) {
-			chunkNumber = chunkOrder[index];
-			int yChunk = chunkNumber / this->m_numberOfXChunks;
-			int xChunk = chunkNumber - (yChunk * this->m_numberOfXChunks);
-			const ChunkExecutionState state = this->m_chunkExecutionStates[chunkNumber];
-			if (state == COM_ES_NOT_SCHEDULED) {
-				scheduleChunkWhenPossible(graph, xChunk, yChunk);
-				finished = false;
-				startEvaluated = true;
-				numberEvaluated++;
-
-				if (bTree->update_draw)
-					bTree->update_draw(bTree->udh);
-			}
-			else if (state == COM_ES_SCHEDULED) {
-				finished = false;
-				startEvaluated = true;
-				numberEvaluated++;
-			}
-			else if (state == COM_ES_EXECUTED && !startEvaluated) {
-				startIndex = index + 1;
-			}
-		}
-
-		WorkScheduler::finish();
-
-		if (bTree->test_break && bTree->test_break(bTree->tbh)) {
-			breaked = true;
-		}
+	for (index = 0; index < this->m_numberOfChunks; index++) {
+		scheduleChunkDependencies(chunkOrder[index], readyChunks);
 	}
-	DebugInfo::execution_group_finished(this);
-	DebugInfo::graphviz(graph);
 
 	MEM_freeN(chunkOrder);
 }
@@ -382,8 +356,30 @@ void ExecutionGroup::finalizeChunkExecution(int chunkNumber, MemoryBuffer **memo
 {
 	if (this->m_chunkExecutionStates[chunkNumber] == COM_ES_SCHEDULED)
 		this->m_chunkExecutionStates[chunkNumber] = COM_ES_EXECUTED;
+
+	/* the buffer can be reused by later executions once all of it is calculated,
+	 * this is done before any of the chunks reading it can free it */
+	if (atomic_add_u(&this->m_chunksFinished, 1) == this->m_numberOfChunks && isBufferCompleted()) {
+		WriteBufferOperation *writeOperation = (WriteBufferOperation *)this->getOutputOperation();
+		writeOperation->getMemoryProxy()->addToCache();
+	}
+
+	/* chunks reading this chunk can be calculated once all their inputs are executed */
+	ChunkReferences &dependents = this->m_chunkDependents[chunkNumber];
+	for (ChunkReferences::iterator it = dependents.begin(); it != dependents.end(); ++it) {
+		ExecutionGroup *group = it->group;
+		if (atomic_sub_u(&group->m_chunkUnfinishedInputs[it->chunkNumber], 1) == 0) {
+			group->scheduleChunk(it->chunkNumber);
+		}
+	}
+	dependents.clear();
+
+	/* intermediate buffers may be freed once all their readers are executed */
+	for (unsigned int index = 0; index < this->m_cachedReadOperations.size(); index++) {
+		ReadBufferOperation *readOperation = (ReadBufferOperation *)this->m_cachedReadOperations[index];
+		readOperation->getMemoryProxy()->removeReader();
+	}
 	
-	atomic_add_u(&this->m_chunksFinished, 1);
 	if (memoryBuffers) {
 		for (unsigned int index = 0; index < this->m_cachedMaxReadBufferOffset; index++) {
 			MemoryBuffer *buffer = memoryBuffers[index];
@@ -407,6 +403,9 @@ void ExecutionGroup::finalizeChunkExecution(int chunkNumber, MemoryBuffer **memo
 		             this->m_chunksFinished,
 		             this->m_numberOfChunks);
 		this->m_bTree->stats_draw(this->m_bTree->sdh, buf);
+
+		if (this->m_bTree->update_draw)
+			this->m_bTree->update_draw(this->m_bTree->udh);
 	}
 }
 
@@ -448,78 +447,82 @@ MemoryBuffer *ExecutionGroup::allocateOutputBuffer(int /*chunkNumber*/,
 }
 
 
-bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area)
+unsigned int ExecutionGroup::scheduleAreaDependencies(rcti *area, const ChunkReference &dependent, ChunkReferences *readyChunks)
 {
-	if (this->m_singleThreaded) {
-		return scheduleChunkWhenPossible(graph, 0, 0);
-	}
 	// find all chunks inside the rect
 	// determine minxchunk, minychunk, maxxchunk, maxychunk where x and y are chunknumbers
 
-	int indexx, indexy;
-	int minx = max_ii(area->xmin - m_viewerBorder.xmin, 0);
-	int maxx = min_ii(area->xmax - m_viewerBorder.xmin, m_viewerBorder.xmax - m_viewerBorder.xmin);
-	int miny = max_ii(area->ymin - m_viewerBorder.ymin, 0);
-	int maxy = min_ii(area->ymax - m_viewerBorder.ymin, m_viewerBorder.ymax - m_viewerBorder.ymin);
-	int minxchunk = minx / (int)m_chunkSize;
-	int maxxchunk = (maxx + (int)m_chunkSize - 1) / (int)m_chunkSize;
-	int minychunk = miny / (int)m_chunkSize;
-	int maxychunk = (maxy + (int)m_chunkSize - 1) / (int)m_chunkSize;
-	minxchunk = max_ii(minxchunk, 0);
-	minychunk = max_ii(minychunk, 0);
-	maxxchunk = min_ii(maxxchunk, (int)m_numberOfXChunks);
-	maxychunk = min_ii(maxychunk, (int)m_numberOfYChunks);
-
-	bool result = true;
-	for (indexx = minxchunk; indexx < maxxchunk; indexx++) {
-		for (indexy = minychunk; indexy < maxychunk; indexy++) {
-			if (!scheduleChunkWhenPossible(graph, indexx, indexy)) {
-				result = false;
+	int minxchunk, maxxchunk, minychunk, maxychunk;
+	if (this->m_singleThreaded) {
+		minxchunk = minychunk = 0;
+		maxxchunk = maxychunk = 1;
+	}
+	else {
+		int minx = max_ii(area->xmin - m_viewerBorder.xmin, 0);
+		int maxx = min_ii(area->xmax - m_viewerBorder.xmin, m_viewerBorder.xmax - m_viewerBorder.xmin);
+		int miny = max_ii(area->ymin - m_viewerBorder.ymin, 0);
+		int maxy = min_ii(area->ymax - m_viewerBorder.ymin, m_viewerBorder.ymax - m_viewerBorder.ymin);
+		minxchunk = max_ii(minx / (int)m_chunkSize, 0);
+		maxxchunk = min_ii((maxx + (int)m_chunkSize - 1) / (int)m_chunkSize, (int)m_numberOfXChunks);
+		minychunk = max_ii(miny / (int)m_chunkSize, 0);
+		maxychunk = min_ii((maxy + (int)m_chunkSize - 1) / (int)m_chunkSize, (int)m_numberOfYChunks);
+	}
+
+	unsigned int numberUnfinished = 0;
+	for (int indexy = minychunk; indexy < maxychunk; indexy++) {
+		for (int indexx = minxchunk; indexx < maxxchunk; indexx++) {
+			unsigned int chunkNumber = indexy * this->m_numberOfXChunks + indexx;
+
+			scheduleChunkDependencies(chunkNumber, readyChunks);
+
+			if (this->m_chunkExecutionStates[chunkNumber] != COM_ES_EXECUTED) {
+				this->m_chunkDependents[chunkNumber].push_back(dependent);
+				numberUnfinished++;
 			}
 		}
 	}
 
-	return result;
+	return numberUnfinished;
 }
 
-bool ExecutionGroup::scheduleChunk(unsigned int chunkNumber)
+bool ExecutionGroup::isBufferCompleted()
 {
-	if (this->m_chunkExecutionStates[chunkNumber] == COM_ES_NOT_SCHEDULED) {
-		this->m_chunkExecutionStates[chunkNumber] = COM_ES_SCHEDULED;
-		WorkScheduler::schedule(this, chunkNumber);
-		return true;
+	if (this->m_isOutput) {
+		return false;
+	}
+
+	if (this->m_viewerBorder.xmin != 0 || this->m_viewerBorder.xmax != (int)this->m_width ||
+	    this->m_viewerBorder.ymin != 0 || this->m_viewerBorder.ymax != (int)this->m_height)
+	{
+		return false;
 	}
-	return false;
+
+	/* chunks are not calculated anymore once the execution is canceled */
+	return !this->getOutputOperation()->isBreaked();
 }
 
-bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph, int xChunk, int yChunk)
+void ExecutionGroup::scheduleChunk(unsigned int chunkNumber)
 {
-	if (xChunk < 0 || xChunk >= (int)this->m_numberOfXChunks) {
-		return true;
-	}
-	if (yChunk < 0 || yChunk >= (int)this->m_numberOfYChunks) {
-		return true;
-	}
-	int chunkNumber = yChunk * this->m_numberOfXChunks + xChunk;
-	// chunk is already executed
-	if (this->m_chunkExecutionStates[chunkNumber] == COM_ES_EXECUTED) {
-		return true;
-	}
+	WorkScheduler::schedule(this, chunkNumber);
+}
 
-	// chunk is scheduled, but not executed
-	if (this->m_chunkExecutionStates[chunkNumber] == COM_ES_SCHEDULED) {
-		return false;
+void ExecutionGroup::scheduleChunkDependencies(unsigned int chunkNumber, ChunkReferences *readyChunks)
+{
+	// chunk is already executed or scheduled
+	if (this->m_chunkExecutionStates[chunkNumber] != COM_ES_NOT_SCHEDULED) {
+		return;
 	}
+	this->m_chunkExecutionStates[chunkNumber] = COM_ES_SCHEDULED;
 
-	// chunk is nor executed nor scheduled.
 	vector<MemoryProxy *> memoryProxies;
 	this->determineDependingMemoryProxies(&memoryProxies);
 
 	rcti rect;
-	determineChunkRect(&rect, xChunk, yChunk);
+	determineChunkRect(&rect, chunkNumber);
 	unsigned int index;
-	bool canBeExecuted = true;
+	unsigned int numberUnfinished = 0;
 	rcti area;
+	ChunkReference reference = {this, chunkNumber};
 
 	for (index = 0; index < this->m_cachedReadOperations.size(); index++) {
 		ReadBufferOperation *readOperation = (ReadBufferOperation *)this->m_cachedReadOperations[index];
@@ -529,20 +532,22 @@ bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph, int xChun
 		ExecutionGroup *group = memoryProxy->getExecutor();
 
 		if (group != NULL) {
-			if (!group->scheduleAreaWhenPossible(graph, &area)) {
-				canBeExecuted = false;
+			/* cached buffers are calculated already */
+			if (!memoryProxy->isCached()) {
+				numberUnfinished += group->scheduleAreaDependencies(&area, reference, readyChunks);
 			}
+			memoryProxy->addReader();
 		}
 		else {
 			throw "ERROR";
 		}
 	}
 
-	if (canBeExecuted) {
-		scheduleChunk(chunkNumber);
-	}
+	this->m_chunkUnfinishedInputs[chunkNumber] = numberUnfinished;
 
-	return false;
+	if (numberUnfinished == 0) {
+		readyChunks->push_back(reference);
+	}
 }
 
 void ExecutionGroup::determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output)
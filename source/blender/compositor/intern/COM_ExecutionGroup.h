@@ -34,6 +34,7 @@
 using std::vector;
 
 class ExecutionSystem;
+class ExecutionGroup;
 class MemoryProxy;
 class ReadBufferOperation;
 class Device;
@@ -57,6 +58,17 @@ typedef enum ChunkExecutionState {
 	COM_ES_EXECUTED = 2
 } ChunkExecutionState;
 
+/**
+ * @brief reference to a single chunk of an ExecutionGroup
+ * @ingroup Execution
+ */
+typedef struct ChunkReference {
+	ExecutionGroup *group;
+	unsigned int chunkNumber;
+} ChunkReference;
+
+typedef std::vector<ChunkReference> ChunkReferences;
+
 /**
  * @brief Class ExecutionGroup is a group of Operations that are executed as one.
  * This grouping is used to combine Operations that can be executed as one whole when multi-processing.
@@ -155,6 +167,17 @@ private:
 	 *   - COM_ES_EXECUTED: executed
 	 */
 	ChunkExecutionState *m_chunkExecutionStates;
+
+	/**
+	 * @brief per chunk the number of input chunks that are not executed yet.
+	 * the chunk is added to the WorkScheduler when this drops to zero
+	 */
+	unsigned int *m_chunkUnfinishedInputs;
+
+	/**
+	 * @brief per chunk the scheduled chunks of other ExecutionGroups that read from it
+	 */
+	vector<ChunkReferences> m_chunkDependents;
 	
 	/**
 	 * @brief indicator when this ExecutionGroup has valid Operations in its vector for Execution
@@ -208,35 +231,24 @@ private:
 	void determineNumberOfChunks();
 	
 	/**
-	 * @brief try to schedule a specific chunk.
-	 * @note scheduling succeeds when all input requirements are met and the chunks hasn't been scheduled yet.
-	 * @param graph
-	 * @param xChunk
-	 * @param yChunk
-	 * @return [true:false]
-	 * true: package(s) are scheduled
-	 * false: scheduling is deferred (depending workpackages are scheduled)
+	 * @brief schedule a specific chunk and the chunks of other ExecutionGroups it depends on.
+	 * @note the input chunks are scheduled recursively. the chunk is made dependent on all input chunks that
+	 * @note are not executed yet, and is added to readyChunks when there are none.
+	 * @param chunkNumber
+	 * @param readyChunks chunks that can be executed right away. Result
 	 */
-	bool scheduleChunkWhenPossible(ExecutionSystem *graph, int xChunk, int yChunk);
+	void scheduleChunkDependencies(unsigned int chunkNumber, ChunkReferences *readyChunks);
 
 	/**
-	 * @brief try to schedule a specific area.
-	 * @note Check if a certain area is available, when not available this are will be checked.
+	 * @brief schedule all chunks of a specific area, for a chunk of another ExecutionGroup reading it.
 	 * @note This method is called from other ExecutionGroup's.
-	 * @param graph
-	 * @param rect
-	 * @return [true:false]
-	 * true: package(s) are scheduled
-	 * false: scheduling is deferred (depending workpackages are scheduled)
+	 * @param rect the area
+	 * @param dependent the chunk reading the area
+	 * @param readyChunks chunks that can be executed right away. Result
+	 * @return the number of chunks in the area that are not executed yet
 	 */
-	bool scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *rect);
+	unsigned int scheduleAreaDependencies(rcti *rect, const ChunkReference &dependent, ChunkReferences *readyChunks);
 
-	/**
-	 * @brief add a chunk to the WorkScheduler.
-	 * @param chunknumber
-	 */
-	bool scheduleChunk(unsigned int chunkNumber);
-	
 	/**
 	 * @brief determine the area of interest of a certain input area
 	 * @note This method only evaluates a single ReadBufferOperation
@@ -246,6 +258,13 @@ private:
 	 */
 	void determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output);
 
+	/**
+	 * @brief check if executing all chunks calculated the whole buffer of the WriteBufferOperation
+	 * @note the buffer is not complete when a viewer border is used, or when the execution is canceled
+	 * @see MemoryProxy.addToCache
+	 */
+	bool isBufferCompleted();
+
 
 public:
 	// constructors
@@ -361,20 +380,30 @@ public:
 	
 	
 	/**
-	 * @brief schedule an ExecutionGroup
-	 * @note this method will return when all chunks have been calculated, or the execution has breaked (by user)
+	 * @brief schedule an output ExecutionGroup
+	 * @note this method does not wait for the chunks to be calculated, see WorkScheduler.finish
 	 *
 	 * first the order of the chunks will be determined. This is determined by finding the ViewerOperation and get the relevant information from it.
 	 *   - ChunkOrdering
 	 *   - CenterX
 	 *   - CenterY
 	 *
-	 * After determining the order of the chunks the chunks will be scheduled
+	 * After determining the order of the chunks, the chunks and all chunks they depend on are scheduled.
+	 * Chunks without unfinished inputs are added to readyChunks, the others are added to the WorkScheduler
+	 * as soon as their last input chunk is executed.
 	 *
 	 * @see ViewerOperation
 	 * @param system
+	 * @param readyChunks chunks that can be executed right away. Result
+	 */
+	void schedule(ExecutionSystem *system, ChunkReferences *readyChunks);
+
+	/**
+	 * @brief add a chunk to the WorkScheduler.
+	 * @note all input chunks must be executed
+	 * @param chunknumber
 	 */
-	void execute(ExecutionSystem *system);
+	void scheduleChunk(unsigned int chunkNumber);
 	
 	/**
 	 * @brief this method determines the MemoryProxy's where this execution group depends on.
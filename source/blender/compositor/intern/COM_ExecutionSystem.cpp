@@ -22,6 +22,8 @@
 
 #include "COM_ExecutionSystem.h"
 
+#include <set>
+
 #include "PIL_time.h"
 #include "BLI_utildefines.h"
 extern "C" {
@@ -36,6 +38,7 @@ extern "C" {
 #include "COM_ExecutionGroup.h"
 #include "COM_WorkScheduler.h"
 #include "COM_ReadBufferOperation.h"
+#include "COM_WriteBufferOperation.h"
 #include "COM_Debug.h"
 
 #ifdef WITH_CXX_GUARDEDALLOC
@@ -196,16 +199,64 @@ void ExecutionSystem::execute()
 	}
 }
 
+/* memory proxies the group reads from, directly or through other groups */
+static void find_read_memory_proxies(ExecutionGroup *group, std::set<MemoryProxy *> *result)
+{
+	vector<MemoryProxy *> memoryProxies;
+	group->determineDependingMemoryProxies(&memoryProxies);
+
+	for (unsigned int index = 0; index < memoryProxies.size(); index++) {
+		MemoryProxy *memoryProxy = memoryProxies[index];
+		if (result->insert(memoryProxy).second && memoryProxy->getExecutor()) {
+			find_read_memory_proxies(memoryProxy->getExecutor(), result);
+		}
+	}
+}
+
 void ExecutionSystem::executeGroups(CompositorPriority priority)
 {
 	unsigned int index;
 	vector<ExecutionGroup *> executionGroups;
 	this->findOutputExecutionGroup(&executionGroups, priority);
 
+	/* buffers that are not read when executing groups of a lower priority later on,
+	 * can be freed as soon as all chunks reading them are executed */
+	std::set<MemoryProxy *> laterReadProxies;
+	if (!this->getContext().isFastCalculation()) {
+		for (index = 0; index < this->m_groups.size(); index++) {
+			ExecutionGroup *group = this->m_groups[index];
+			if (group->isOutputExecutionGroup() && group->getRenderPriotrity() < priority) {
+				find_read_memory_proxies(group, &laterReadProxies);
+			}
+		}
+	}
+	for (index = 0; index < this->m_operations.size(); index++) {
+		NodeOperation *operation = this->m_operations[index];
+		if (operation->isWriteBufferOperation()) {
+			MemoryProxy *memoryProxy = ((WriteBufferOperation *)operation)->getMemoryProxy();
+			memoryProxy->setFreeWhenRead(laterReadProxies.find(memoryProxy) == laterReadProxies.end());
+		}
+	}
+
+	/* determine the chunks of all groups and their dependencies first, so that no chunk is
+	 * executed while other chunks are still being made dependent on it */
+	ChunkReferences readyChunks;
 	for (index = 0; index < executionGroups.size(); index++) {
 		ExecutionGroup *group = executionGroups[index];
-		group->execute(this);
+		group->schedule(this, &readyChunks);
+	}
+
+	for (index = 0; index < readyChunks.size(); index++) {
+		const ChunkReference &chunk = readyChunks[index];
+		chunk.group->scheduleChunk(chunk.chunkNumber);
+	}
+
+	WorkScheduler::finish();
+
+	for (index = 0; index < executionGroups.size(); index++) {
+		DebugInfo::execution_group_finished(executionGroups[index]);
 	}
+	DebugInfo::graphviz(this);
 }
 
 void ExecutionSystem::findOutputExecutionGroup(vector<ExecutionGroup *> *result, CompositorPriority priority) const
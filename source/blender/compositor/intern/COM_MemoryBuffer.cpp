@@ -94,7 +94,8 @@ MemoryBuffer::MemoryBuffer(DataType dataType, rcti *rect)
 }
 MemoryBuffer *MemoryBuffer::duplicate()
 {
-	MemoryBuffer *result = new MemoryBuffer(this->m_memoryProxy, &this->m_rect);
+	/* cached buffers may outlive their memory proxy */
+	MemoryBuffer *result = new MemoryBuffer(this->m_datatype, &this->m_rect);
 	memcpy(result->m_buffer, this->m_buffer, this->determineBufferSize() * this->m_num_channels * sizeof(float));
 	return result;
 }
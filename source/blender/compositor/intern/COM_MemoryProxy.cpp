@@ -22,12 +22,19 @@
 
 #include "COM_MemoryProxy.h"
 
+#include "atomic_ops.h"
 
 MemoryProxy::MemoryProxy(DataType datatype)
 {
 	this->m_writeBufferOperation = NULL;
 	this->m_executor = NULL;
+	this->m_buffer = NULL;
 	this->m_datatype = datatype;
+	this->m_numUnfinishedReaders = 0;
+	this->m_freeWhenRead = false;
+	this->m_cacheKey = 0;
+	this->m_cacheEntry = NULL;
+	this->m_isCached = false;
 }
 
 void MemoryProxy::allocate(unsigned int width, unsigned int height)
@@ -38,14 +45,44 @@ void MemoryProxy::allocate(unsigned int width, unsigned int height)
 	result.ymin = 0;
 	result.ymax = height;
 
+	if (this->m_cacheKey) {
+		this->m_cacheEntry = BufferCache::acquire(this->m_cacheKey, width, height);
+		if (this->m_cacheEntry) {
+			this->m_buffer = BufferCache::getBuffer(this->m_cacheEntry);
+			this->m_isCached = true;
+			return;
+		}
+	}
+
 	this->m_buffer = new MemoryBuffer(this, 1, &result);
 }
 
 void MemoryProxy::free()
 {
-	if (this->m_buffer) {
+	if (this->m_cacheEntry) {
+		BufferCache::release(this->m_cacheEntry);
+		this->m_cacheEntry = NULL;
+		this->m_buffer = NULL;
+	}
+	else if (this->m_buffer) {
 		delete this->m_buffer;
 		this->m_buffer = NULL;
 	}
+	this->m_isCached = false;
+}
+
+void MemoryProxy::addToCache()
+{
+	if (this->m_cacheKey && this->m_buffer && !this->m_cacheEntry) {
+		this->m_cacheEntry = BufferCache::insert(this->m_cacheKey, this->m_buffer);
+	}
+}
+
+void MemoryProxy::removeReader()
+{
+	if (atomic_sub_u(&this->m_numUnfinishedReaders, 1) == 0 && this->m_freeWhenRead) {
+		/* the chunks writing to the buffer are executed before any of its readers */
+		free();
+	}
 }
 
@@ -26,6 +26,7 @@ class MemoryProxy;
 #ifndef _COM_MemoryProxy_h_
 #define _COM_MemoryProxy_h_
 #include "COM_ExecutionGroup.h"
+#include "COM_BufferCache.h"
 
 class ExecutionGroup;
 class WriteBufferOperation;
@@ -68,6 +69,31 @@ private:
 	 */
 	DataType m_datatype;
 
+	/**
+	 * @brief number of scheduled chunks reading this MemoryProxy that are not executed yet
+	 */
+	unsigned int m_numUnfinishedReaders;
+
+	/**
+	 * @brief free the allocated memory as soon as all scheduled readers are executed
+	 */
+	bool m_freeWhenRead;
+
+	/**
+	 * @brief key of the buffer in the BufferCache, zero when the buffer is not cached
+	 */
+	uint64_t m_cacheKey;
+
+	/**
+	 * @brief entry in the BufferCache when the allocated memory is owned by the cache
+	 */
+	BufferCacheEntry *m_cacheEntry;
+
+	/**
+	 * @brief the allocated memory was found in the BufferCache, and is already calculated
+	 */
+	bool m_isCached;
+
 public:
 	MemoryProxy(DataType type);
 	
@@ -111,6 +137,41 @@ public:
 
 	inline DataType getDataType() { return this->m_datatype; }
 
+	/**
+	 * @brief set whether the allocated memory can be freed as soon as all scheduled readers are executed
+	 * @note only allowed when no readers are executed later on
+	 */
+	void setFreeWhenRead(bool freeWhenRead) { this->m_freeWhenRead = freeWhenRead; }
+
+	/**
+	 * @brief register a scheduled chunk that reads this MemoryProxy
+	 * @note must not be called while chunks are being executed
+	 */
+	void addReader() { this->m_numUnfinishedReaders++; }
+
+	/**
+	 * @brief unregister an executed chunk that read this MemoryProxy
+	 * frees the allocated memory when it was the last reader, and FreeWhenRead is set
+	 */
+	void removeReader();
+
+	/**
+	 * @brief set the key of the buffer in the BufferCache, zero disables caching
+	 * @note must be set before the memory is allocated
+	 */
+	void setCacheKey(uint64_t key) { this->m_cacheKey = key; }
+
+	/**
+	 * @brief check if the allocated memory was found in the BufferCache
+	 * in that case the executor does not need to calculate it
+	 */
+	bool isCached() const { return this->m_isCached; }
+
+	/**
+	 * @brief add the allocated memory to the BufferCache, after it has been fully calculated
+	 */
+	void addToCache();
+
 #ifdef WITH_CXX_GUARDEDALLOC
 	MEM_CXX_CLASS_ALLOC_FUNCS("COM:MemoryProxy")
 #endif
@@ -19,8 +19,18 @@
  *		Lukas Toenne
  */
 
+#include <string.h>
+#include <typeinfo>
+
 extern "C" {
 #include "BLI_utildefines.h"
+#include "BKE_camera.h"
+#include "BKE_node.h"
+#include "DNA_camera_types.h"
+#include "DNA_color_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+#include "MEM_guardedalloc.h"
 }
 
 #include "COM_NodeConverter.h"
@@ -45,8 +55,15 @@ extern "C" {
 NodeOperationBuilder::NodeOperationBuilder(const CompositorContext *context, bNodeTree *b_nodetree) :
     m_context(context),
     m_current_node(NULL),
+    m_current_node_hash(0),
+    m_current_node_num_operations(0),
     m_active_viewer(NULL)
 {
+	/* final renders are not edited */
+	m_use_buffer_cache = !context->isRendering() && BufferCache::isEnabled();
+	if (m_use_buffer_cache)
+		BufferCache::beginExecution();
+	
 	m_graph.from_bNodeTree(*context, b_nodetree);
 }
 
@@ -54,6 +71,108 @@ NodeOperationBuilder::~NodeOperationBuilder()
 {
 }
 
+static uint64_t curve_mapping_hash(uint64_t hash, const CurveMapping *cumap)
+{
+	/* only settings affecting the result, curve points are not part of the struct */
+	const int flag = cumap->flag & CUMA_DO_CLIP;
+	hash = BufferCache::hash(hash, &flag, sizeof(flag));
+	hash = BufferCache::hash(hash, &cumap->clipr, sizeof(cumap->clipr));
+	hash = BufferCache::hash(hash, cumap->black, sizeof(cumap->black));
+	hash = BufferCache::hash(hash, cumap->white, sizeof(cumap->white));
+	
+	for (int i = 0; i < CM_TOT; i++) {
+		const CurveMap *cuma = &cumap->cm[i];
+		hash = BufferCache::hash(hash, &cuma->totpoint, sizeof(cuma->totpoint));
+		hash = BufferCache::hash(hash, &cuma->flag, sizeof(cuma->flag));
+		hash = BufferCache::hash(hash, cuma->ext_in, sizeof(cuma->ext_in));
+		hash = BufferCache::hash(hash, cuma->ext_out, sizeof(cuma->ext_out));
+		
+		for (int a = 0; a < cuma->totpoint; a++) {
+			const CurveMapPoint *cmp = &cuma->curve[a];
+			const short point_flag = cmp->flag & CUMA_VECTOR;
+			hash = BufferCache::hash(hash, &cmp->x, sizeof(cmp->x));
+			hash = BufferCache::hash(hash, &cmp->y, sizeof(cmp->y));
+			hash = BufferCache::hash(hash, &point_flag, sizeof(point_flag));
+		}
+	}
+	
+	return hash;
+}
+
+static uint64_t socket_values_hash(uint64_t hash, const ListBase *sockets)
+{
+	for (bNodeSocket *sock = (bNodeSocket *)sockets->first; sock; sock = sock->next) {
+		if (sock->default_value)
+			hash = BufferCache::hash(hash, sock->default_value, MEM_allocN_len(sock->default_value));
+	}
+	return hash;
+}
+
+/* the defocus node reads the camera of the scene, which is not tagged for execution when edited */
+static uint64_t defocus_camera_hash(uint64_t hash, bNode *bnode, const CompositorContext *context)
+{
+	const Scene *scene = bnode->id ? (Scene *)bnode->id : context->getScene();
+	Object *camob = scene ? scene->camera : NULL;
+	
+	hash = BufferCache::hash(hash, &camob, sizeof(camob));
+	
+	if (camob && camob->type == OB_CAMERA) {
+		const Camera *camera = (Camera *)camob->data;
+		const float settings[3] = {camera->lens,
+		                           BKE_camera_sensor_size(camera->sensor_fit, camera->sensor_x, camera->sensor_y),
+		                           BKE_camera_object_dof_distance(camob)};
+		hash = BufferCache::hash(hash, settings, sizeof(settings));
+	}
+	
+	return hash;
+}
+
+/* hash of all node settings that can affect the result of the operations of the node,
+ * COM_BUFFER_CACHE_NO_KEY when the results of the node can't be cached */
+static uint64_t node_settings_hash(Node *node, const CompositorContext *context)
+{
+	bNode *bnode = node->getbNode();
+	uint64_t hash = COM_BUFFER_CACHE_HASH_INIT;
+	
+	if (!bnode)
+		return hash;
+	
+	/* textures can be edited (including their images and node trees) without
+	 * tagging the node for execution, their results are always calculated */
+	if (bnode->type == CMP_NODE_TEXTURE)
+		return COM_BUFFER_CACHE_NO_KEY;
+	
+	hash = BufferCache::hash(hash, &bnode->type, sizeof(bnode->type));
+	hash = BufferCache::hash(hash, &bnode->custom1, sizeof(bnode->custom1));
+	hash = BufferCache::hash(hash, &bnode->custom2, sizeof(bnode->custom2));
+	hash = BufferCache::hash(hash, &bnode->custom3, sizeof(bnode->custom3));
+	hash = BufferCache::hash(hash, &bnode->custom4, sizeof(bnode->custom4));
+	
+	if (bnode->id) {
+		/* the data of the datablock can change without changing the node,
+		 * nodes are tagged for execution in that case (e.g. new render results, image and mask edits) */
+		const unsigned int generation = BufferCache::getNodeGeneration(bnode);
+		hash = BufferCache::hash(hash, &bnode->id, sizeof(bnode->id));
+		hash = BufferCache::hash(hash, &generation, sizeof(generation));
+	}
+	
+	if (bnode->storage) {
+		if (ELEM(bnode->type, CMP_NODE_TIME, CMP_NODE_CURVE_VEC, CMP_NODE_CURVE_RGB, CMP_NODE_HUECORRECT))
+			hash = curve_mapping_hash(hash, (CurveMapping *)bnode->storage);
+		else
+			hash = BufferCache::hash(hash, bnode->storage, MEM_allocN_len(bnode->storage));
+	}
+	
+	/* input values are also used by operations directly, value and color nodes store their output value */
+	hash = socket_values_hash(hash, &bnode->inputs);
+	hash = socket_values_hash(hash, &bnode->outputs);
+	
+	if (bnode->type == CMP_NODE_DEFOCUS)
+		hash = defocus_camera_hash(hash, bnode, context);
+	
+	return hash;
+}
+
 void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 {
 	/* interface handle for nodes */
@@ -63,6 +182,10 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 		Node *node = (Node *)m_graph.nodes()[index];
 		
 		m_current_node = node;
+		if (m_use_buffer_cache) {
+			m_current_node_hash = node_settings_hash(node, m_context);
+			m_current_node_num_operations = 0;
+		}
 		
 		DebugInfo::node_to_operations(node);
 		node->convertToOperations(converter, *m_context);
@@ -124,6 +247,8 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 	/* create execution groups */
 	group_operations();
 	
+	add_buffer_cache_keys();
+	
 	/* transfer resulting operations to the system */
 	system->set_operations(m_operations, m_groups);
 }
@@ -131,6 +256,16 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 void NodeOperationBuilder::addOperation(NodeOperation *operation)
 {
 	m_operations.push_back(operation);
+	
+	if (m_current_node && m_use_buffer_cache) {
+		/* operations of the same node are distinguished by the order in which they are added */
+		if (m_current_node_hash == COM_BUFFER_CACHE_NO_KEY)
+			m_node_hashes[operation] = COM_BUFFER_CACHE_NO_KEY;
+		else
+			m_node_hashes[operation] = BufferCache::hash(m_current_node_hash, &m_current_node_num_operations,
+			                                             sizeof(m_current_node_num_operations));
+		m_current_node_num_operations++;
+	}
 }
 
 void NodeOperationBuilder::mapInputSocket(NodeInput *node_socket, NodeOperationInput *operation_socket)
@@ -693,3 +828,116 @@ void NodeOperationBuilder::group_operations()
 		}
 	}
 }
+
+/* hash of all settings used by all operations, that are not part of the node settings */
+static uint64_t context_hash(const CompositorContext *context)
+{
+	uint64_t hash = COM_BUFFER_CACHE_HASH_INIT;
+	const RenderData *rd = context->getRenderData();
+	const Scene *scene = context->getScene();
+	const int framenumber = context->getFramenumber();
+	const CompositorQuality quality = context->getQuality();
+	const bool fast_calculation = context->isFastCalculation();
+	
+	hash = BufferCache::hash(hash, &scene, sizeof(scene));
+	hash = BufferCache::hash(hash, &framenumber, sizeof(framenumber));
+	hash = BufferCache::hash(hash, &quality, sizeof(quality));
+	hash = BufferCache::hash(hash, &fast_calculation, sizeof(fast_calculation));
+	if (rd) {
+		hash = BufferCache::hash(hash, &rd->xsch, sizeof(rd->xsch));
+		hash = BufferCache::hash(hash, &rd->ysch, sizeof(rd->ysch));
+		hash = BufferCache::hash(hash, &rd->size, sizeof(rd->size));
+	}
+	if (context->getViewName())
+		hash = BufferCache::hash(hash, context->getViewName(), strlen(context->getViewName()));
+	
+	return hash;
+}
+
+uint64_t NodeOperationBuilder::operation_hash(OperationHashes &hashes, uint64_t context_hash, NodeOperation *op) const
+{
+	OperationHashes::const_iterator it = hashes.find(op);
+	if (it != hashes.end())
+		return it->second;
+	
+	uint64_t hash = context_hash;
+	const char *type_name = typeid(*op).name();
+	const unsigned int resolution[2] = {op->getWidth(), op->getHeight()};
+	
+	hash = BufferCache::hash(hash, type_name, strlen(type_name));
+	hash = BufferCache::hash(hash, resolution, sizeof(resolution));
+	for (int index = 0; index < op->getNumberOfOutputSockets(); index++) {
+		const DataType datatype = op->getOutputSocket(index)->getDataType();
+		hash = BufferCache::hash(hash, &datatype, sizeof(datatype));
+	}
+	
+	OperationHashes::const_iterator node_it = m_node_hashes.find(op);
+	if (node_it != m_node_hashes.end()) {
+		if (node_it->second == COM_BUFFER_CACHE_NO_KEY) {
+			hashes[op] = COM_BUFFER_CACHE_NO_KEY;
+			return COM_BUFFER_CACHE_NO_KEY;
+		}
+		hash = BufferCache::hash(hash, &node_it->second, sizeof(node_it->second));
+	}
+	
+	if (op->isSetOperation()) {
+		/* constants don't depend on the coordinates */
+		float value[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+		op->readSampled(value, 0.0f, 0.0f, COM_PS_NEAREST);
+		hash = BufferCache::hash(hash, value, sizeof(value));
+	}
+	
+	for (int index = 0; index < op->getNumberOfInputSockets(); index++) {
+		NodeOperationOutput *link = op->getInputSocket(index)->getLink();
+		uint64_t input_hash = 0;
+		
+		if (link) {
+			NodeOperation &input_op = link->getOperation();
+			input_hash = operation_hash(hashes, context_hash, &input_op);
+			/* results depending on uncached results can't be cached either */
+			if (input_hash == COM_BUFFER_CACHE_NO_KEY) {
+				hashes[op] = COM_BUFFER_CACHE_NO_KEY;
+				return COM_BUFFER_CACHE_NO_KEY;
+			}
+			for (int output_index = 0; output_index < input_op.getNumberOfOutputSockets(); output_index++) {
+				if (input_op.getOutputSocket(output_index) == link)
+					input_hash = BufferCache::hash(input_hash, &output_index, sizeof(output_index));
+			}
+		}
+		hash = BufferCache::hash(hash, &input_hash, sizeof(input_hash));
+	}
+	
+	if (op->isReadBufferOperation()) {
+		MemoryProxy *memproxy = ((ReadBufferOperation *)op)->getMemoryProxy();
+		const uint64_t input_hash = operation_hash(hashes, context_hash, memproxy->getWriteBufferOperation());
+		if (input_hash == COM_BUFFER_CACHE_NO_KEY) {
+			hashes[op] = COM_BUFFER_CACHE_NO_KEY;
+			return COM_BUFFER_CACHE_NO_KEY;
+		}
+		hash = BufferCache::hash(hash, &input_hash, sizeof(input_hash));
+	}
+	
+	hashes[op] = hash;
+	return hash;
+}
+
+void NodeOperationBuilder::add_buffer_cache_keys()
+{
+	if (!m_use_buffer_cache)
+		return;
+	
+	const uint64_t hash = context_hash(m_context);
+	OperationHashes hashes;
+	
+	for (Operations::const_iterator it = m_operations.begin(); it != m_operations.end(); ++it) {
+		NodeOperation *op = *it;
+		
+		if (op->isWriteBufferOperation()) {
+			WriteBufferOperation *write_op = (WriteBufferOperation *)op;
+			
+			/* single values are calculated right away */
+			if (!write_op->isSingleValue())
+				write_op->getMemoryProxy()->setCacheKey(operation_hash(hashes, hash, write_op));
+		}
+	}
+}
@@ -27,6 +27,7 @@
 #include <vector>
 
 #include "COM_NodeGraph.h"
+#include "COM_BufferCache.h"
 
 using std::vector;
 
@@ -73,6 +74,8 @@ public:
 	typedef std::vector<NodeOperationInput *> OpInputs;
 	typedef std::map<NodeInput *, OpInputs> OpInputInverseMap;
 	
+	typedef std::map<NodeOperation *, uint64_t> OperationHashes;
+	
 private:
 	const CompositorContext *m_context;
 	NodeGraph m_graph;
@@ -88,6 +91,13 @@ private:
 	
 	Node *m_current_node;
 	
+	/** Calculate BufferCache keys for the buffers */
+	bool m_use_buffer_cache;
+	/** Maps operations created by nodes to a hash of the node settings */
+	OperationHashes m_node_hashes;
+	uint64_t m_current_node_hash;
+	unsigned int m_current_node_num_operations;
+	
 	/** Operation that will be writing to the viewer image
 	 *  Only one operation can occupy this place at a time,
 	 *  to avoid race conditions
@@ -159,6 +169,10 @@ protected:
 	void group_operations();
 	ExecutionGroup *make_group(NodeOperation *op);
 	
+	/** Set the BufferCache keys of buffers, so they can be reused by later executions */
+	void add_buffer_cache_keys();
+	uint64_t operation_hash(OperationHashes &hashes, uint64_t context_hash, NodeOperation *op) const;
+	
 private:
 	PreviewOperation *make_preview_operation() const;
 
@@ -22,4 +22,9 @@
 
 #include "COM_SocketReader.h"
 
-
+void SocketReader::executeRow(float *output, int x, int y, int width)
+{
+	for (int i = 0; i < width; i++) {
+		executePixelSampled(&output[i * COM_NUM_CHANNELS_COLOR], x + i, y, COM_PS_NEAREST);
+	}
+}
@@ -95,6 +95,18 @@ protected:
 	                                  float /*x*/, float /*y*/,
 	                                  float /*dx*/[2], float /*dy*/[2]) {}
 
+	/**
+	 * @brief calculate a row of pixels using the nearest sampler
+	 * @note the default implementation calculates the pixels one by one with executePixelSampled,
+	 * simple operations implement this to process the whole row in a single loop.
+	 * @param output array of width * COM_NUM_CHANNELS_COLOR floats, for every pixel as many channels
+	 * as the output socket has are set
+	 * @param x the x-coordinate of the first pixel to calculate in image space
+	 * @param y the y-coordinate of the pixels to calculate in image space
+	 * @param width the number of pixels to calculate, at most COM_ROW_WIDTH
+	 */
+	virtual void executeRow(float *output, int x, int y, int width);
+
 public:
 	inline void readSampled(float result[4], float x, float y, PixelSampler sampler) {
 		executePixelSampled(result, x, y, sampler);
@@ -105,6 +117,9 @@ public:
 	inline void readFiltered(float result[4], float x, float y, float dx[2], float dy[2]) {
 		executePixelFiltered(result, x, y, dx, dy);
 	}
+	inline void readRow(float *result, int x, int y, int width) {
+		executeRow(result, x, y, width);
+	}
 
 	virtual void *initializeTileData(rcti * /*rect*/) { return 0; }
 	virtual void deinitializeTileData(rcti * /*rect*/, void * /*data*/) {}
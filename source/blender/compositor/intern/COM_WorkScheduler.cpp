@@ -34,8 +34,11 @@
 #include "MEM_guardedalloc.h"
 
 #include "PIL_time.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
+#include "atomic_ops.h"
+
 #include "BKE_global.h"
 
 #if COM_CURRENT_THREADING_MODEL == COM_TM_NOTHREAD
@@ -49,16 +52,18 @@
 #endif
 
 
-/// @brief list of all CPUDevices. for every hardware thread an instance of CPUDevice is created
+/// @brief list of all CPUDevices. for every thread of the task scheduler an instance of CPUDevice is created
 static vector<CPUDevice*> g_cpudevices;
 static ThreadLocal(CPUDevice *) g_thread_device;
 
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
-/// @brief list of all thread for every CPUDevice in cpudevices a thread exists
-static ListBase g_cputhreads;
 static bool g_cpuInitialized = false;
-/// @brief all scheduled work for the cpu
-static ThreadQueue *g_cpuqueue;
+/// @brief maximum number of threads working on the cpu pool at the same time
+static int g_cpuNumThreads = 0;
+/// @brief all scheduled work for the cpu, executed by the shared task scheduler
+static TaskPool *g_cpupool;
+/// @brief number of scheduled work packages (cpu and gpu) that are not finished yet
+static unsigned int g_numScheduledWork = 0;
 static ThreadQueue *g_gpuqueue;
 #ifdef COM_OPENCL_ENABLED
 static cl_context g_context;
@@ -152,18 +157,17 @@ int COM_isHighlightedbNode(bNode *bnode)
 } // end extern "C"
 
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
-void *WorkScheduler::thread_execute_cpu(void *data)
+void WorkScheduler::thread_execute_cpu(TaskPool *__restrict /*pool*/, void *taskdata, int threadid)
 {
-	CPUDevice *device = (CPUDevice *)data;
-	WorkPackage *work;
+	CPUDevice *device = g_cpudevices[threadid];
+	WorkPackage *work = (WorkPackage *)taskdata;
 	BLI_thread_local_set(g_thread_device, device);
-	while ((work = (WorkPackage *)BLI_thread_queue_pop(g_cpuqueue))) {
-		HIGHLIGHT(work);
-		device->execute(work);
-		delete work;
-	}
-	
-	return NULL;
+	HIGHLIGHT(work);
+	device->execute(work);
+	delete work;
+
+	/* executing the work can schedule new work, so this is only decreased afterwards */
+	atomic_sub_u(&g_numScheduledWork, 1);
 }
 
 void *WorkScheduler::thread_execute_gpu(void *data)
@@ -175,6 +179,7 @@ void *WorkScheduler::thread_execute_gpu(void *data)
 		HIGHLIGHT(work);
 		device->execute(work);
 		delete work;
+		atomic_sub_u(&g_numScheduledWork, 1);
 	}
 	
 	return NULL;
@@ -191,15 +196,16 @@ void WorkScheduler::schedule(ExecutionGroup *group, int chunkNumber)
 	device.execute(package);
 	delete package;
 #elif COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+	atomic_add_u(&g_numScheduledWork, 1);
 #ifdef COM_OPENCL_ENABLED
 	if (group->isOpenCL() && g_openclActive) {
 		BLI_thread_queue_push(g_gpuqueue, package);
 	}
 	else {
-		BLI_thread_queue_push(g_cpuqueue, package);
+		BLI_task_pool_push(g_cpupool, thread_execute_cpu, package, false, TASK_PRIORITY_LOW);
 	}
 #else
-	BLI_thread_queue_push(g_cpuqueue, package);
+	BLI_task_pool_push(g_cpupool, thread_execute_cpu, package, false, TASK_PRIORITY_LOW);
 #endif
 #endif
 }
@@ -208,11 +214,10 @@ void WorkScheduler::start(CompositorContext &context)
 {
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
 	unsigned int index;
-	g_cpuqueue = BLI_thread_queue_init();
-	BLI_init_threads(&g_cputhreads, thread_execute_cpu, g_cpudevices.size());
-	for (index = 0; index < g_cpudevices.size(); index++) {
-		Device *device = g_cpudevices[index];
-		BLI_insert_thread(&g_cputhreads, device);
+	g_numScheduledWork = 0;
+	g_cpupool = BLI_task_pool_create(BLI_task_scheduler_get(), NULL);
+	if (g_cpuNumThreads < (int)g_cpudevices.size()) {
+		BLI_pool_set_num_threads(g_cpupool, g_cpuNumThreads);
 	}
 #ifdef COM_OPENCL_ENABLED
 	if (context.getHasActiveOpenCLDevices()) {
@@ -233,26 +238,20 @@ void WorkScheduler::start(CompositorContext &context)
 void WorkScheduler::finish()
 {
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
-#ifdef COM_OPENCL_ENABLED
-	if (g_openclActive) {
-		BLI_thread_queue_wait_finish(g_gpuqueue);
-		BLI_thread_queue_wait_finish(g_cpuqueue);
-	}
-	else {
-		BLI_thread_queue_wait_finish(g_cpuqueue);
+	/* the calling thread helps executing cpu work. work on the gpu threads
+	 * can schedule new cpu work when finished, so wait until nothing is left */
+	BLI_task_pool_work_and_wait(g_cpupool);
+	while (atomic_add_u(&g_numScheduledWork, 0) != 0) {
+		PIL_sleep_ms(1);
+		BLI_task_pool_work_and_wait(g_cpupool);
 	}
-#else
-	BLI_thread_queue_wait_finish(cpuqueue);
-#endif
 #endif
 }
 void WorkScheduler::stop()
 {
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
-	BLI_thread_queue_nowait(g_cpuqueue);
-	BLI_end_threads(&g_cputhreads);
-	BLI_thread_queue_free(g_cpuqueue);
-	g_cpuqueue = NULL;
+	BLI_task_pool_free(g_cpupool);
+	g_cpupool = NULL;
 #ifdef COM_OPENCL_ENABLED
 	if (g_openclActive) {
 		BLI_thread_queue_nowait(g_gpuqueue);
@@ -301,25 +300,13 @@ void WorkScheduler::initialize(bool use_opencl, int num_cpu_threads)
 	}
 
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
-	/* deinitialize if number of threads doesn't match */
-	if (g_cpudevices.size() != num_cpu_threads) {
-		Device *device;
-
-		while (g_cpudevices.size() > 0) {
-			device = g_cpudevices.back();
-			g_cpudevices.pop_back();
-			device->deinitialize();
-			delete device;
-		}
-		if (g_cpuInitialized) {
-			BLI_thread_local_delete(g_thread_device);
-		}
-		g_cpuInitialized = false;
-	}
+	g_cpuNumThreads = num_cpu_threads;
 
-	/* initialize CPU threads */
+	/* initialize CPU devices, work is executed by the threads of the shared task scheduler,
+	 * so a device is needed for each of those */
 	if (!g_cpuInitialized) {
-		for (int index = 0; index < num_cpu_threads; index++) {
+		int num_threads = BLI_task_scheduler_num_threads(BLI_task_scheduler_get());
+		for (int index = 0; index < num_threads; index++) {
 			CPUDevice *device = new CPUDevice(index);
 			device->initialize();
 			g_cpudevices.push_back(device);
@@ -458,3 +445,13 @@ int WorkScheduler::current_thread_id()
 	CPUDevice *device = (CPUDevice *)BLI_thread_local_get(g_thread_device);
 	return device->thread_id();
 }
+
+CPUDevice *WorkScheduler::current_device()
+{
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+	if (g_cpuInitialized) {
+		return (CPUDevice *)BLI_thread_local_get(g_thread_device);
+	}
+#endif
+	return NULL;
+}
@@ -27,10 +27,13 @@
 extern "C" {
 #  include "BLI_threads.h"
 }
+#include "BLI_task.h"
 #include "COM_WorkPackage.h"
 #include "COM_defines.h"
 #include "COM_Device.h"
 
+class CPUDevice;
+
 /** @brief the workscheduler
  * @ingroup execution
  */
@@ -43,10 +46,10 @@ class WorkScheduler {
 	static bool isStopping();
 
 	/**
-	 * @brief main thread loop for cpudevices
-	 * inside this loop new work is queried and being executed
+	 * @brief task of the cpu pool
+	 * executes a single WorkPackage on the CPUDevice of the calling thread
 	 */
-	static void *thread_execute_cpu(void *data);
+	static void thread_execute_cpu(TaskPool *__restrict pool, void *taskdata, int threadid);
 
 	/**
 	 * @brief main thread loop for gpudevices
@@ -57,7 +60,7 @@ class WorkScheduler {
 public:
 	/**
 	 * @brief schedule a chunk of a group to be calculated.
-	 * An execution group schedules a chunk in the WorkScheduler
+	 * An execution group schedules a chunk in the WorkScheduler when all its input chunks are executed
 	 * when ExecutionGroup.isOpenCL is set the work will be handled by a OpenCLDevice
 	 * otherwise the work is scheduled for an CPUDevice
 	 * @see ExecutionGroup.execute
@@ -72,7 +75,8 @@ public:
 	 * during initialization the mutexes are initialized.
 	 * there are two mutexes (for every device type one)
 	 * After mutex initialization the system is queried in order to count the number of CPUDevices and GPUDevices to be created.
-	 * For every hardware thread a CPUDevice and for every OpenCL GPU device a OpenCLDevice is created.
+	 * For every thread of the task scheduler a CPUDevice and for every OpenCL GPU device a OpenCLDevice is created.
+	 * At most num_cpu_threads CPUDevices execute work at the same time.
 	 * these devices are stored in a separate list (cpudevices & gpudevices)
 	 *
 	 * This function can be called multiple times to lazily initialize OpenCL.
@@ -87,8 +91,8 @@ public:
 
 	/**
 	 * @brief Start the execution
-	 * this methods will start the WorkScheduler. Inside this method all threads are initialized.
-	 * for every device a thread is created.
+	 * this methods will start the WorkScheduler. Inside this method the pool for cpu work is created
+	 * and for every OpenCL device a thread is created.
 	 * @see initialize Initialization and query of the number of devices
 	 */
 	static void start(CompositorContext &context);
@@ -101,7 +105,8 @@ public:
 	static void stop();
 
 	/**
-	 * @brief wait for all work to be completed.
+	 * @brief wait for all work to be completed, including work scheduled while waiting.
+	 * the calling thread helps executing the work.
 	 */
 	static void finish();
 
@@ -115,6 +120,11 @@ public:
 
 	static int current_thread_id();
 
+	/**
+	 * @brief the CPUDevice executing work on the calling thread, NULL when none is
+	 */
+	static CPUDevice *current_device();
+
 #ifdef WITH_CXX_GUARDEDALLOC
 	MEM_CXX_CLASS_ALLOC_FUNCS("COM:WorkScheduler")
 #endif
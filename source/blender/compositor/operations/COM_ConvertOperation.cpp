@@ -21,6 +21,7 @@
  */
 
 #include "COM_ConvertOperation.h"
+#include "COM_CPUDevice.h"
 
 extern "C" {
 #include "IMB_colormanagement.h"
@@ -58,6 +59,16 @@ void ConvertValueToColorOperation::executePixelSampled(float output[4], float x,
 	output[3] = 1.0f;
 }
 
+void ConvertValueToColorOperation::executeRow(float *output, int x, int y, int width)
+{
+	RowBuffer inputValue;
+	this->m_inputOperation->readRow(inputValue, x, y, width);
+	for (int i = 0; i < width * COM_NUM_CHANNELS_COLOR; i += COM_NUM_CHANNELS_COLOR) {
+		output[i] = output[i + 1] = output[i + 2] = inputValue[i];
+		output[i + 3] = 1.0f;
+	}
+}
+
 
 /* ******** Color to Value ******** */
 
@@ -74,6 +85,15 @@ void ConvertColorToValueOperation::executePixelSampled(float output[4], float x,
 	output[0] = (inputColor[0] + inputColor[1] + inputColor[2]) / 3.0f;
 }
 
+void ConvertColorToValueOperation::executeRow(float *output, int x, int y, int width)
+{
+	RowBuffer inputColor;
+	this->m_inputOperation->readRow(inputColor, x, y, width);
+	for (int i = 0; i < width * COM_NUM_CHANNELS_COLOR; i += COM_NUM_CHANNELS_COLOR) {
+		output[i] = (inputColor[i] + inputColor[i + 1] + inputColor[i + 2]) / 3.0f;
+	}
+}
+
 
 /* ******** Color to BW ******** */
 
@@ -90,6 +110,15 @@ void ConvertColorToBWOperation::executePixelSampled(float output[4], float x, fl
 	output[0] = IMB_colormanagement_get_luminance(inputColor);
 }
 
+void ConvertColorToBWOperation::executeRow(float *output, int x, int y, int width)
+{
+	RowBuffer inputColor;
+	this->m_inputOperation->readRow(inputColor, x, y, width);
+	for (int i = 0; i < width * COM_NUM_CHANNELS_COLOR; i += COM_NUM_CHANNELS_COLOR) {
+		output[i] = IMB_colormanagement_get_luminance(&inputColor[i]);
+	}
+}
+
 
 /* ******** Color to Vector ******** */
 
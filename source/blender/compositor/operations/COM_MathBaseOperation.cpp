@@ -21,6 +21,7 @@
  */
 
 #include "COM_MathBaseOperation.h"
+#include "COM_CPUDevice.h"
 extern "C" {
 #include "BLI_math.h"
 }
@@ -72,6 +73,21 @@ void MathBaseOperation::clampIfNeeded(float *color)
 	}
 }
 
+void MathBaseOperation::readInputRows(float *inputValue1, float *inputValue2, int x, int y, int width)
+{
+	this->m_inputValue1Operation->readRow(inputValue1, x, y, width);
+	this->m_inputValue2Operation->readRow(inputValue2, x, y, width);
+}
+
+void MathBaseOperation::clampRowIfNeeded(float *output, int width)
+{
+	if (this->m_useClamp) {
+		for (int i = 0; i < width * COM_NUM_CHANNELS_COLOR; i += COM_NUM_CHANNELS_COLOR) {
+			CLAMP(output[i], 0.0f, 1.0f);
+		}
+	}
+}
+
 void MathAddOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -85,6 +101,20 @@ void MathAddOperation::executePixelSampled(float output[4], float x, float y, Pi
 	clampIfNeeded(output);
 }
 
+void MathAddOperation::executeRow(float *output, int x, int y, int width)
+{
+	RowBuffer inputValue1;
+	RowBuffer inputValue2;
+
+	readInputRows(inputValue1, inputValue2, x, y, width);
+
+	for (int i = 0; i < width * COM_NUM_CHANNELS_COLOR; i += COM_NUM_CHANNELS_COLOR) {
+		output[i] = inputValue1[i] + inputValue2[i];
+	}
+
+	clampRowIfNeeded(output, width);
+}
+
 void MathSubtractOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -98,6 +128,20 @@ void MathSubtractOperation::executePixelSampled(float output[4], float x, float
 	clampIfNeeded(output);
 }
 
+void MathSubtractOperation::executeRow(float *output, int x, int y, int width)
+{
+	RowBuffer inputValue1;
+	RowBuffer inputValue2;
+
+	readInputRows(inputValue1, inputValue2, x, y, width);
+
+	for (int i = 0; i < width * COM_NUM_CHANNELS_COLOR; i += COM_NUM_CHANNELS_COLOR) {
+		output[i] = inputValue1[i] - inputValue2[i];
+	}
+
+	clampRowIfNeeded(output, width);
+}
+
 void MathMultiplyOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -111,6 +155,20 @@ void MathMultiplyOperation::executePixelSampled(float output[4], float x, float
 	clampIfNeeded(output);
 }
 
+void MathMultiplyOperation::executeRow(float *output, int x, int y, int width)
+{
+	RowBuffer inputValue1;
+	RowBuffer inputValue2;
+
+	readInputRows(inputValue1, inputValue2, x, y, width);
+
+	for (int i = 0; i < width * COM_NUM_CHANNELS_COLOR; i += COM_NUM_CHANNELS_COLOR) {
+		output[i] = inputValue1[i] * inputValue2[i];
+	}
+
+	clampRowIfNeeded(output, width);
+}
+
 void MathDivideOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -127,6 +185,23 @@ void MathDivideOperation::executePixelSampled(float output[4], float x, float y,
 	clampIfNeeded(output);
 }
 
+void MathDivideOperation::executeRow(float *output, int x, int y, int width)
+{
+	RowBuffer inputValue1;
+	RowBuffer inputValue2;
+
+	readInputRows(inputValue1, inputValue2, x, y, width);
+
+	for (int i = 0; i < width * COM_NUM_CHANNELS_COLOR; i += COM_NUM_CHANNELS_COLOR) {
+		if (inputValue2[i] == 0) /* We don't want to divide by zero. */
+			output[i] = 0.0;
+		else
+			output[i] = inputValue1[i] / inputValue2[i];
+	}
+
+	clampRowIfNeeded(output, width);
+}
+
 void MathSineOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -265,6 +340,20 @@ void MathMinimumOperation::executePixelSampled(float output[4], float x, float y
 	clampIfNeeded(output);
 }
 
+void MathMinimumOperation::executeRow(float *output, int x, int y, int width)
+{
+	RowBuffer inputValue1;
+	RowBuffer inputValue2;
+
+	readInputRows(inputValue1, inputValue2, x, y, width);
+
+	for (int i = 0; i < width * COM_NUM_CHANNELS_COLOR; i += COM_NUM_CHANNELS_COLOR) {
+		output[i] = min(inputValue1[i], inputValue2[i]);
+	}
+
+	clampRowIfNeeded(output, width);
+}
+
 void MathMaximumOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -278,6 +367,20 @@ void MathMaximumOperation::executePixelSampled(float output[4], float x, float y
 	clampIfNeeded(output);
 }
 
+void MathMaximumOperation::executeRow(float *output, int x, int y, int width)
+{
+	RowBuffer inputValue1;
+	RowBuffer inputValue2;
+
+	readInputRows(inputValue1, inputValue2, x, y, width);
+
+	for (int i = 0; i < width * COM_NUM_CHANNELS_COLOR; i += COM_NUM_CHANNELS_COLOR) {
+		output[i] = max(inputValue1[i], inputValue2[i]);
+	}
+
+	clampRowIfNeeded(output, width);
+}
+
 void MathRoundOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
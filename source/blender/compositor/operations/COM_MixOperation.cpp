@@ -21,6 +21,7 @@
  */
 
 #include "COM_MixOperation.h"
+#include "COM_CPUDevice.h"
 
 extern "C" {
 #  include "BLI_math.h"
@@ -69,6 +70,13 @@ void MixBaseOperation::executePixelSampled(float output[4], float x, float y, Pi
 	output[3] = inputColor1[3];
 }
 
+void MixBaseOperation::readInputRows(float *inputValue, float *inputColor1, float *inputColor2, int x, int y, int width)
+{
+	this->m_inputValueOperation->readRow(inputValue, x, y, width);
+	this->m_inputColor1Operation->readRow(inputColor1, x, y, width);
+	this->m_inputColor2Operation->readRow(inputColor2, x, y, width);
+}
+
 void MixBaseOperation::determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2])
 {
 	NodeOperationInput *socket;
@@ -129,6 +137,28 @@ void MixAddOperation::executePixelSampled(float output[4], float x, float y, Pix
 	clampIfNeeded(output);
 }
 
+void MixAddOperation::executeRow(float *output, int x, int y, int width)
+{
+	RowBuffer inputColor1;
+	RowBuffer inputColor2;
+	RowBuffer inputValue;
+
+	readInputRows(inputValue, inputColor1, inputColor2, x, y, width);
+
+	for (int i = 0; i < width * COM_NUM_CHANNELS_COLOR; i += COM_NUM_CHANNELS_COLOR) {
+		float value = inputValue[i];
+		if (this->useValueAlphaMultiply()) {
+			value *= inputColor2[i + 3];
+		}
+		output[i] = inputColor1[i] + value * inputColor2[i];
+		output[i + 1] = inputColor1[i + 1] + value * inputColor2[i + 1];
+		output[i + 2] = inputColor1[i + 2] + value * inputColor2[i + 2];
+		output[i + 3] = inputColor1[i + 3];
+
+		clampIfNeeded(&output[i]);
+	}
+}
+
 /* ******** Mix Blend Operation ******** */
 
 MixBlendOperation::MixBlendOperation() : MixBaseOperation()
@@ -160,6 +190,29 @@ void MixBlendOperation::executePixelSampled(float output[4], float x, float y, P
 	clampIfNeeded(output);
 }
 
+void MixBlendOperation::executeRow(float *output, int x, int y, int width)
+{
+	RowBuffer inputColor1;
+	RowBuffer inputColor2;
+	RowBuffer inputValue;
+
+	readInputRows(inputValue, inputColor1, inputColor2, x, y, width);
+
+	for (int i = 0; i < width * COM_NUM_CHANNELS_COLOR; i += COM_NUM_CHANNELS_COLOR) {
+		float value = inputValue[i];
+		if (this->useValueAlphaMultiply()) {
+			value *= inputColor2[i + 3];
+		}
+		float valuem = 1.0f - value;
+		output[i] = valuem * (inputColor1[i]) + value * (inputColor2[i]);
+		output[i + 1] = valuem * (inputColor1[i + 1]) + value * (inputColor2[i + 1]);
+		output[i + 2] = valuem * (inputColor1[i + 2]) + value * (inputColor2[i + 2]);
+		output[i + 3] = inputColor1[i + 3];
+
+		clampIfNeeded(&output[i]);
+	}
+}
+
 /* ******** Mix Burn Operation ******** */
 
 MixBurnOperation::MixBurnOperation() : MixBaseOperation()
@@ -623,6 +676,29 @@ void MixMultiplyOperation::executePixelSampled(float output[4], float x, float y
 	clampIfNeeded(output);
 }
 
+void MixMultiplyOperation::executeRow(float *output, int x, int y, int width)
+{
+	RowBuffer inputColor1;
+	RowBuffer inputColor2;
+	RowBuffer inputValue;
+
+	readInputRows(inputValue, inputColor1, inputColor2, x, y, width);
+
+	for (int i = 0; i < width * COM_NUM_CHANNELS_COLOR; i += COM_NUM_CHANNELS_COLOR) {
+		float value = inputValue[i];
+		if (this->useValueAlphaMultiply()) {
+			value *= inputColor2[i + 3];
+		}
+		float valuem = 1.0f - value;
+		output[i] = inputColor1[i] * (valuem + value * inputColor2[i]);
+		output[i + 1] = inputColor1[i + 1] * (valuem + value * inputColor2[i + 1]);
+		output[i + 2] = inputColor1[i + 2] * (valuem + value * inputColor2[i + 2]);
+		output[i + 3] = inputColor1[i + 3];
+
+		clampIfNeeded(&output[i]);
+	}
+}
+
 /* ******** Mix Ovelray Operation ******** */
 
 MixOverlayOperation::MixOverlayOperation() : MixBaseOperation()
@@ -806,6 +882,28 @@ void MixSubtractOperation::executePixelSampled(float output[4], float x, float y
 	clampIfNeeded(output);
 }
 
+void MixSubtractOperation::executeRow(float *output, int x, int y, int width)
+{
+	RowBuffer inputColor1;
+	RowBuffer inputColor2;
+	RowBuffer inputValue;
+
+	readInputRows(inputValue, inputColor1, inputColor2, x, y, width);
+
+	for (int i = 0; i < width * COM_NUM_CHANNELS_COLOR; i += COM_NUM_CHANNELS_COLOR) {
+		float value = inputValue[i];
+		if (this->useValueAlphaMultiply()) {
+			value *= inputColor2[i + 3];
+		}
+		output[i] = inputColor1[i] - value * (inputColor2[i]);
+		output[i + 1] = inputColor1[i + 1] - value * (inputColor2[i + 1]);
+		output[i + 2] = inputColor1[i + 2] - value * (inputColor2[i + 2]);
+		output[i + 3] = inputColor1[i + 3];
+
+		clampIfNeeded(&output[i]);
+	}
+}
+
 /* ******** Mix Value Operation ******** */
 
 MixValueOperation::MixValueOperation() : MixBaseOperation()
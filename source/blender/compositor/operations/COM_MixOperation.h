@@ -50,6 +50,11 @@ protected:
 			CLAMP(color[3], 0.0f, 1.0f);
 		}
 	}
+
+	/**
+	 * read a row of all inputs, see SocketReader.executeRow
+	 */
+	void readInputRows(float *inputValue, float *inputColor1, float *inputColor2, int x, int y, int width);
 	
 public:
 	/**
@@ -84,12 +89,14 @@ class MixAddOperation : public MixBaseOperation {
 public:
 	MixAddOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int width);
 };
 
 class MixBlendOperation : public MixBaseOperation {
 public:
 	MixBlendOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int width);
 };
 
 class MixBurnOperation : public MixBaseOperation {
@@ -156,6 +163,7 @@ class MixMultiplyOperation : public MixBaseOperation {
 public:
 	MixMultiplyOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int width);
 };
 
 class MixOverlayOperation : public MixBaseOperation {
@@ -186,6 +194,7 @@ class MixSubtractOperation : public MixBaseOperation {
 public:
 	MixSubtractOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int width);
 };
 
 class MixValueOperation : public MixBaseOperation {
@@ -102,6 +102,23 @@ void ReadBufferOperation::executePixelFiltered(float output[4], float x, float y
 	}
 }
 
+void ReadBufferOperation::executeRow(float *output, int x, int y, int width)
+{
+	if (m_single_value) {
+		/* write buffer has a single value stored at (0,0) */
+		const int num_channels = m_buffer->get_num_channels();
+		m_buffer->read(output, 0, 0);
+		for (int i = 1; i < width; i++) {
+			memcpy(&output[i * COM_NUM_CHANNELS_COLOR], output, sizeof(float) * num_channels);
+		}
+	}
+	else {
+		for (int i = 0; i < width; i++) {
+			m_buffer->read(&output[i * COM_NUM_CHANNELS_COLOR], x + i, y);
+		}
+	}
+}
+
 bool ReadBufferOperation::determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output)
 {
 	if (this == readOperation) {
@@ -21,6 +21,7 @@
  */
 
 #include "COM_WriteBufferOperation.h"
+#include "COM_CPUDevice.h"
 #include "COM_defines.h"
 #include <stdio.h>
 #include "COM_OpenCLDevice.h"
@@ -96,11 +97,16 @@ void WriteBufferOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/
 		int x;
 		int y;
 		bool breaked = false;
+		RowBuffer row;
 		for (y = y1; y < y2 && (!breaked); y++) {
 			int offset4 = (y * memoryBuffer->getWidth() + x1) * num_channels;
-			for (x = x1; x < x2; x++) {
-				this->m_input->readSampled(&(buffer[offset4]), x, y, COM_PS_NEAREST);
-				offset4 += num_channels;
+			for (x = x1; x < x2; x += COM_ROW_WIDTH) {
+				const int width = min(x2 - x, COM_ROW_WIDTH);
+				this->m_input->readRow(row, x, y, width);
+				for (int i = 0; i < width; i++) {
+					memcpy(&buffer[offset4], &row[i * COM_NUM_CHANNELS_COLOR], sizeof(float) * num_channels);
+					offset4 += num_channels;
+				}
 			}
 			if (isBreaked()) {
 				breaked = true;
@@ -2043,6 +2043,11 @@ static void ui_apply_but(bContext *C, uiBlock *block, uiBut *but, uiHandleButton
 #endif
 	}
 
+	/* jobs reading the data from a thread have to stop before it's changed */
+	if (but->rnaprop && but->rnapoin.id.data) {
+		WM_jobs_kill_data_readers(CTX_wm_manager(C), but->rnapoin.id.data);
+	}
+
 	/* ensures we are writing actual values */
 	editstr = but->editstr;
 	editval = but->editval;
@@ -440,7 +440,7 @@ static void screen_opengl_render_apply(OGLRender *oglrender)
 			context.gpu_fx = oglrender->fx;
 			context.gpu_full_samples = oglrender->ofs_full_samples;
 
-			oglrender->seq_data.ibufs_arr[view_id] = BKE_sequencer_give_ibuf(&context, CFRA, chanshown);
+			oglrender->seq_data.ibufs_arr[view_id] = BKE_sequencer_give_ibuf_threaded(&context, CFRA, chanshown);
 		}
 	}
 
@@ -475,6 +475,8 @@ static void node_area_listener(bScreen *sc, ScrArea *sa, wmNotifier *wmn)
 		case NC_MASK:
 			if (wmn->action == NA_EDITED) {
 				if (snode->nodetree && snode->nodetree->type == NTREE_COMPOSIT) {
+					/* tags mask nodes for execution, the compositor reuses their cached results otherwise */
+					nodeUpdateID(snode->nodetree, wmn->reference);
 					ED_area_tag_refresh(sa);
 				}
 			}
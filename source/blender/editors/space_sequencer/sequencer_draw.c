@@ -900,14 +900,13 @@ void ED_sequencer_special_preview_clear(void)
 	sequencer_special_update_set(NULL);
 }
 
-ImBuf *sequencer_ibuf_get(struct Main *bmain, Scene *scene, SpaceSeq *sseq, int cfra, int frame_ofs, const char *viewname)
+/* render data used for the preview, false when the preview is disabled */
+bool sequencer_render_data_get(struct Main *bmain, Scene *scene, SpaceSeq *sseq, const char *viewname,
+                               SeqRenderData *r_context)
 {
-	SeqRenderData context;
-	ImBuf *ibuf;
 	int rectx, recty;
 	float render_size;
 	float proxy_size = 100.0;
-	short is_break = G.is_break;
 
 	render_size = sseq->render_size;
 	if (render_size == 0) {
@@ -918,7 +917,7 @@ ImBuf *sequencer_ibuf_get(struct Main *bmain, Scene *scene, SpaceSeq *sseq, int
 	}
 
 	if (render_size < 0) {
-		return NULL;
+		return false;
 	}
 
 	rectx = (render_size * (float)scene->r.xsch) / 100.0f + 0.5f;
@@ -927,20 +926,36 @@ ImBuf *sequencer_ibuf_get(struct Main *bmain, Scene *scene, SpaceSeq *sseq, int
 	BKE_sequencer_new_render_data(
 	        bmain->eval_ctx, bmain, scene,
 	        rectx, recty, proxy_size,
-	        &context);
-	context.view_id = BKE_scene_multiview_view_id_get(&scene->r, viewname);
+	        r_context);
+	r_context->view_id = BKE_scene_multiview_view_id_get(&scene->r, viewname);
+
+	return true;
+}
+
+ImBuf *sequencer_ibuf_get(struct Main *bmain, Scene *scene, SpaceSeq *sseq, int cfra, int frame_ofs, const char *viewname)
+{
+	SeqRenderData context;
+	ImBuf *ibuf;
+	short is_break = G.is_break;
+
+	if (!sequencer_render_data_get(bmain, scene, sseq, viewname, &context)) {
+		return NULL;
+	}
 
 	/* sequencer could start rendering, in this case we need to be sure it wouldn't be canceled
 	 * by Esc pressed somewhere in the past
 	 */
 	G.is_break = false;
 
-	if (special_seq_update)
+	if (special_seq_update) {
+		/* the strip is being tweaked, frames rendered ahead are outdated anyway */
+		BKE_sequencer_prefetch_stop();
 		ibuf = BKE_sequencer_give_ibuf_direct(&context, cfra + frame_ofs, special_seq_update);
-	else if (!U.prefetchframes) // XXX || (G.f & G_PLAYANIM) == 0) {
-		ibuf = BKE_sequencer_give_ibuf(&context, cfra + frame_ofs, sseq->chanshown);
-	else
+	}
+	else {
+		/* waits for the frame being prefetched */
 		ibuf = BKE_sequencer_give_ibuf_threaded(&context, cfra + frame_ofs, sseq->chanshown);
+	}
 
 	/* restore state so real rendering would be canceled (if needed) */
 	G.is_break = is_break;
@@ -1439,32 +1454,6 @@ void draw_image_seq(const bContext *C, Scene *scene, ARegion *ar, SpaceSeq *sseq
 	}
 }
 
-#if 0
-void drawprefetchseqspace(Scene *scene, ARegion *UNUSED(ar), SpaceSeq *sseq)
-{
-	int rectx, recty;
-	int render_size = sseq->render_size;
-	int proxy_size = 100.0; 
-	if (render_size == 0) {
-		render_size = scene->r.size;
-	}
-	else {
-		proxy_size = render_size;
-	}
-	if (render_size < 0) {
-		return;
-	}
-
-	rectx = (render_size * scene->r.xsch) / 100;
-	recty = (render_size * scene->r.ysch) / 100;
-
-	if (sseq->mainb != SEQ_DRAW_SEQUENCE) {
-		give_ibuf_prefetch_request(
-		    rectx, recty, (scene->r.cfra), sseq->chanshown,
-		    proxy_size);
-	}
-}
-#endif
 
 /* draw backdrop of the sequencer strips view */
 static void draw_seq_backdrop(View2D *v2d)
@@ -1595,6 +1584,46 @@ static void seq_draw_sfra_efra(Scene *scene, View2D *v2d)
 	glDisable(GL_BLEND);
 }
 
+/* frames in the cache, mostly rendered ahead by the prefetch job */
+static void seq_draw_cached_frames(const bContext *C, Scene *scene, SpaceSeq *sseq, View2D *v2d)
+{
+	SeqRenderData context;
+	const char *names[2] = {STEREO_LEFT_NAME, STEREO_RIGHT_NAME};
+	const float height = 8.0f * UI_DPI_FAC * BLI_rctf_size_y(&v2d->cur) / BLI_rcti_size_y(&v2d->mask);
+	int frame, start_frame, end_frame, segment_start = 0;
+	bool in_segment = false;
+
+	if (U.prefetchframes == 0 || G.is_rendering) {
+		return;
+	}
+
+	if (!sequencer_render_data_get(CTX_data_main(C), scene, sseq, names[sseq->multiview_eye], &context)) {
+		return;
+	}
+
+	/* only the frames which are prefetched, so redraws don't look up every visible frame */
+	start_frame = max_ii(max_ii(PSFRA, CFRA), (int)v2d->cur.xmin);
+	end_frame = min_ii(min_ii(PEFRA, CFRA + U.prefetchframes), (int)v2d->cur.xmax + 1);
+
+	glEnable(GL_BLEND);
+	glColor4ub(128, 128, 255, 128);
+
+	for (frame = start_frame; frame <= end_frame + 1; frame++) {
+		const bool is_cached = (frame <= end_frame) && BKE_sequencer_is_cached(&context, frame, sseq->chanshown);
+
+		if (is_cached && !in_segment) {
+			segment_start = frame;
+			in_segment = true;
+		}
+		else if (!is_cached && in_segment) {
+			glRectf(segment_start, v2d->cur.ymin, frame, v2d->cur.ymin + height);
+			in_segment = false;
+		}
+	}
+
+	glDisable(GL_BLEND);
+}
+
 /* Draw Timeline/Strip Editor Mode for Sequencer */
 void draw_timeline_seq(const bContext *C, ARegion *ar)
 {
@@ -1646,6 +1675,9 @@ void draw_timeline_seq(const bContext *C, ARegion *ar)
 		
 		/* text draw cached (for sequence names), in pixelspace now */
 		UI_view2d_text_cache_draw(ar);
+
+		UI_view2d_view_ortho(v2d);
+		seq_draw_cached_frames(C, scene, sseq, v2d);
 	}
 	
 	/* current frame */
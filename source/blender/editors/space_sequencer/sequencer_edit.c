@@ -3673,6 +3673,9 @@ static int sequencer_change_effect_type_exec(bContext *C, wmOperator *op)
 		return OPERATOR_CANCELLED;
 	}
 	else {
+		/* the prefetch job might be rendering the effect */
+		BKE_sequencer_prefetch_stop();
+
 		sh = BKE_sequence_get_effect(seq);
 		sh.free(seq);
 
@@ -47,6 +47,7 @@ struct Scene;
 struct Main;
 struct wmOperator;
 struct StripElem;
+struct SeqRenderData;
 
 /* space_sequencer.c */
 struct ARegion *sequencer_has_buttons_region(struct ScrArea *sa);
@@ -64,6 +65,7 @@ void sequencer_special_update_set(Sequence *seq);
 /* UNUSED */
 // void seq_reset_imageofs(struct SpaceSeq *sseq);
 
+bool sequencer_render_data_get(struct Main *bmain, struct Scene *scene, struct SpaceSeq *sseq, const char *viewname, struct SeqRenderData *r_context);
 struct ImBuf *sequencer_ibuf_get(struct Main *bmain, struct Scene *scene, struct SpaceSeq *sseq, int cfra, int frame_ofs, const char *viewname);
 
 /* sequencer_edit.c */
@@ -208,6 +210,9 @@ void SEQUENCER_OT_sample(struct wmOperatorType *ot);
 /* sequencer_preview.c */
 void sequencer_preview_add_sound(const struct bContext *C, struct Sequence *seq);
 
+/* sequencer_prefetch.c */
+void sequencer_prefetch_start(const struct bContext *C, struct Scene *scene, struct SpaceSeq *sseq);
+
 /* sequencer_add */
 int sequencer_image_seq_get_minmax_frame(struct wmOperator *op, int sfra, int *r_minframe, int *r_numdigits);
 void sequencer_image_seq_reserve_frames(struct wmOperator *op, struct StripElem *se, int len, int minframe, int numdigits);
@@ -0,0 +1,104 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2016 Blender Foundation.
+ * All rights reserved.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file blender/editors/space_sequencer/sequencer_prefetch.c
+ *  \ingroup spseq
+ */
+
+#include "DNA_scene_types.h"
+#include "DNA_space_types.h"
+#include "DNA_userdef_types.h"
+
+#include "BLI_utildefines.h"
+
+#include "BKE_context.h"
+#include "BKE_global.h"
+#include "BKE_sequencer.h"
+
+#include "WM_api.h"
+#include "WM_types.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "sequencer_intern.h"
+
+typedef struct PrefetchJob {
+	SeqRenderData context;
+	int num_frames;
+	int chanshown;
+} PrefetchJob;
+
+/* only this runs inside thread */
+static void prefetch_startjob(void *pjv, short *stop, short *do_update, float *progress)
+{
+	PrefetchJob *pj = pjv;
+
+	BKE_sequencer_prefetch(&pj->context, pj->num_frames, pj->chanshown, stop, do_update, progress);
+}
+
+static void prefetch_freejob(void *pjv)
+{
+	PrefetchJob *pj = pjv;
+
+	MEM_freeN(pj);
+}
+
+void sequencer_prefetch_start(const bContext *C, Scene *scene, SpaceSeq *sseq)
+{
+	wmWindowManager *wm = CTX_wm_manager(C);
+	wmJob *wm_job;
+	PrefetchJob *pj;
+	SeqRenderData context;
+	const char *names[2] = {STEREO_LEFT_NAME, STEREO_RIGHT_NAME};
+
+	if (U.prefetchframes == 0 || G.is_rendering) {
+		return;
+	}
+
+	/* the job follows the playhead until all frames ahead are rendered */
+	if (WM_jobs_test(wm, scene, WM_JOB_TYPE_SEQ_PREFETCH)) {
+		return;
+	}
+
+	if (!sequencer_render_data_get(CTX_data_main(C), scene, sseq, names[sseq->multiview_eye], &context)) {
+		return;
+	}
+
+	if (!BKE_sequencer_prefetch_needed(&context, U.prefetchframes, sseq->chanshown)) {
+		return;
+	}
+
+	wm_job = WM_jobs_get(wm, CTX_wm_window(C), scene, "Prefetching",
+	                     0, WM_JOB_TYPE_SEQ_PREFETCH);
+
+	pj = MEM_callocN(sizeof(PrefetchJob), "sequencer prefetch job");
+	pj->context = context;
+	pj->num_frames = U.prefetchframes;
+	pj->chanshown = sseq->chanshown;
+
+	WM_jobs_customdata_set(wm_job, pj, prefetch_freejob);
+	WM_jobs_timer(wm_job, 0.2, NC_SCENE | ND_SEQUENCER, NC_SCENE | ND_SEQUENCER);
+	WM_jobs_callbacks(wm_job, prefetch_startjob, NULL, NULL, NULL);
+
+	WM_jobs_start(wm, wm_job);
+}
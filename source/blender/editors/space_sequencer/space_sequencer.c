@@ -587,6 +587,11 @@ static void sequencer_preview_region_draw(const bContext *C, ARegion *ar)
 			draw_image_seq(C, scene, ar, sseq, scene->r.cfra, over_cfra - scene->r.cfra, true, false);
 	}
 
+	/* render frames ahead during playback */
+	if (ED_screen_animation_playing(wm)) {
+		sequencer_prefetch_start(C, scene, sseq);
+	}
+
 	if ((U.uiflag & USER_SHOW_FPS) && ED_screen_animation_no_scrub(wm)) {
 		rcti rect;
 		ED_region_visible_rect(ar, &rect);
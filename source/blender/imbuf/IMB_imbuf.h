@@ -299,6 +299,10 @@ int ismovie(const char *filepath);
 void IMB_anim_set_preseek(struct anim *anim, int preseek);
 int IMB_anim_get_preseek(struct anim *anim);
 
+/* decode up to the given number of frames ahead in a background thread
+ * while frames are requested in order, zero disables prefetching */
+void IMB_anim_set_prefetch(struct anim *anim, int frames);
+
 /**
  *
  * \attention Defined in anim_movie.c
@@ -360,12 +364,29 @@ void IMB_filtery(struct ImBuf *ibuf);
  */
 struct ImBuf *IMB_onehalf(struct ImBuf *ibuf1);
 
+typedef enum IMB_ScaleFilter {
+	IMB_SCALE_FILTER_BOX = 0,
+	IMB_SCALE_FILTER_BILINEAR,
+	IMB_SCALE_FILTER_BICUBIC,
+	IMB_SCALE_FILTER_LANCZOS
+} IMB_ScaleFilter;
+
 /**
  *
  * \attention Defined in scaling.c
  */
 struct ImBuf *IMB_scaleImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy);
 
+/**
+ * Scale with a separable filter, multi-threaded. Zero keeps the size of the axis.
+ * IMB_scaleImBuf uses a box filter along axes which shrink and a bilinear one along axes which
+ * enlarge, other filters are only used by callers which ask for them.
+ *
+ * \attention Defined in scaling.c
+ */
+struct ImBuf *IMB_scaleImBuf_filter(struct ImBuf *ibuf, unsigned int newx, unsigned int newy,
+                                    IMB_ScaleFilter filter);
+
 /**
  *
  * \attention Defined in scaling.c
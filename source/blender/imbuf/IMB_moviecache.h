@@ -61,6 +61,7 @@ void IMB_moviecache_put(struct MovieCache *cache, void *userkey, struct ImBuf *i
 bool IMB_moviecache_put_if_possible(struct MovieCache *cache, void *userkey, struct ImBuf *ibuf);
 struct ImBuf *IMB_moviecache_get(struct MovieCache *cache, void *userkey);
 bool IMB_moviecache_has_frame(struct MovieCache *cache, void *userkey);
+size_t IMB_moviecache_get_memory_in_use(void);
 void IMB_moviecache_free(struct MovieCache *cache);
 
 void IMB_moviecache_cleanup(struct MovieCache *cache,
@@ -110,6 +110,8 @@
 
 struct _AviMovie;
 struct anim_index;
+struct anim_convert_band;
+struct anim_prefetch;
 
 struct anim {
 	int ib_flags;
@@ -168,7 +170,15 @@ struct anim {
 	int64_t last_pts;
 	int64_t next_pts;
 	AVPacket next_packet;
+
+	/* conversion to RGBA in parallel bands, see ffmpeg_postprocess */
+	struct anim_convert_band *convert_bands;
+	int num_convert_bands;
+
+	/* decoding ahead in a background thread, see IMB_anim_set_prefetch */
+	struct anim_prefetch *prefetch;
 #endif
+	int prefetch_frames;
 
 	char index_dir[768];
 
@@ -182,4 +192,10 @@ struct anim {
 	char suffix[64]; /* MAX_NAME - multiview */
 };
 
+void imb_anim_prefetch_cancel(struct anim *anim);
+
+/* lock the decoder against the prefetch thread, for access to the lazily opened indices */
+void imb_anim_decode_lock(struct anim *anim);
+void imb_anim_decode_unlock(struct anim *anim);
+
 #endif
@@ -67,6 +67,8 @@
 #include "BLI_utildefines.h"
 #include "BLI_string.h"
 #include "BLI_path_util.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "MEM_guardedalloc.h"
 
@@ -90,6 +92,7 @@
 
 #include "IMB_anim.h"
 #include "IMB_indexer.h"
+#include "IMB_moviecache.h"
 
 #ifdef WITH_FFMPEG
 #  include <libavformat/avformat.h>
@@ -448,6 +451,208 @@ BLI_INLINE bool need_aligned_ffmpeg_buffer(struct anim *anim)
 	return (anim->x & 31) != 0;
 }
 
+static struct SwsContext *ffmpeg_convert_context_create(struct anim *anim, int height, int flags)
+{
+	struct SwsContext *convert_ctx;
+
+#ifdef FFMPEG_SWSCALE_COLOR_SPACE_SUPPORT
+	/* The following for color space determination */
+	int srcRange, dstRange, brightness, contrast, saturation;
+	int *table;
+	const int *inv_table;
+#endif
+
+	convert_ctx = sws_getContext(
+	        anim->x,
+	        height,
+	        anim->pCodecCtx->pix_fmt,
+	        anim->x,
+	        height,
+	        AV_PIX_FMT_RGBA,
+	        SWS_FAST_BILINEAR | SWS_FULL_CHR_H_INT | flags,
+	        NULL, NULL, NULL);
+
+	if (!convert_ctx) {
+		return NULL;
+	}
+
+#ifdef FFMPEG_SWSCALE_COLOR_SPACE_SUPPORT
+	/* Try do detect if input has 0-255 YCbCR range (JFIF Jpeg MotionJpeg) */
+	if (!sws_getColorspaceDetails(convert_ctx, (int **)&inv_table, &srcRange,
+	                              &table, &dstRange, &brightness, &contrast, &saturation))
+	{
+		srcRange = srcRange || anim->pCodecCtx->color_range == AVCOL_RANGE_JPEG;
+		inv_table = sws_getCoefficients(anim->pCodecCtx->colorspace);
+
+		if (sws_setColorspaceDetails(convert_ctx, (int *)inv_table, srcRange,
+		                             table, dstRange, brightness, contrast, saturation))
+		{
+			fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
+		}
+	}
+	else {
+		fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
+	}
+#endif
+
+	return convert_ctx;
+}
+
+/* Conversion to RGBA is split in horizontal bands, which are converted in
+ * parallel with a scaler context per band. Every band is converted together
+ * with a few rows of its neighbors, so chroma is interpolated across band
+ * borders as when converting the whole frame at once. */
+
+#define FFMPEG_BAND_MIN_HEIGHT 128
+/* a multiple of the vertical chroma subsampling of all formats */
+#define FFMPEG_BAND_PADDING 16
+
+struct anim_convert_band {
+	struct SwsContext *convert_ctx;
+	int start, height;          /* rows of the frame written by the band */
+	int src_start, src_height;  /* rows converted, including padding */
+	int plane_start[3];         /* first row converted of every plane */
+	uint8_t *buffer;
+	int linesize;
+};
+
+typedef struct ConvertBandsData {
+	struct anim *anim;
+	AVFrame *input;
+	ImBuf *ibuf;
+} ConvertBandsData;
+
+/* vertical chroma subsampling of the planar YUV formats converted in bands,
+ * -1 for other formats */
+static int ffmpeg_convert_bands_chroma_shift(int pix_fmt)
+{
+	switch (pix_fmt) {
+		case AV_PIX_FMT_YUV420P:
+		case AV_PIX_FMT_YUVJ420P:
+		case AV_PIX_FMT_YUV420P10:
+			return 1;
+		case AV_PIX_FMT_YUV422P:
+		case AV_PIX_FMT_YUVJ422P:
+		case AV_PIX_FMT_YUV422P10:
+		case AV_PIX_FMT_YUV444P:
+		case AV_PIX_FMT_YUVJ444P:
+		case AV_PIX_FMT_YUV444P10:
+			return 0;
+		default:
+			return -1;
+	}
+}
+
+static void ffmpeg_convert_bands_free(struct anim *anim)
+{
+	int i;
+
+	for (i = 0; i < anim->num_convert_bands; i++) {
+		struct anim_convert_band *band = &anim->convert_bands[i];
+
+		if (band->convert_ctx) {
+			sws_freeContext(band->convert_ctx);
+		}
+		av_free(band->buffer);
+	}
+
+	MEM_SAFE_FREE(anim->convert_bands);
+	anim->num_convert_bands = 0;
+}
+
+static void ffmpeg_convert_bands_init(struct anim *anim)
+{
+	int chroma_shift = ffmpeg_convert_bands_chroma_shift(anim->pCodecCtx->pix_fmt);
+	int num_bands = MIN2(BLI_system_thread_count(), anim->y / FFMPEG_BAND_MIN_HEIGHT);
+	int band_height, i;
+
+	anim->convert_bands = NULL;
+	anim->num_convert_bands = 0;
+
+	if (chroma_shift == -1 || num_bands < 2) {
+		return;
+	}
+
+	band_height = (anim->y + num_bands - 1) / num_bands;
+	band_height = (band_height + FFMPEG_BAND_PADDING - 1) & ~(FFMPEG_BAND_PADDING - 1);
+	num_bands = (anim->y + band_height - 1) / band_height;
+
+	anim->convert_bands = MEM_callocN(sizeof(*anim->convert_bands) * num_bands, "ffmpeg convert bands");
+	anim->num_convert_bands = num_bands;
+
+	for (i = 0; i < num_bands; i++) {
+		struct anim_convert_band *band = &anim->convert_bands[i];
+		int src_end;
+
+		band->start = i * band_height;
+		band->height = MIN2(band_height, anim->y - band->start);
+		band->src_start = MAX2(band->start - FFMPEG_BAND_PADDING, 0);
+		src_end = MIN2(band->start + band->height + FFMPEG_BAND_PADDING, anim->y);
+		band->src_height = src_end - band->src_start;
+
+		band->plane_start[0] = band->src_start;
+		band->plane_start[1] = band->src_start >> chroma_shift;
+		band->plane_start[2] = band->src_start >> chroma_shift;
+
+		band->linesize = (anim->x * 4 + 31) & ~31;
+		band->buffer = av_malloc((size_t)band->linesize * band->src_height);
+		band->convert_ctx = ffmpeg_convert_context_create(anim, band->src_height, 0);
+
+		if (!band->buffer || !band->convert_ctx) {
+			/* convert the whole frame at once */
+			ffmpeg_convert_bands_free(anim);
+			return;
+		}
+	}
+}
+
+static void ffmpeg_convert_band_task(TaskPool * __restrict pool, void *taskdata, int UNUSED(threadid))
+{
+	ConvertBandsData *data = BLI_task_pool_userdata(pool);
+	struct anim_convert_band *band = taskdata;
+	struct anim *anim = data->anim;
+	AVFrame *input = data->input;
+	const uint8_t *src[4] = {NULL, NULL, NULL, NULL};
+	uint8_t *dst[4] = {band->buffer, NULL, NULL, NULL};
+	int dstStride[4] = {band->linesize, 0, 0, 0};
+	unsigned char *rect = (unsigned char *) data->ibuf->rect;
+	int i, y;
+
+	for (i = 0; i < 3; i++) {
+		src[i] = input->data[i] + band->plane_start[i] * input->linesize[i];
+	}
+
+	sws_scale(band->convert_ctx, src, input->linesize, 0, band->src_height, dst, dstStride);
+
+	/* flip, the first row of the frame is the last row of the image */
+	for (y = band->start; y < band->start + band->height; y++) {
+		memcpy(rect + (size_t)(anim->y - 1 - y) * anim->x * 4,
+		       band->buffer + (size_t)(y - band->src_start) * band->linesize,
+		       anim->x * 4);
+	}
+}
+
+static void ffmpeg_convert_bands(struct anim *anim, AVFrame *input, ImBuf *ibuf)
+{
+	TaskScheduler *task_scheduler = BLI_task_scheduler_get();
+	TaskPool *task_pool;
+	ConvertBandsData data;
+	int i;
+
+	data.anim = anim;
+	data.input = input;
+	data.ibuf = ibuf;
+
+	task_pool = BLI_task_pool_create(task_scheduler, &data);
+
+	for (i = 0; i < anim->num_convert_bands; i++) {
+		BLI_task_pool_push(task_pool, ffmpeg_convert_band_task, &anim->convert_bands[i], false, TASK_PRIORITY_LOW);
+	}
+
+	BLI_task_pool_work_and_wait(task_pool);
+	BLI_task_pool_free(task_pool);
+}
+
 static int startffmpeg(struct anim *anim)
 {
 	int i, videoStream;
@@ -460,13 +665,6 @@ static int startffmpeg(struct anim *anim)
 	double frs_den;
 	int streamcount;
 
-#ifdef FFMPEG_SWSCALE_COLOR_SPACE_SUPPORT
-	/* The following for color space determination */
-	int srcRange, dstRange, brightness, contrast, saturation;
-	int *table;
-	const int *inv_table;
-#endif
-
 	if (anim == NULL) return(-1);
 
 	streamcount = anim->streamindex;
@@ -512,6 +710,10 @@ static int startffmpeg(struct anim *anim)
 
 	pCodecCtx->workaround_bugs = 1;
 
+	/* decode several frames or slices of a frame at once */
+	pCodecCtx->thread_count = BLI_system_thread_count();
+	pCodecCtx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+
 	if (avcodec_open2(pCodecCtx, pCodec, NULL) < 0) {
 		avformat_close_input(&pFormatCtx);
 		return -1;
@@ -615,16 +817,8 @@ static int startffmpeg(struct anim *anim)
 		anim->preseek = 0;
 	}
 	
-	anim->img_convert_ctx = sws_getContext(
-	        anim->x,
-	        anim->y,
-	        anim->pCodecCtx->pix_fmt,
-	        anim->x,
-	        anim->y,
-	        AV_PIX_FMT_RGBA,
-	        SWS_FAST_BILINEAR | SWS_PRINT_INFO | SWS_FULL_CHR_H_INT,
-	        NULL, NULL, NULL);
-		
+	anim->img_convert_ctx = ffmpeg_convert_context_create(anim, anim->y, SWS_PRINT_INFO);
+
 	if (!anim->img_convert_ctx) {
 		fprintf(stderr,
 		        "Can't transform color space??? Bailing out...\n");
@@ -637,77 +831,15 @@ static int startffmpeg(struct anim *anim)
 		return -1;
 	}
 
-#ifdef FFMPEG_SWSCALE_COLOR_SPACE_SUPPORT
-	/* Try do detect if input has 0-255 YCbCR range (JFIF Jpeg MotionJpeg) */
-	if (!sws_getColorspaceDetails(anim->img_convert_ctx, (int **)&inv_table, &srcRange,
-	                              &table, &dstRange, &brightness, &contrast, &saturation))
-	{
-		srcRange = srcRange || anim->pCodecCtx->color_range == AVCOL_RANGE_JPEG;
-		inv_table = sws_getCoefficients(anim->pCodecCtx->colorspace);
+	ffmpeg_convert_bands_init(anim);
 
-		if (sws_setColorspaceDetails(anim->img_convert_ctx, (int *)inv_table, srcRange,
-		                             table, dstRange, brightness, contrast, saturation))
-		{
-			fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
-		}
-	}
-	else {
-		fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
-	}
-#endif
-		
 	return (0);
 }
 
-/* postprocess the image in anim->pFrame and do color conversion
- * and deinterlacing stuff.
- *
- * Output is anim->last_frame
- */
+/* convert the whole frame at once */
 
-static void ffmpeg_postprocess(struct anim *anim)
+static void ffmpeg_convert(struct anim *anim, AVFrame *input, ImBuf *ibuf)
 {
-	AVFrame *input = anim->pFrame;
-	ImBuf *ibuf = anim->last_frame;
-	int filter_y = 0;
-
-	if (!anim->pFrameComplete) {
-		return;
-	}
-
-	/* This means the data wasnt read properly, 
-	 * this check stops crashing */
-	if (input->data[0] == 0 && input->data[1] == 0 &&
-	    input->data[2] == 0 && input->data[3] == 0)
-	{
-		fprintf(stderr, "ffmpeg_fetchibuf: "
-		        "data not read properly...\n");
-		return;
-	}
-
-	av_log(anim->pFormatCtx, AV_LOG_DEBUG, 
-	       "  POSTPROC: anim->pFrame planes: %p %p %p %p\n",
-	       input->data[0], input->data[1], input->data[2],
-	       input->data[3]);
-
-
-	if (anim->ib_flags & IB_animdeinterlace) {
-		if (avpicture_deinterlace(
-		        (AVPicture *)
-		        anim->pFrameDeinterlaced,
-		        (const AVPicture *)
-		        anim->pFrame,
-		        anim->pCodecCtx->pix_fmt,
-		        anim->pCodecCtx->width,
-		        anim->pCodecCtx->height) < 0)
-		{
-			filter_y = true;
-		}
-		else {
-			input = anim->pFrameDeinterlaced;
-		}
-	}
-
 	if (!need_aligned_ffmpeg_buffer(anim)) {
 		avpicture_fill((AVPicture *) anim->pFrameRGB,
 		               (unsigned char *) ibuf->rect,
@@ -786,6 +918,63 @@ static void ffmpeg_postprocess(struct anim *anim)
 			src += anim->pFrameRGB->linesize[0];
 		}
 	}
+}
+
+/* postprocess the image in anim->pFrame and do color conversion
+ * and deinterlacing stuff.
+ *
+ * Output is anim->last_frame
+ */
+
+static void ffmpeg_postprocess(struct anim *anim)
+{
+	AVFrame *input = anim->pFrame;
+	ImBuf *ibuf = anim->last_frame;
+	int filter_y = 0;
+
+	if (!anim->pFrameComplete) {
+		return;
+	}
+
+	/* This means the data wasnt read properly, 
+	 * this check stops crashing */
+	if (input->data[0] == 0 && input->data[1] == 0 &&
+	    input->data[2] == 0 && input->data[3] == 0)
+	{
+		fprintf(stderr, "ffmpeg_fetchibuf: "
+		        "data not read properly...\n");
+		return;
+	}
+
+	av_log(anim->pFormatCtx, AV_LOG_DEBUG, 
+	       "  POSTPROC: anim->pFrame planes: %p %p %p %p\n",
+	       input->data[0], input->data[1], input->data[2],
+	       input->data[3]);
+
+
+	if (anim->ib_flags & IB_animdeinterlace) {
+		if (avpicture_deinterlace(
+		        (AVPicture *)
+		        anim->pFrameDeinterlaced,
+		        (const AVPicture *)
+		        anim->pFrame,
+		        anim->pCodecCtx->pix_fmt,
+		        anim->pCodecCtx->width,
+		        anim->pCodecCtx->height) < 0)
+		{
+			filter_y = true;
+		}
+		else {
+			input = anim->pFrameDeinterlaced;
+		}
+	}
+
+	if (anim->num_convert_bands) {
+		ffmpeg_convert_bands(anim, input, ibuf);
+	}
+	else {
+		ffmpeg_convert(anim, input, ibuf);
+	}
 
 	if (filter_y) {
 		IMB_filtery(ibuf);
@@ -1161,10 +1350,259 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 	return anim->last_frame;
 }
 
+/* Prefetching
+ *
+ * While frames are requested in order, a background thread decodes the frames
+ * following the requested one into a cache, in parallel with whatever is done
+ * with the requested frame. The decoder is shared by the thread and callers of
+ * IMB_anim_absolute, decode_mutex is locked while it is in use. It also guards
+ * the time code indices, which the decoder opens on demand. */
+
+typedef struct AnimPrefetchKey {
+	int position;
+	int tc;
+} AnimPrefetchKey;
+
+struct anim_prefetch {
+	ListBase threads;
+	ThreadMutex decode_mutex;
+	ThreadMutex mutex;          /* for the members below */
+	ThreadCondition cond;
+	struct MovieCache *cache;
+	int last_position;          /* last requested frame */
+	int last_tc;
+	int position;               /* next frame to decode ahead, -1 when idle */
+	bool stop;
+};
+
+static unsigned int anim_prefetch_hashhash(const void *key_v)
+{
+	const AnimPrefetchKey *key = key_v;
+
+	return key->position;
+}
+
+static bool anim_prefetch_hashcmp(const void *a_v, const void *b_v)
+{
+	const AnimPrefetchKey *a = a_v;
+	const AnimPrefetchKey *b = b_v;
+
+	return ((a->position != b->position) ||
+	        (a->tc != b->tc));
+}
+
+static struct MovieCache *anim_prefetch_cache_create(void)
+{
+	return IMB_moviecache_create("anim prefetch", sizeof(AnimPrefetchKey),
+	                             anim_prefetch_hashhash, anim_prefetch_hashcmp);
+}
+
+static bool anim_prefetch_check_unused(ImBuf *UNUSED(ibuf), void *userkey, void *userdata)
+{
+	const AnimPrefetchKey *key = userkey;
+	const struct anim *anim = userdata;
+	const struct anim_prefetch *prefetch = anim->prefetch;
+
+	/* keep the last requested frame and the frames ahead of it */
+	return ((key->tc != prefetch->last_tc) ||
+	        (key->position < prefetch->last_position) ||
+	        (key->position > prefetch->last_position + anim->prefetch_frames));
+}
+
+static bool anim_prefetch_has_frame(struct anim_prefetch *prefetch, AnimPrefetchKey *key)
+{
+	/* frames may have been freed by the cache limiter */
+	ImBuf *ibuf = IMB_moviecache_get(prefetch->cache, key);
+
+	if (ibuf) {
+		IMB_freeImBuf(ibuf);
+		return true;
+	}
+
+	return false;
+}
+
+static void *anim_prefetch_thread(void *anim_v)
+{
+	struct anim *anim = anim_v;
+	struct anim_prefetch *prefetch = anim->prefetch;
+
+	BLI_mutex_lock(&prefetch->mutex);
+
+	while (!prefetch->stop) {
+		AnimPrefetchKey key;
+		ImBuf *ibuf;
+
+		if (prefetch->position == -1) {
+			BLI_condition_wait(&prefetch->cond, &prefetch->mutex);
+			continue;
+		}
+
+		key.position = prefetch->position;
+		key.tc = prefetch->last_tc;
+
+		if ((key.position >= anim->duration) ||
+		    (key.position > prefetch->last_position + anim->prefetch_frames))
+		{
+			prefetch->position = -1;
+			continue;
+		}
+
+		if (anim_prefetch_has_frame(prefetch, &key)) {
+			prefetch->position++;
+			continue;
+		}
+
+		BLI_mutex_unlock(&prefetch->mutex);
+
+		BLI_mutex_lock(&prefetch->decode_mutex);
+		BLI_mutex_lock(&prefetch->mutex);
+
+		if (prefetch->position != key.position || prefetch->last_tc != key.tc) {
+			/* another frame was requested while waiting for the decoder */
+			BLI_mutex_unlock(&prefetch->decode_mutex);
+			continue;
+		}
+
+		BLI_mutex_unlock(&prefetch->mutex);
+		ibuf = ffmpeg_fetchibuf(anim, key.position, key.tc);
+
+		/* store the frame before anyone else uses the decoder, so
+		 * imb_anim_prefetch_cancel can't miss it */
+		BLI_mutex_lock(&prefetch->mutex);
+		BLI_mutex_unlock(&prefetch->decode_mutex);
+
+		if (ibuf) {
+			IMB_moviecache_put(prefetch->cache, &key, ibuf);
+			IMB_freeImBuf(ibuf);
+		}
+
+		/* continue unless another frame was requested meanwhile */
+		if (prefetch->position == key.position && prefetch->last_tc == key.tc) {
+			prefetch->position = (ibuf) ? key.position + 1 : -1;
+		}
+	}
+
+	BLI_mutex_unlock(&prefetch->mutex);
+
+	return NULL;
+}
+
+static struct anim_prefetch *anim_prefetch_ensure(struct anim *anim)
+{
+	struct anim_prefetch *prefetch = anim->prefetch;
+
+	if (prefetch == NULL) {
+		prefetch = MEM_callocN(sizeof(*prefetch), "anim prefetch");
+
+		BLI_mutex_init(&prefetch->decode_mutex);
+		BLI_mutex_init(&prefetch->mutex);
+		BLI_condition_init(&prefetch->cond);
+		prefetch->cache = anim_prefetch_cache_create();
+		prefetch->last_position = -1;
+		prefetch->last_tc = IMB_TC_NONE;
+		prefetch->position = -1;
+
+		anim->prefetch = prefetch;
+
+		BLI_init_threads(&prefetch->threads, anim_prefetch_thread, 1);
+		BLI_insert_thread(&prefetch->threads, anim);
+	}
+
+	return prefetch;
+}
+
+static void anim_prefetch_free(struct anim *anim)
+{
+	struct anim_prefetch *prefetch = anim->prefetch;
+
+	if (prefetch == NULL) {
+		return;
+	}
+
+	BLI_mutex_lock(&prefetch->mutex);
+	prefetch->stop = true;
+	BLI_condition_notify_one(&prefetch->cond);
+	BLI_mutex_unlock(&prefetch->mutex);
+
+	BLI_end_threads(&prefetch->threads);
+
+	IMB_moviecache_free(prefetch->cache);
+	BLI_condition_end(&prefetch->cond);
+	BLI_mutex_end(&prefetch->mutex);
+	BLI_mutex_end(&prefetch->decode_mutex);
+
+	MEM_freeN(prefetch);
+	anim->prefetch = NULL;
+}
+
+static ImBuf *ffmpeg_fetchibuf_prefetch(struct anim *anim, int position,
+                                        IMB_Timecode_Type tc)
+{
+	struct anim_prefetch *prefetch = anim_prefetch_ensure(anim);
+	AnimPrefetchKey key;
+	ImBuf *ibuf;
+	bool in_order;
+
+	key.position = position;
+	key.tc = tc;
+
+	BLI_mutex_lock(&prefetch->mutex);
+
+	in_order = (tc == prefetch->last_tc &&
+	            position > prefetch->last_position &&
+	            position <= prefetch->last_position + anim->prefetch_frames);
+
+	prefetch->last_position = position;
+	prefetch->last_tc = tc;
+
+	ibuf = IMB_moviecache_get(prefetch->cache, &key);
+
+	if (ibuf == NULL) {
+		/* the thread may be decoding the frame right now, wait for the decoder
+		 * and look again before decoding it here */
+		prefetch->position = -1;
+		BLI_mutex_unlock(&prefetch->mutex);
+
+		BLI_mutex_lock(&prefetch->decode_mutex);
+		BLI_mutex_lock(&prefetch->mutex);
+
+		ibuf = IMB_moviecache_get(prefetch->cache, &key);
+
+		if (ibuf == NULL) {
+			BLI_mutex_unlock(&prefetch->mutex);
+			ibuf = ffmpeg_fetchibuf(anim, position, tc);
+			BLI_mutex_lock(&prefetch->mutex);
+
+			if (ibuf) {
+				IMB_moviecache_put(prefetch->cache, &key, ibuf);
+			}
+		}
+
+		BLI_mutex_unlock(&prefetch->decode_mutex);
+	}
+
+	IMB_moviecache_cleanup(prefetch->cache, anim_prefetch_check_unused, anim);
+
+	if (in_order) {
+		prefetch->position = position + 1;
+		BLI_condition_notify_one(&prefetch->cond);
+	}
+	else {
+		prefetch->position = -1;
+	}
+
+	BLI_mutex_unlock(&prefetch->mutex);
+
+	return ibuf;
+}
+
 static void free_anim_ffmpeg(struct anim *anim)
 {
 	if (anim == NULL) return;
 
+	anim_prefetch_free(anim);
+
 	if (anim->pCodecCtx) {
 		avcodec_close(anim->pCodecCtx);
 		avformat_close_input(&anim->pFormatCtx);
@@ -1191,6 +1629,7 @@ static void free_anim_ffmpeg(struct anim *anim)
 		av_frame_free(&anim->pFrameDeinterlaced);
 
 		sws_freeContext(anim->img_convert_ctx);
+		ffmpeg_convert_bands_free(anim);
 		IMB_freeImBuf(anim->last_frame);
 		if (anim->next_packet.stream_index != -1) {
 			av_free_packet(&anim->next_packet);
@@ -1310,6 +1749,8 @@ struct ImBuf *IMB_anim_absolute(struct anim *anim, int position,
 		struct anim *proxy = IMB_anim_open_proxy(anim, preview_size);
 
 		if (proxy) {
+			IMB_anim_set_prefetch(proxy, anim->prefetch_frames);
+
 			position = IMB_anim_index_get_frame_index(
 			    anim, tc, position);
 
@@ -1360,9 +1801,12 @@ struct ImBuf *IMB_anim_absolute(struct anim *anim, int position,
 #endif
 #ifdef WITH_FFMPEG
 		case ANIM_FFMPEG:
-			ibuf = ffmpeg_fetchibuf(anim, position, tc);
-			if (ibuf)
-				anim->curposition = position;
+			if (anim->prefetch_frames > 0) {
+				ibuf = ffmpeg_fetchibuf_prefetch(anim, position, tc);
+			}
+			else {
+				ibuf = ffmpeg_fetchibuf(anim, position, tc);
+			}
 			filter_y = 0; /* done internally */
 			break;
 #endif
@@ -1370,7 +1814,7 @@ struct ImBuf *IMB_anim_absolute(struct anim *anim, int position,
 
 	if (ibuf) {
 		if (filter_y) IMB_filtery(ibuf);
-		BLI_snprintf(ibuf->name, sizeof(ibuf->name), "%s.%04d", anim->name, anim->curposition + 1);
+		BLI_snprintf(ibuf->name, sizeof(ibuf->name), "%s.%04d", anim->name, position + 1);
 		
 	}
 	return(ibuf);
@@ -1381,16 +1825,20 @@ struct ImBuf *IMB_anim_absolute(struct anim *anim, int position,
 int IMB_anim_get_duration(struct anim *anim, IMB_Timecode_Type tc)
 {
 	struct anim_index *idx;
+	int duration;
+
 	if (tc == IMB_TC_NONE) {
 		return anim->duration;
 	}
-	
+
+	imb_anim_decode_lock(anim);
+
 	idx = IMB_anim_open_index(anim, tc);
-	if (!idx) {
-		return anim->duration;
-	}
+	duration = (idx) ? IMB_indexer_get_duration(idx) : anim->duration;
+
+	imb_anim_decode_unlock(anim);
 
-	return IMB_indexer_get_duration(idx);
+	return duration;
 }
 
 bool IMB_anim_get_fps(struct anim *anim,
@@ -1420,3 +1868,57 @@ int IMB_anim_get_preseek(struct anim *anim)
 {
 	return anim->preseek;
 }
+
+void IMB_anim_set_prefetch(struct anim *anim, int frames)
+{
+	if (anim->prefetch_frames != frames) {
+		/* the decoder is used without locking when prefetching is disabled */
+		imb_anim_prefetch_cancel(anim);
+		anim->prefetch_frames = frames;
+	}
+}
+
+void imb_anim_decode_lock(struct anim *anim)
+{
+#ifdef WITH_FFMPEG
+	if (anim->prefetch) {
+		BLI_mutex_lock(&anim->prefetch->decode_mutex);
+	}
+#else
+	UNUSED_VARS(anim);
+#endif
+}
+
+void imb_anim_decode_unlock(struct anim *anim)
+{
+#ifdef WITH_FFMPEG
+	if (anim->prefetch) {
+		BLI_mutex_unlock(&anim->prefetch->decode_mutex);
+	}
+#else
+	UNUSED_VARS(anim);
+#endif
+}
+
+void imb_anim_prefetch_cancel(struct anim *anim)
+{
+#ifdef WITH_FFMPEG
+	struct anim_prefetch *prefetch = anim->prefetch;
+
+	if (prefetch) {
+		/* wait for the frame being decoded and forget all frames */
+		BLI_mutex_lock(&prefetch->decode_mutex);
+		BLI_mutex_lock(&prefetch->mutex);
+
+		prefetch->position = -1;
+		prefetch->last_position = -1;
+		IMB_moviecache_free(prefetch->cache);
+		prefetch->cache = anim_prefetch_cache_create();
+
+		BLI_mutex_unlock(&prefetch->mutex);
+		BLI_mutex_unlock(&prefetch->decode_mutex);
+	}
+#else
+	UNUSED_VARS(anim);
+#endif
+}
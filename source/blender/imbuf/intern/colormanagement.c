@@ -108,6 +108,42 @@ typedef struct ColormanageProcessor {
 	bool is_data_result;
 } ColormanageProcessor;
 
+/* Display processors are cached, creating them is expensive for views with looks
+ * and LUTs and a new one is requested for every tile of partial buffer updates.
+ * Processors which are in use are never freed, least recently used otherwise.
+ */
+#define DISPLAY_PROCESSOR_CACHE_SIZE 8
+
+typedef struct DisplayProcessorCacheItem {
+	char look[MAX_COLORSPACE_NAME];
+	char view_transform[MAX_COLORSPACE_NAME];
+	char display[MAX_COLORSPACE_NAME];
+	char from_colorspace[MAX_COLORSPACE_NAME];
+	float exposure;
+	float gamma;
+
+	OCIO_ConstProcessorRcPtr *processor;
+	int users;
+	unsigned int last_used;
+} DisplayProcessorCacheItem;
+
+static DisplayProcessorCacheItem display_processor_cache[DISPLAY_PROCESSOR_CACHE_SIZE];
+static unsigned int display_processor_cache_time = 0;
+
+static void display_processor_cache_free(void)
+{
+	int i;
+
+	for (i = 0; i < DISPLAY_PROCESSOR_CACHE_SIZE; i++) {
+		DisplayProcessorCacheItem *item = &display_processor_cache[i];
+
+		if (item->processor)
+			OCIO_processorRelease(item->processor);
+	}
+
+	memset(display_processor_cache, 0, sizeof(display_processor_cache));
+}
+
 static struct global_glsl_state {
 	/* Actual processor used for GLSL baked LUTs. */
 	OCIO_ConstProcessorRcPtr *processor;
@@ -696,6 +732,8 @@ void colormanagement_exit(void)
 	if (global_glsl_state.transform_ocio_glsl_state)
 		OCIO_freeOGLState(global_glsl_state.transform_ocio_glsl_state);
 
+	display_processor_cache_free();
+
 	colormanage_free_config();
 }
 
@@ -828,6 +866,94 @@ static OCIO_ConstProcessorRcPtr *create_display_buffer_processor(const char *loo
 	return processor;
 }
 
+static OCIO_ConstProcessorRcPtr *display_processor_cache_acquire(const char *look,
+                                                                 const char *view_transform,
+                                                                 const char *display,
+                                                                 float exposure, float gamma,
+                                                                 const char *from_colorspace)
+{
+	DisplayProcessorCacheItem *free_item = NULL;
+	OCIO_ConstProcessorRcPtr *processor;
+	int i;
+
+	BLI_mutex_lock(&processor_lock);
+
+	for (i = 0; i < DISPLAY_PROCESSOR_CACHE_SIZE; i++) {
+		DisplayProcessorCacheItem *item = &display_processor_cache[i];
+
+		if (item->processor == NULL) {
+			if (free_item == NULL || free_item->processor)
+				free_item = item;
+		}
+		else if (item->exposure == exposure &&
+		         item->gamma == gamma &&
+		         STREQ(item->look, look) &&
+		         STREQ(item->view_transform, view_transform) &&
+		         STREQ(item->display, display) &&
+		         STREQ(item->from_colorspace, from_colorspace))
+		{
+			item->users++;
+			item->last_used = ++display_processor_cache_time;
+
+			BLI_mutex_unlock(&processor_lock);
+
+			return item->processor;
+		}
+		else if (item->users == 0) {
+			if (free_item == NULL || (free_item->processor && item->last_used < free_item->last_used))
+				free_item = item;
+		}
+	}
+
+	processor = create_display_buffer_processor(look, view_transform, display, exposure, gamma, from_colorspace);
+
+	/* when all cached processors are in use the new one is not cached */
+	if (processor && free_item) {
+		if (free_item->processor)
+			OCIO_processorRelease(free_item->processor);
+
+		BLI_strncpy(free_item->look, look, MAX_COLORSPACE_NAME);
+		BLI_strncpy(free_item->view_transform, view_transform, MAX_COLORSPACE_NAME);
+		BLI_strncpy(free_item->display, display, MAX_COLORSPACE_NAME);
+		BLI_strncpy(free_item->from_colorspace, from_colorspace, MAX_COLORSPACE_NAME);
+		free_item->exposure = exposure;
+		free_item->gamma = gamma;
+
+		free_item->processor = processor;
+		free_item->users = 1;
+		free_item->last_used = ++display_processor_cache_time;
+	}
+
+	BLI_mutex_unlock(&processor_lock);
+
+	return processor;
+}
+
+/* release processor acquired from the cache, processors which are not cached are freed */
+static void display_processor_cache_release(OCIO_ConstProcessorRcPtr *processor)
+{
+	int i;
+
+	BLI_mutex_lock(&processor_lock);
+
+	for (i = 0; i < DISPLAY_PROCESSOR_CACHE_SIZE; i++) {
+		DisplayProcessorCacheItem *item = &display_processor_cache[i];
+
+		if (item->processor == processor) {
+			BLI_assert(item->users > 0);
+			item->users--;
+
+			BLI_mutex_unlock(&processor_lock);
+
+			return;
+		}
+	}
+
+	BLI_mutex_unlock(&processor_lock);
+
+	OCIO_processorRelease(processor);
+}
+
 static OCIO_ConstProcessorRcPtr *create_colorspace_transform_processor(const char *from_colorspace,
                                                                        const char *to_colorspace)
 {
@@ -1310,6 +1436,23 @@ static void display_buffer_init_handle(void *handle_v, int start_line, int tot_l
 	handle->float_colorspace = init_data->float_colorspace;
 }
 
+/* convert part of the buffer to scene linear using processor cached in the color space,
+ * creating a new processor for every thread's part of the buffer is rather expensive
+ */
+static void display_buffer_to_scene_linear(float *buffer, int width, int height, int channels,
+                                           const char *from_colorspace, bool predivide)
+{
+	ColorSpace *colorspace;
+
+	if (from_colorspace[0] == '\0' || STREQ(from_colorspace, global_role_scene_linear)) {
+		return;
+	}
+
+	colorspace = colormanage_colorspace_get_named(from_colorspace);
+
+	IMB_colormanagement_colorspace_to_scene_linear(buffer, width, height, channels, colorspace, predivide);
+}
+
 static void display_buffer_apply_get_linear_buffer(DisplayBufferThread *handle, int height,
                                                    float *linear_buffer, bool *is_straight_alpha)
 {
@@ -1325,7 +1468,6 @@ static void display_buffer_apply_get_linear_buffer(DisplayBufferThread *handle,
 		unsigned char *byte_buffer = handle->byte_buffer;
 
 		const char *from_colorspace = handle->byte_colorspace;
-		const char *to_colorspace = global_role_scene_linear;
 
 		float *fp;
 		unsigned char *cp;
@@ -1350,8 +1492,7 @@ static void display_buffer_apply_get_linear_buffer(DisplayBufferThread *handle,
 
 		if (!is_data && !is_data_display) {
 			/* convert float buffer to scene linear space */
-			IMB_colormanagement_transform(linear_buffer, width, height, channels,
-			                              from_colorspace, to_colorspace, false);
+			display_buffer_to_scene_linear(linear_buffer, width, height, channels, from_colorspace, false);
 		}
 
 		*is_straight_alpha = true;
@@ -1364,13 +1505,11 @@ static void display_buffer_apply_get_linear_buffer(DisplayBufferThread *handle,
 		 */
 
 		const char *from_colorspace = handle->float_colorspace;
-		const char *to_colorspace = global_role_scene_linear;
 
 		memcpy(linear_buffer, handle->buffer, buffer_size * sizeof(float));
 
 		if (!is_data && !is_data_display) {
-			IMB_colormanagement_transform(linear_buffer, width, height, channels,
-			                              from_colorspace, to_colorspace, true);
+			display_buffer_to_scene_linear(linear_buffer, width, height, channels, from_colorspace, true);
 		}
 
 		*is_straight_alpha = false;
@@ -2609,12 +2748,181 @@ void IMB_colormanagement_colorspace_items_add(EnumPropertyItem **items, int *tot
  * the rest buffers would be marked as dirty
  */
 
+typedef struct PartialBufferUpdateThread {
+	ColormanageProcessor *cm_processor;
+	unsigned char *display_buffer;
+	float *display_buffer_float;
+	const float *linear_buffer;
+	const unsigned char *byte_buffer;
+	ColorSpace *rect_colorspace;
+
+	int display_stride;
+	int linear_stride;
+	int linear_offset_x;
+	int linear_offset_y;
+
+	int xmin, xmax;
+	int ymin, ymax;
+
+	int channels;
+	bool is_data;
+} PartialBufferUpdateThread;
+
+typedef struct PartialBufferUpdateInitData {
+	ColormanageProcessor *cm_processor;
+	unsigned char *display_buffer;
+	float *display_buffer_float;
+	const float *linear_buffer;
+	const unsigned char *byte_buffer;
+	ColorSpace *rect_colorspace;
+
+	int display_stride;
+	int linear_stride;
+	int linear_offset_x;
+	int linear_offset_y;
+
+	int xmin, ymin;
+	int width;
+
+	int channels;
+	bool is_data;
+} PartialBufferUpdateInitData;
+
+static void partial_buffer_update_init_handle(void *handle_v, int start_line, int tot_line, void *init_data_v)
+{
+	PartialBufferUpdateThread *handle = (PartialBufferUpdateThread *) handle_v;
+	PartialBufferUpdateInitData *init_data = (PartialBufferUpdateInitData *) init_data_v;
+
+	handle->cm_processor = init_data->cm_processor;
+	handle->display_buffer = init_data->display_buffer;
+	handle->display_buffer_float = NULL;
+	handle->linear_buffer = init_data->linear_buffer;
+	handle->byte_buffer = init_data->byte_buffer;
+	handle->rect_colorspace = init_data->rect_colorspace;
+
+	handle->display_stride = init_data->display_stride;
+	handle->linear_stride = init_data->linear_stride;
+	handle->linear_offset_x = init_data->linear_offset_x;
+	handle->linear_offset_y = init_data->linear_offset_y;
+
+	handle->xmin = init_data->xmin;
+	handle->xmax = init_data->xmin + init_data->width;
+	handle->ymin = init_data->ymin + start_line;
+	handle->ymax = handle->ymin + tot_line;
+
+	handle->channels = init_data->channels;
+	handle->is_data = init_data->is_data;
+
+	if (init_data->display_buffer_float) {
+		handle->display_buffer_float = init_data->display_buffer_float +
+		                               (size_t)init_data->channels * init_data->width * start_line;
+	}
+}
+
+static void *do_partial_buffer_update_thread(void *handle_v)
+{
+	PartialBufferUpdateThread *handle = (PartialBufferUpdateThread *) handle_v;
+	ColormanageProcessor *cm_processor = handle->cm_processor;
+	unsigned char *display_buffer = handle->display_buffer;
+	const float *linear_buffer = handle->linear_buffer;
+	const unsigned char *byte_buffer = handle->byte_buffer;
+	const int channels = handle->channels;
+	const int xmin = handle->xmin, xmax = handle->xmax;
+	const int ymin = handle->ymin, ymax = handle->ymax;
+	const int width = xmax - xmin;
+	const int height = ymax - ymin;
+	float *buffer;
+	int x, y;
+
+	/* pixels are gathered first so the processor is applied to all lines
+	 * of the thread at once, which is much faster than pixel by pixel
+	 * the dither buffer is used directly when it's needed
+	 */
+	if (handle->display_buffer_float) {
+		buffer = handle->display_buffer_float;
+	}
+	else {
+		buffer = MEM_mallocN((size_t)channels * width * height * sizeof(float), "partial update buffer");
+	}
+
+	for (y = ymin; y < ymax; y++) {
+		for (x = xmin; x < xmax; x++) {
+			size_t linear_index = ((size_t)(y - handle->linear_offset_y) * handle->linear_stride +
+			                       (x - handle->linear_offset_x)) * channels;
+			float *fp = buffer + ((size_t)(y - ymin) * width + (x - xmin)) * channels;
+			float pixel[4];
+
+			if (linear_buffer) {
+				if (channels == 4) {
+					copy_v4_v4(fp, linear_buffer + linear_index);
+				}
+				else if (channels == 3) {
+					copy_v3_v3(fp, linear_buffer + linear_index);
+				}
+				else if (channels == 1) {
+					fp[0] = linear_buffer[linear_index];
+				}
+				else {
+					BLI_assert(!"Unsupported number of channels in partial buffer update");
+				}
+			}
+			else if (byte_buffer) {
+				rgba_uchar_to_float(pixel, byte_buffer + linear_index);
+				IMB_colormanagement_colorspace_to_scene_linear_v3(pixel, handle->rect_colorspace);
+				straight_to_premul_v4(pixel);
+
+				if (channels == 4) {
+					copy_v4_v4(fp, pixel);
+				}
+				else if (channels == 3) {
+					copy_v3_v3(fp, pixel);
+				}
+				else /* if (channels == 1) */ {
+					fp[0] = pixel[0];
+				}
+			}
+		}
+	}
+
+	if (!handle->is_data) {
+		IMB_colormanagement_processor_apply(cm_processor, buffer, width, height, channels, true);
+	}
+
+	if (handle->display_buffer_float == NULL) {
+		for (y = ymin; y < ymax; y++) {
+			for (x = xmin; x < xmax; x++) {
+				size_t display_index = ((size_t)y * handle->display_stride + x) * 4;
+				const float *fp = buffer + ((size_t)(y - ymin) * width + (x - xmin)) * channels;
+
+				if (channels == 4) {
+					float pixel_straight[4];
+					premul_to_straight_v4_v4(pixel_straight, fp);
+					rgba_float_to_uchar(display_buffer + display_index, pixel_straight);
+				}
+				else if (channels == 3) {
+					rgb_float_to_uchar(display_buffer + display_index, fp);
+					display_buffer[display_index + 3] = 255;
+				}
+				else /* if (channels == 1) */ {
+					display_buffer[display_index] =
+						display_buffer[display_index + 1] =
+						display_buffer[display_index + 2] =
+						display_buffer[display_index + 3] = FTOCHAR(fp[0]);
+				}
+			}
+		}
+
+		MEM_freeN(buffer);
+	}
+
+	return NULL;
+}
+
 static void partial_buffer_update_rect(ImBuf *ibuf, unsigned char *display_buffer, const float *linear_buffer,
                                        const unsigned char *byte_buffer, int display_stride, int linear_stride,
                                        int linear_offset_x, int linear_offset_y, ColormanageProcessor *cm_processor,
                                        const int xmin, const int ymin, const int xmax, const int ymax)
 {
-	int x, y;
 	int channels = ibuf->channels;
 	float dither = ibuf->dither;
 	ColorSpace *rect_colorspace = ibuf->rect_colorspace;
@@ -2638,69 +2946,26 @@ static void partial_buffer_update_rect(ImBuf *ibuf, unsigned char *display_buffe
 	}
 
 	if (cm_processor) {
-		for (y = ymin; y < ymax; y++) {
-			for (x = xmin; x < xmax; x++) {
-				size_t display_index = ((size_t)y * display_stride + x) * 4;
-				size_t linear_index = ((size_t)(y - linear_offset_y) * linear_stride + (x - linear_offset_x)) * channels;
-				float pixel[4];
-
-				if (linear_buffer) {
-					if (channels == 4) {
-						copy_v4_v4(pixel, (float *) linear_buffer + linear_index);
-					}
-					else if (channels == 3) {
-						copy_v3_v3(pixel, (float *) linear_buffer + linear_index);
-						pixel[3] = 1.0f;
-					}
-					else if (channels == 1) {
-						pixel[0] = linear_buffer[linear_index];
-					}
-					else {
-						BLI_assert(!"Unsupported number of channels in partial buffer update");
-					}
-				}
-				else if (byte_buffer) {
-					rgba_uchar_to_float(pixel, byte_buffer + linear_index);
-					IMB_colormanagement_colorspace_to_scene_linear_v3(pixel, rect_colorspace);
-					straight_to_premul_v4(pixel);
-				}
-
-				if (!is_data) {
-					IMB_colormanagement_processor_apply_pixel(cm_processor, pixel, channels);
-				}
-
-				if (display_buffer_float) {
-					size_t index = ((size_t)(y - ymin) * width + (x - xmin)) * channels;
-
-					if (channels == 4) {
-						copy_v4_v4(display_buffer_float + index, pixel);
-					}
-					else if (channels == 3) {
-						copy_v3_v3(display_buffer_float + index, pixel);
-					}
-					else /* if (channels == 1) */ {
-						display_buffer_float[index] = pixel[0];
-					}
-				}
-				else {
-					if (channels == 4) {
-						float pixel_straight[4];
-						premul_to_straight_v4_v4(pixel_straight, pixel);
-						rgba_float_to_uchar(display_buffer + display_index, pixel_straight);
-					}
-					else if (channels == 3) {
-						rgb_float_to_uchar(display_buffer + display_index, pixel);
-						display_buffer[display_index + 3] = 255;
-					}
-					else /* if (channels == 1) */ {
-						display_buffer[display_index] =
-							display_buffer[display_index + 1] =
-							display_buffer[display_index + 2] =
-							display_buffer[display_index + 3] = FTOCHAR(pixel[0]);
-					}
-				}
-			}
-		}
+		PartialBufferUpdateInitData init_data;
+
+		init_data.cm_processor = cm_processor;
+		init_data.display_buffer = display_buffer;
+		init_data.display_buffer_float = display_buffer_float;
+		init_data.linear_buffer = linear_buffer;
+		init_data.byte_buffer = byte_buffer;
+		init_data.rect_colorspace = rect_colorspace;
+		init_data.display_stride = display_stride;
+		init_data.linear_stride = linear_stride;
+		init_data.linear_offset_x = linear_offset_x;
+		init_data.linear_offset_y = linear_offset_y;
+		init_data.xmin = xmin;
+		init_data.ymin = ymin;
+		init_data.width = width;
+		init_data.channels = channels;
+		init_data.is_data = is_data;
+
+		IMB_processor_apply_threaded(height, sizeof(PartialBufferUpdateThread), &init_data,
+		                             partial_buffer_update_init_handle, do_partial_buffer_update_thread);
 	}
 	else {
 		if (display_buffer_float) {
@@ -2851,7 +3116,7 @@ ColormanageProcessor *IMB_colormanagement_display_processor_new(const ColorManag
 	if (display_space)
 		cm_processor->is_data_result = display_space->is_data;
 
-	cm_processor->processor = create_display_buffer_processor(applied_view_settings->look,
+	cm_processor->processor = display_processor_cache_acquire(applied_view_settings->look,
 	                                                          applied_view_settings->view_transform,
 	                                                          display_settings->display_device,
 	                                                          applied_view_settings->exposure,
@@ -2965,7 +3230,7 @@ void IMB_colormanagement_processor_free(ColormanageProcessor *cm_processor)
 	if (cm_processor->curve_mapping)
 		curvemapping_free(cm_processor->curve_mapping);
 	if (cm_processor->processor)
-		OCIO_processorRelease(cm_processor->processor);
+		display_processor_cache_release(cm_processor->processor);
 
 	MEM_freeN(cm_processor);
 }
@@ -32,6 +32,7 @@
  */
 
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "imbuf.h"
@@ -814,27 +815,46 @@ void IMB_buffer_float_premultiply(float *buf, int width, int height)
 
 /**************************** alter saturation *****************************/
 
-void IMB_saturation(ImBuf *ibuf, float sat)
+typedef struct SaturationData {
+	ImBuf *ibuf;
+	float sat;
+} SaturationData;
+
+static void saturation_line_cb(void *userdata, const int y)
 {
-	size_t i;
-	unsigned char *rct = (unsigned char *)ibuf->rect;
-	float *rct_fl = ibuf->rect_float;
+	SaturationData *data = userdata;
+	ImBuf *ibuf = data->ibuf;
+	const size_t offset = 4 * (size_t)y * ibuf->x;
+	int x;
 	float hsv[3];
 
-	if (rct) {
+	if (ibuf->rect) {
+		unsigned char *rct = (unsigned char *)ibuf->rect + offset;
 		float rgb[3];
-		for (i = ((size_t)ibuf->x) * ibuf->y; i > 0; i--, rct += 4) {
+		for (x = 0; x < ibuf->x; x++, rct += 4) {
 			rgb_uchar_to_float(rgb, rct);
 			rgb_to_hsv_v(rgb, hsv);
-			hsv_to_rgb(hsv[0], hsv[1] * sat, hsv[2], rgb, rgb + 1, rgb + 2);
+			hsv_to_rgb(hsv[0], hsv[1] * data->sat, hsv[2], rgb, rgb + 1, rgb + 2);
 			rgb_float_to_uchar(rct, rgb);
 		}
 	}
 
-	if (rct_fl) {
-		for (i = ((size_t)ibuf->x) * ibuf->y; i > 0; i--, rct_fl += 4) {
+	if (ibuf->rect_float) {
+		float *rct_fl = ibuf->rect_float + offset;
+		for (x = 0; x < ibuf->x; x++, rct_fl += 4) {
 			rgb_to_hsv_v(rct_fl, hsv);
-			hsv_to_rgb(hsv[0], hsv[1] * sat, hsv[2], rct_fl, rct_fl + 1, rct_fl + 2);
+			hsv_to_rgb(hsv[0], hsv[1] * data->sat, hsv[2], rct_fl, rct_fl + 1, rct_fl + 2);
 		}
 	}
 }
+
+void IMB_saturation(ImBuf *ibuf, float sat)
+{
+	SaturationData data;
+
+	data.ibuf = ibuf;
+	data.sat = sat;
+
+	/* lines are independent, the conversion to HSV is expensive enough to do them in parallel */
+	BLI_task_parallel_range(0, ibuf->y, &data, saturation_line_cb, ibuf->y > 64);
+}
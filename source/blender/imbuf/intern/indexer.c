@@ -36,6 +36,8 @@
 #include "BLI_string.h"
 #include "BLI_fileops.h"
 #include "BLI_ghash.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "IMB_indexer.h"
 #include "IMB_anim.h"
@@ -709,6 +711,10 @@ typedef struct FFmpegIndexBuilderContext {
 	struct proxy_output_ctx *proxy_ctx[IMB_PROXY_MAX_SLOT];
 	anim_index_builder *indexer[IMB_TC_MAX_SLOT];
 
+	/* encodes the proxy sizes of the decoded frame in parallel */
+	TaskPool *proxy_pool;
+	AVFrame *proxy_frame;
+
 	IMB_Timecode_Type tcs_in_use;
 	IMB_Proxy_Size proxy_sizes_in_use;
 
@@ -784,6 +790,11 @@ static IndexBuildContext *index_ffmpeg_create_context(struct anim *anim, IMB_Tim
 
 	context->iCodecCtx->workaround_bugs = 1;
 
+	/* frame threading delays the output of frames, which would give wrong seek positions
+	 * in the timecode indices, so only slices are decoded in parallel when building them */
+	context->iCodecCtx->thread_count = BLI_system_thread_count();
+	context->iCodecCtx->thread_type = (tcs_in_use != IMB_TC_NONE) ? FF_THREAD_SLICE : FF_THREAD_FRAME | FF_THREAD_SLICE;
+
 	if (avcodec_open2(context->iCodecCtx, context->iCodec, NULL) < 0) {
 		avformat_close_input(&context->iFormatCtx);
 		MEM_freeN(context);
@@ -842,6 +853,14 @@ static void index_rebuild_ffmpeg_finish(FFmpegIndexBuilderContext *context, int
 	MEM_freeN(context);
 }
 
+static void index_rebuild_ffmpeg_proxy_task(TaskPool * __restrict pool, void *taskdata, int UNUSED(threadid))
+{
+	FFmpegIndexBuilderContext *context = BLI_task_pool_userdata(pool);
+	struct proxy_output_ctx *proxy_ctx = taskdata;
+
+	add_to_proxy_output_ffmpeg(proxy_ctx, context->proxy_frame);
+}
+
 static void index_rebuild_ffmpeg_proc_decoded_frame(
 	FFmpegIndexBuilderContext *context, 
 	AVPacket * curr_packet,
@@ -852,8 +871,22 @@ static void index_rebuild_ffmpeg_proc_decoded_frame(
 	unsigned long long s_dts = context->seek_pos_dts;
 	unsigned long long pts = av_get_pts_from_frame(context->iFormatCtx, in_frame);
 
-	for (i = 0; i < context->num_proxy_sizes; i++) {
-		add_to_proxy_output_ffmpeg(context->proxy_ctx[i], in_frame);
+	/* every proxy size has its own scaler and encoder, the timecode indices are
+	 * written while the proxies are encoded */
+	if (context->proxy_pool) {
+		context->proxy_frame = in_frame;
+
+		for (i = 0; i < context->num_proxy_sizes; i++) {
+			if (context->proxy_ctx[i]) {
+				BLI_task_pool_push(context->proxy_pool, index_rebuild_ffmpeg_proxy_task,
+				                   context->proxy_ctx[i], false, TASK_PRIORITY_HIGH);
+			}
+		}
+	}
+	else {
+		for (i = 0; i < context->num_proxy_sizes; i++) {
+			add_to_proxy_output_ffmpeg(context->proxy_ctx[i], in_frame);
+		}
 	}
 
 	if (!context->start_pts_set) {
@@ -894,6 +927,11 @@ static void index_rebuild_ffmpeg_proc_decoded_frame(
 	}
 	
 	context->frameno_gapless++;
+
+	/* the decoder reuses the frame */
+	if (context->proxy_pool) {
+		BLI_task_pool_work_and_wait(context->proxy_pool);
+	}
 }
 
 static int index_rebuild_ffmpeg(FFmpegIndexBuilderContext *context,
@@ -902,11 +940,22 @@ static int index_rebuild_ffmpeg(FFmpegIndexBuilderContext *context,
 	AVFrame *in_frame = 0;
 	AVPacket next_packet;
 	uint64_t stream_size;
+	int i, num_proxies = 0;
 
 	memset(&next_packet, 0, sizeof(AVPacket));
 
 	in_frame = av_frame_alloc();
 
+	for (i = 0; i < context->num_proxy_sizes; i++) {
+		if (context->proxy_ctx[i]) {
+			num_proxies++;
+		}
+	}
+
+	if (num_proxies > 1) {
+		context->proxy_pool = BLI_task_pool_create(BLI_task_scheduler_get(), context);
+	}
+
 	stream_size = avio_size(context->iFormatCtx->pb);
 
 	context->frame_rate = av_q2d(av_get_r_frame_rate_compat(context->iStream));
@@ -973,6 +1022,11 @@ static int index_rebuild_ffmpeg(FFmpegIndexBuilderContext *context,
 		} while (frame_finished);
 	}
 
+	if (context->proxy_pool) {
+		BLI_task_pool_free(context->proxy_pool);
+		context->proxy_pool = NULL;
+	}
+
 	av_free(in_frame);
 
 	return 1;
@@ -1266,6 +1320,9 @@ void IMB_free_indices(struct anim *anim)
 {
 	int i;
 
+	/* frames decoded ahead depend on the indices */
+	imb_anim_prefetch_cancel(anim);
+
 	for (i = 0; i < IMB_PROXY_MAX_SLOT; i++) {
 		if (anim->proxy_anim[i]) {
 			IMB_close_anim(anim->proxy_anim[i]);
@@ -1273,6 +1330,8 @@ void IMB_free_indices(struct anim *anim)
 		}
 	}
 
+	imb_anim_decode_lock(anim);
+
 	for (i = 0; i < IMB_TC_MAX_SLOT; i++) {
 		if (anim->curr_idx[i]) {
 			IMB_indexer_close(anim->curr_idx[i]);
@@ -1283,6 +1342,8 @@ void IMB_free_indices(struct anim *anim)
 
 	anim->proxies_tried = 0;
 	anim->indices_tried = 0;
+
+	imb_anim_decode_unlock(anim);
 }
 
 void IMB_anim_set_index_dir(struct anim *anim, const char *dir)
@@ -1345,13 +1406,20 @@ struct anim_index *IMB_anim_open_index(
 int IMB_anim_index_get_frame_index(struct anim *anim, IMB_Timecode_Type tc,
                                    int position)
 {
-	struct anim_index *idx = IMB_anim_open_index(anim, tc);
+	struct anim_index *idx;
 
-	if (!idx) {
-		return position;
+	/* the prefetch thread opens indices too */
+	imb_anim_decode_lock(anim);
+
+	idx = IMB_anim_open_index(anim, tc);
+
+	if (idx) {
+		position = IMB_indexer_get_frame_index(idx, position);
 	}
 
-	return IMB_indexer_get_frame_index(idx, position);
+	imb_anim_decode_unlock(anim);
+
+	return position;
 }
 
 IMB_Proxy_Size IMB_anim_proxy_get_existing(struct anim *anim)
@@ -439,6 +439,19 @@ ImBuf *IMB_moviecache_get(MovieCache *cache, void *userkey)
 	return NULL;
 }
 
+/* memory used by the buffers of all movie caches */
+size_t IMB_moviecache_get_memory_in_use(void)
+{
+	size_t mem_in_use = 0;
+
+	BLI_mutex_lock(&limitor_lock);
+	if (limitor)
+		mem_in_use = MEM_CacheLimiter_get_memory_in_use(limitor);
+	BLI_mutex_unlock(&limitor_lock);
+
+	return mem_in_use;
+}
+
 bool IMB_moviecache_has_frame(MovieCache *cache, void *userkey)
 {
 	MovieCacheKey key;
@@ -32,9 +32,10 @@
  */
 
 
+#include <string.h>
+
 #include "BLI_utildefines.h"
-#include "BLI_math_color.h"
-#include "BLI_math_interp.h"
+#include "BLI_math.h"
 #include "MEM_guardedalloc.h"
 
 #include "imbuf.h"
@@ -45,6 +46,10 @@
 
 #include "BLI_sys_types.h" // for intptr_t support
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 /************************************************************************/
 /*								SCALING									*/
 /************************************************************************/
@@ -431,1148 +436,483 @@ ImBuf *IMB_onehalf(struct ImBuf *ibuf1)
 	return (ibuf2);
 }
 
-/* q_scale_linear_interpolation helper functions */
-
-static void enlarge_picture_byte(
-        unsigned char *src, unsigned char *dst, int src_width,
-        int src_height, int dst_width, int dst_height)
+static void scalefast_Z_ImBuf(ImBuf *ibuf, int newx, int newy)
 {
-	double ratiox = (double) (dst_width - 1.0)  / (double) (src_width - 1.001);
-	double ratioy = (double) (dst_height - 1.0) / (double) (src_height - 1.001);
-	uintptr_t x_src, dx_src, x_dst;
-	uintptr_t y_src, dy_src, y_dst;
-
-	dx_src = 65536.0 / ratiox;
-	dy_src = 65536.0 / ratioy;
-
-	y_src = 0;
-	for (y_dst = 0; y_dst < dst_height; y_dst++) {
-		unsigned char *line1 = src + (y_src >> 16) * 4 * src_width;
-		unsigned char *line2 = line1 + 4 * src_width;
-		uintptr_t weight1y = 65536 - (y_src & 0xffff);
-		uintptr_t weight2y = 65536 - weight1y;
-
-		if ((y_src >> 16) == src_height - 1) {
-			line2 = line1;
-		}
-
-		x_src = 0;
-		for (x_dst = 0; x_dst < dst_width; x_dst++) {
-			uintptr_t weight1x = 65536 - (x_src & 0xffff);
-			uintptr_t weight2x = 65536 - weight1x;
-
-			unsigned long x = (x_src >> 16) * 4;
-
-			*dst++ = ((((line1[x]     * weight1y) >> 16) * weight1x) >> 16) +
-			         ((((line2[x]     * weight2y) >> 16) * weight1x) >> 16) +
-			         ((((line1[4 + x] * weight1y) >> 16) * weight2x) >> 16) +
-			         ((((line2[4 + x] * weight2y) >> 16) * weight2x) >> 16);
-
-			*dst++ = ((((line1[x + 1]     * weight1y) >> 16) * weight1x) >> 16) +
-			         ((((line2[x + 1]     * weight2y) >> 16) * weight1x) >> 16) +
-			         ((((line1[4 + x + 1] * weight1y) >> 16) * weight2x) >> 16) +
-			         ((((line2[4 + x + 1] * weight2y) >> 16) * weight2x) >> 16);
-
-			*dst++ = ((((line1[x + 2]     * weight1y) >> 16) * weight1x) >> 16) +
-			         ((((line2[x + 2]     * weight2y) >> 16) * weight1x) >> 16) +
-			         ((((line1[4 + x + 2] * weight1y) >> 16) * weight2x) >> 16) +
-			         ((((line2[4 + x + 2] * weight2y) >> 16) * weight2x) >> 16);
+	int *zbuf, *newzbuf, *_newzbuf = NULL;
+	float *zbuf_float, *newzbuf_float, *_newzbuf_float = NULL;
+	int x, y;
+	int ofsx, ofsy, stepx, stepy;
 
-			*dst++ = ((((line1[x + 3]     * weight1y) >> 16) * weight1x) >> 16) +
-			         ((((line2[x + 3]     * weight2y) >> 16) * weight1x) >> 16) +
-			         ((((line1[4 + x + 3] * weight1y) >> 16) * weight2x) >> 16) +
-			         ((((line2[4 + x + 3] * weight2y) >> 16) * weight2x) >> 16);
+	if (ibuf->zbuf) {
+		_newzbuf = MEM_mallocN(newx * newy * sizeof(int), __func__);
+		if (_newzbuf == NULL) {
+			IMB_freezbufImBuf(ibuf);
+		}
+	}
 
-			x_src += dx_src;
+	if (ibuf->zbuf_float) {
+		_newzbuf_float = MEM_mallocN((size_t)newx * newy * sizeof(float), __func__);
+		if (_newzbuf_float == NULL) {
+			IMB_freezbuffloatImBuf(ibuf);
 		}
-		y_src += dy_src;
 	}
-}
 
-struct scale_outpix_byte {
-	uintptr_t r;
-	uintptr_t g;
-	uintptr_t b;
-	uintptr_t a;
+	if (!_newzbuf && !_newzbuf_float) {
+		return;
+	}
 
-	uintptr_t weight;
-};
+	stepx = (65536.0 * (ibuf->x - 1.0) / (newx - 1.0)) + 0.5;
+	stepy = (65536.0 * (ibuf->y - 1.0) / (newy - 1.0)) + 0.5;
+	ofsy = 32768;
 
-static void shrink_picture_byte(
-        unsigned char *src, unsigned char *dst, int src_width,
-        int src_height, int dst_width, int dst_height)
-{
-	double ratiox = (double) (dst_width) / (double) (src_width);
-	double ratioy = (double) (dst_height) / (double) (src_height);
-	uintptr_t x_src, dx_dst, x_dst;
-	uintptr_t y_src, dy_dst, y_dst;
-	intptr_t y_counter;
-	unsigned char *dst_begin = dst;
-
-	struct scale_outpix_byte *dst_line1 = NULL;
-	struct scale_outpix_byte *dst_line2 = NULL;
-
-	dst_line1 = (struct scale_outpix_byte *) MEM_callocN(
-	    (dst_width + 1) * sizeof(struct scale_outpix_byte),
-	    "shrink_picture_byte 1");
-	dst_line2 = (struct scale_outpix_byte *) MEM_callocN(
-	    (dst_width + 1) * sizeof(struct scale_outpix_byte),
-	    "shrink_picture_byte 2");
-
-	dx_dst = 65536.0 * ratiox;
-	dy_dst = 65536.0 * ratioy;
-
-	y_dst = 0;
-	y_counter = 65536;
-	for (y_src = 0; y_src < src_height; y_src++) {
-		unsigned char *line = src + y_src * 4 * src_width;
-		uintptr_t weight1y = 65535 - (y_dst & 0xffff);
-		uintptr_t weight2y = 65535 - weight1y;
-		x_dst = 0;
-		for (x_src = 0; x_src < src_width; x_src++) {
-			uintptr_t weight1x = 65535 - (x_dst & 0xffff);
-			uintptr_t weight2x = 65535 - weight1x;
-
-			uintptr_t x = x_dst >> 16;
-
-			uintptr_t w;
-
-			w = (weight1y * weight1x) >> 16;
-
-			/* ensure correct rounding, without this you get ugly banding, or too low color values (ton) */
-			dst_line1[x].r += (line[0] * w + 32767) >> 16;
-			dst_line1[x].g += (line[1] * w + 32767) >> 16;
-			dst_line1[x].b += (line[2] * w + 32767) >> 16;
-			dst_line1[x].a += (line[3] * w + 32767) >> 16;
-			dst_line1[x].weight += w;
-
-			w = (weight2y * weight1x) >> 16;
-
-			dst_line2[x].r += (line[0] * w + 32767) >> 16;
-			dst_line2[x].g += (line[1] * w + 32767) >> 16;
-			dst_line2[x].b += (line[2] * w + 32767) >> 16;
-			dst_line2[x].a += (line[3] * w + 32767) >> 16;
-			dst_line2[x].weight += w;
-
-			w = (weight1y * weight2x) >> 16;
-
-			dst_line1[x + 1].r += (line[0] * w + 32767) >> 16;
-			dst_line1[x + 1].g += (line[1] * w + 32767) >> 16;
-			dst_line1[x + 1].b += (line[2] * w + 32767) >> 16;
-			dst_line1[x + 1].a += (line[3] * w + 32767) >> 16;
-			dst_line1[x + 1].weight += w;
-
-			w = (weight2y * weight2x) >> 16;
-
-			dst_line2[x + 1].r += (line[0] * w + 32767) >> 16;
-			dst_line2[x + 1].g += (line[1] * w + 32767) >> 16;
-			dst_line2[x + 1].b += (line[2] * w + 32767) >> 16;
-			dst_line2[x + 1].a += (line[3] * w + 32767) >> 16;
-			dst_line2[x + 1].weight += w;
-
-			x_dst += dx_dst;
-			line += 4;
+	newzbuf = _newzbuf;
+	newzbuf_float = _newzbuf_float;
+
+	for (y = newy; y > 0; y--, ofsy += stepy) {
+		if (newzbuf) {
+			zbuf = ibuf->zbuf;
+			zbuf += (ofsy >> 16) * ibuf->x;
+			ofsx = 32768;
+			for (x = newx; x > 0; x--, ofsx += stepx) {
+				*newzbuf++ = zbuf[ofsx >> 16];
+			}
 		}
 
-		y_dst += dy_dst;
-		y_counter -= dy_dst;
-		if (y_counter < 0) {
-			int val;
-			uintptr_t x;
-			struct scale_outpix_byte *temp;
-
-			y_counter += 65536;
-			
-			for (x = 0; x < dst_width; x++) {
-				uintptr_t f =  0x80000000UL / dst_line1[x].weight;
-				*dst++ = (val = (dst_line1[x].r * f) >> 15) > 255 ? 255 : val;
-				*dst++ = (val = (dst_line1[x].g * f) >> 15) > 255 ? 255 : val;
-				*dst++ = (val = (dst_line1[x].b * f) >> 15) > 255 ? 255 : val;
-				*dst++ = (val = (dst_line1[x].a * f) >> 15) > 255 ? 255 : val;
+		if (newzbuf_float) {
+			zbuf_float = ibuf->zbuf_float;
+			zbuf_float += (ofsy >> 16) * ibuf->x;
+			ofsx = 32768;
+			for (x = newx; x > 0; x--, ofsx += stepx) {
+				*newzbuf_float++ = zbuf_float[ofsx >> 16];
 			}
-			memset(dst_line1, 0, dst_width *
-			       sizeof(struct scale_outpix_byte));
-			temp = dst_line1;
-			dst_line1 = dst_line2;
-			dst_line2 = temp;
 		}
 	}
-	if (dst - dst_begin < dst_width * dst_height * 4) {
-		int val;
-		uintptr_t x;
-		for (x = 0; x < dst_width; x++) {
-			uintptr_t f = 0x80000000UL / dst_line1[x].weight;
-			*dst++ = (val = (dst_line1[x].r * f) >> 15) > 255 ? 255 : val;
-			*dst++ = (val = (dst_line1[x].g * f) >> 15) > 255 ? 255 : val;
-			*dst++ = (val = (dst_line1[x].b * f) >> 15) > 255 ? 255 : val;
-			*dst++ = (val = (dst_line1[x].a * f) >> 15) > 255 ? 255 : val;
-		}
+
+	if (_newzbuf) {
+		IMB_freezbufImBuf(ibuf);
+		ibuf->mall |= IB_zbuf;
+		ibuf->zbuf = _newzbuf;
+	}
+
+	if (_newzbuf_float) {
+		IMB_freezbuffloatImBuf(ibuf);
+		ibuf->mall |= IB_zbuffloat;
+		ibuf->zbuf_float = _newzbuf_float;
 	}
-	MEM_freeN(dst_line1);
-	MEM_freeN(dst_line2);
 }
 
+/* ******** filtered scaling ******** */
+
+/* Images are resampled with a separable filter, first horizontally and then vertically.
+ * Every output line is a weighted sum of a few input lines which are scaled horizontally.
+ * Threads only keep the scaled input lines of their current output line in a ring buffer,
+ * so there is no intermediate buffer of the full image size. */
+
+typedef struct ScaleFilterWeights {
+	int *first;      /* first input pixel of every output pixel */
+	int *taps;       /* number of input pixels of every output pixel */
+	float *weights;  /* max_taps weights for every output pixel */
+	int max_taps;
+} ScaleFilterWeights;
 
-static void q_scale_byte(unsigned char *in, unsigned char *out, int in_width,
-                         int in_height, int dst_width, int dst_height)
+static float scale_filter_support(IMB_ScaleFilter filter)
 {
-	if (dst_width > in_width && dst_height > in_height) {
-		enlarge_picture_byte(in, out, in_width, in_height,
-		                     dst_width, dst_height);
-	}
-	else if (dst_width < in_width && dst_height < in_height) {
-		shrink_picture_byte(in, out, in_width, in_height,
-		                    dst_width, dst_height);
-	}
+	switch (filter) {
+		case IMB_SCALE_FILTER_BOX:
+			return 0.5f;
+		case IMB_SCALE_FILTER_BILINEAR:
+			return 1.0f;
+		case IMB_SCALE_FILTER_BICUBIC:
+			return 2.0f;
+		case IMB_SCALE_FILTER_LANCZOS:
+			return 3.0f;
+	}
+
+	return 1.0f;
 }
 
-static void enlarge_picture_float(
-        float *src, float *dst, int src_width,
-        int src_height, int dst_width, int dst_height)
+static float scale_filter_eval(IMB_ScaleFilter filter, float x)
 {
-	double ratiox = (double) (dst_width - 1.0) / (double) (src_width - 1.001);
-	double ratioy = (double) (dst_height - 1.0) / (double) (src_height - 1.001);
-	uintptr_t x_dst;
-	uintptr_t y_dst;
-	double x_src, dx_src;
-	double y_src, dy_src;
-
-	dx_src = 1.0 / ratiox;
-	dy_src = 1.0 / ratioy;
-
-	y_src = 0;
-	for (y_dst = 0; y_dst < dst_height; y_dst++) {
-		float *line1 = src + ((int) y_src) * 4 * src_width;
-		const float *line2 = line1 + 4 * src_width;
-		const float weight1y = (float)(1.0 - (y_src - (int) y_src));
-		const float weight2y = 1.0f - weight1y;
-
-		if ((int) y_src == src_height - 1) {
-			line2 = line1;
-		}
+	x = fabsf(x);
+
+	switch (filter) {
+		case IMB_SCALE_FILTER_BOX:
+			if (x < 0.5f)
+				return 1.0f;
+			else if (x == 0.5f)
+				return 0.5f;
+			return 0.0f;
+		case IMB_SCALE_FILTER_BILINEAR:
+			return (x < 1.0f) ? 1.0f - x : 0.0f;
+		case IMB_SCALE_FILTER_BICUBIC:
+			/* Catmull-Rom spline */
+			if (x < 1.0f)
+				return (1.5f * x - 2.5f) * x * x + 1.0f;
+			else if (x < 2.0f)
+				return ((-0.5f * x + 2.5f) * x - 4.0f) * x + 2.0f;
+			return 0.0f;
+		case IMB_SCALE_FILTER_LANCZOS:
+			/* three lobes */
+			if (x < 1e-6f) {
+				return 1.0f;
+			}
+			else if (x < 3.0f) {
+				const float px = (float)M_PI * x;
+				return 3.0f * sinf(px) * sinf(px / 3.0f) / (px * px);
+			}
+			return 0.0f;
+	}
 
-		x_src = 0;
-		for (x_dst = 0; x_dst < dst_width; x_dst++) {
-			const float weight1x = (float)(1.0 - (x_src - (int) x_src));
-			const float weight2x = (float)(1.0f - weight1x);
+	return 0.0f;
+}
 
-			const float w11 = weight1y * weight1x;
-			const float w21 = weight2y * weight1x;
-			const float w12 = weight1y * weight2x;
-			const float w22 = weight2y * weight2x;
+/* weight of input pixel j for the output pixel at center */
+static float scale_filter_weight(IMB_ScaleFilter filter, int j, float center, float filter_scale)
+{
+	if (filter == IMB_SCALE_FILTER_BOX && filter_scale > 1.0f) {
+		/* the part of the input pixel which the output pixel covers, an exact box average */
+		const float radius = 0.5f * filter_scale;
+		return max_ff(min_ff(j + 1.0f, center + radius) - max_ff((float)j, center - radius), 0.0f);
+	}
 
-			uintptr_t x = ((int) x_src) * 4;
+	return scale_filter_eval(filter, (j + 0.5f - center) / filter_scale);
+}
 
-			*dst++ = line1[x]     * w11 +
-			         line2[x]     * w21 +
-			         line1[4 + x] * w12 +
-			         line2[4 + x] * w22;
+/* where output pixels sample the input */
+typedef enum ScaleFilterAlign {
+	/* pixels of both sizes cover the same area */
+	SCALE_ALIGN_AREA = 0,
+	/* the first and last pixels are kept, as IMB_scaleImBuf always enlarged */
+	SCALE_ALIGN_ENDS,
+	/* output pixel i samples input pixel i * in / out, as IMB_scaleImBuf_threaded always enlarged */
+	SCALE_ALIGN_START,
+} ScaleFilterAlign;
+
+static void scale_filter_weights_init(ScaleFilterWeights *w, IMB_ScaleFilter filter, ScaleFilterAlign align,
+                                      int in_size, int out_size)
+{
+	const float scale = (float)out_size / (float)in_size;
+	/* when shrinking the filter is widened, so every input pixel contributes */
+	const float filter_scale = (scale < 1.0f) ? 1.0f / scale : 1.0f;
+	const float radius = scale_filter_support(filter) * filter_scale;
+	int i, j;
+
+	w->max_taps = (in_size == out_size) ? 1 : min_ii((int)ceilf(2.0f * radius) + 3, in_size);
+	w->first = MEM_mallocN(sizeof(int) * out_size, "scale filter first");
+	w->taps = MEM_mallocN(sizeof(int) * out_size, "scale filter taps");
+	w->weights = MEM_mallocN(sizeof(float) * out_size * w->max_taps, "scale filter weights");
+
+	for (i = 0; i < out_size; i++) {
+		float *weights = w->weights + i * w->max_taps;
+		float center, sum = 0.0f;
+		int first, last;
+
+		if (in_size == out_size) {
+			w->first[i] = i;
+			w->taps[i] = 1;
+			weights[0] = 1.0f;
+			continue;
+		}
+
+		/* pixel centers are at half integer coordinates */
+		switch (align) {
+			case SCALE_ALIGN_ENDS:
+				center = (out_size > 1) ? i * (float)(in_size - 1) / (float)(out_size - 1) + 0.5f : 0.5f * in_size;
+				break;
+			case SCALE_ALIGN_START:
+				center = i / scale + 0.5f;
+				break;
+			default:
+				center = (i + 0.5f) / scale;
+				break;
+		}
+		first = max_ii((int)floorf(center - radius), 0);
+		last = min_ii((int)ceilf(center + radius), in_size - 1);
+
+		/* skip input pixels outside of the filter */
+		while (first < last && scale_filter_weight(filter, first, center, filter_scale) == 0.0f)
+			first++;
+		while (last > first && scale_filter_weight(filter, last, center, filter_scale) == 0.0f)
+			last--;
+
+		for (j = first; j <= last; j++) {
+			weights[j - first] = scale_filter_weight(filter, j, center, filter_scale);
+			sum += weights[j - first];
+		}
+
+		if (sum == 0.0f) {
+			/* can only happen with negative lobes, use the nearest pixel */
+			first = last = CLAMPIS((int)center, 0, in_size - 1);
+			weights[0] = 1.0f;
+		}
+		else {
+			for (j = 0; j <= last - first; j++)
+				weights[j] /= sum;
+		}
+
+		w->first[i] = first;
+		w->taps[i] = last - first + 1;
+	}
+}
 
-			*dst++ = line1[x + 1]     * w11 +
-			         line2[x + 1]     * w21 +
-			         line1[4 + x + 1] * w12 +
-			         line2[4 + x + 1] * w22;
+static void scale_filter_weights_free(ScaleFilterWeights *w)
+{
+	MEM_freeN(w->first);
+	MEM_freeN(w->taps);
+	MEM_freeN(w->weights);
+}
 
-			*dst++ = line1[x + 2]     * w11 +
-			         line2[x + 2]     * w21 +
-			         line1[4 + x + 2] * w12 +
-			         line2[4 + x + 2] * w22;
+/* scale one line horizontally */
+static void scale_filter_line(const ScaleFilterWeights *w, const float *in, float *out, int out_size, int channels)
+{
+	int i, k, c;
 
-			*dst++ = line1[x + 3]     * w11 +
-			         line2[x + 3]     * w21 +
-			         line1[4 + x + 3] * w12 +
-			         line2[4 + x + 3] * w22;
+	for (i = 0; i < out_size; i++, out += channels) {
+		const float *weights = w->weights + i * w->max_taps;
+		const float *pixel = in + w->first[i] * channels;
 
-			x_src += dx_src;
-		}
-		y_src += dy_src;
-	}
-}
+		if (channels == 4) {
+#ifdef __SSE2__
+			__m128 sum = _mm_setzero_ps();
 
-struct scale_outpix_float {
-	float r;
-	float g;
-	float b;
-	float a;
+			for (k = 0; k < w->taps[i]; k++, pixel += 4)
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(pixel), _mm_set1_ps(weights[k])));
 
-	float weight;
-};
+			_mm_storeu_ps(out, sum);
+#else
+			zero_v4(out);
 
-static void shrink_picture_float(
-        const float *src, float *dst, int src_width,
-        int src_height, int dst_width, int dst_height)
-{
-	double ratiox = (double) (dst_width) / (double) (src_width);
-	double ratioy = (double) (dst_height) / (double) (src_height);
-	uintptr_t x_src;
-	uintptr_t y_src;
-	float dx_dst, x_dst;
-	float dy_dst, y_dst;
-	float y_counter;
-	const float *dst_begin = dst;
-
-	struct scale_outpix_float *dst_line1;
-	struct scale_outpix_float *dst_line2;
-
-	dst_line1 = (struct scale_outpix_float *) MEM_callocN(
-	        (dst_width + 1) * sizeof(struct scale_outpix_float),
-	        "shrink_picture_float 1");
-	dst_line2 = (struct scale_outpix_float *) MEM_callocN(
-	        (dst_width + 1) * sizeof(struct scale_outpix_float),
-	        "shrink_picture_float 2");
-
-	dx_dst = ratiox;
-	dy_dst = ratioy;
-
-	y_dst = 0;
-	y_counter = 1.0;
-	for (y_src = 0; y_src < src_height; y_src++) {
-		const float *line = src + y_src * 4 * src_width;
-		uintptr_t weight1y = 1.0f - (y_dst - (int) y_dst);
-		uintptr_t weight2y = 1.0f - weight1y;
-		x_dst = 0;
-		for (x_src = 0; x_src < src_width; x_src++) {
-			uintptr_t weight1x = 1.0f - (x_dst - (int) x_dst);
-			uintptr_t weight2x = 1.0f - weight1x;
-
-			uintptr_t x = (int) x_dst;
-
-			float w;
-
-			w = weight1y * weight1x;
-
-			dst_line1[x].r += line[0] * w;
-			dst_line1[x].g += line[1] * w;
-			dst_line1[x].b += line[2] * w;
-			dst_line1[x].a += line[3] * w;
-			dst_line1[x].weight += w;
-
-			w = weight2y * weight1x;
-
-			dst_line2[x].r += line[0] * w;
-			dst_line2[x].g += line[1] * w;
-			dst_line2[x].b += line[2] * w;
-			dst_line2[x].a += line[3] * w;
-			dst_line2[x].weight += w;
-
-			w = weight1y * weight2x;
-
-			dst_line1[x + 1].r += line[0] * w;
-			dst_line1[x + 1].g += line[1] * w;
-			dst_line1[x + 1].b += line[2] * w;
-			dst_line1[x + 1].a += line[3] * w;
-			dst_line1[x + 1].weight += w;
-
-			w = weight2y * weight2x;
-
-			dst_line2[x + 1].r += line[0] * w;
-			dst_line2[x + 1].g += line[1] * w;
-			dst_line2[x + 1].b += line[2] * w;
-			dst_line2[x + 1].a += line[3] * w;
-			dst_line2[x + 1].weight += w;
-
-			x_dst += dx_dst;
-			line += 4;
+			for (k = 0; k < w->taps[i]; k++, pixel += 4)
+				madd_v4_v4fl(out, pixel, weights[k]);
+#endif
 		}
+		else {
+			for (c = 0; c < channels; c++)
+				out[c] = 0.0f;
 
-		y_dst += dy_dst;
-		y_counter -= dy_dst;
-		if (y_counter < 0) {
-			uintptr_t x;
-			struct scale_outpix_float *temp;
-
-			y_counter += 1.0f;
-			
-			for (x = 0; x < dst_width; x++) {
-				float f = 1.0f / dst_line1[x].weight;
-				*dst++ = dst_line1[x].r * f;
-				*dst++ = dst_line1[x].g * f;
-				*dst++ = dst_line1[x].b * f;
-				*dst++ = dst_line1[x].a * f;
+			for (k = 0; k < w->taps[i]; k++, pixel += channels) {
+				for (c = 0; c < channels; c++)
+					out[c] += pixel[c] * weights[k];
 			}
-			memset(dst_line1, 0, dst_width *
-			       sizeof(struct scale_outpix_float));
-			temp = dst_line1;
-			dst_line1 = dst_line2;
-			dst_line2 = temp;
 		}
 	}
-	if (dst - dst_begin < dst_width * dst_height * 4) {
-		uintptr_t x;
-		for (x = 0; x < dst_width; x++) {
-			float f = 1.0f / dst_line1[x].weight;
-			*dst++ = dst_line1[x].r * f;
-			*dst++ = dst_line1[x].g * f;
-			*dst++ = dst_line1[x].b * f;
-			*dst++ = dst_line1[x].a * f;
-		}
-	}
-	MEM_freeN(dst_line1);
-	MEM_freeN(dst_line2);
-}
-
-
-static void q_scale_float(float *in, float *out, int in_width,
-                          int in_height, int dst_width, int dst_height)
-{
-	if (dst_width > in_width && dst_height > in_height) {
-		enlarge_picture_float(in, out, in_width, in_height,
-		                      dst_width, dst_height);
-	}
-	else if (dst_width < in_width && dst_height < in_height) {
-		shrink_picture_float(in, out, in_width, in_height,
-		                     dst_width, dst_height);
-	}
 }
 
-/**
- * q_scale_linear_interpolation (derived from ppmqscale, http://libdv.sf.net)
- *
- * q stands for quick _and_ quality :)
- *
- * only handles common cases when we either
- *
- * scale  both, x and y or
- * shrink both, x and y
- *
- * but that is pretty fast:
- * - does only blit once instead of two passes like the old code
- *   (fewer cache misses)
- * - uses fixed point integer arithmetic for byte buffers
- * - doesn't branch in tight loops
- *
- * Should be comparable in speed to the ImBuf ..._fast functions at least
- * for byte-buffers.
- *
- * NOTE: disabled, due to unacceptable inaccuracy and quality loss, see bug #18609 (ton)
- */
-static bool q_scale_linear_interpolation(
-        struct ImBuf *ibuf, int newx, int newy)
+/* add a horizontally scaled line to an output line */
+static void scale_filter_add_line(float *out, const float *in, float weight, size_t len)
 {
-	if ((newx >= ibuf->x && newy <= ibuf->y) ||
-	    (newx <= ibuf->x && newy >= ibuf->y))
-	{
-		return false;
-	}
+	size_t i = 0;
 
-	if (ibuf->rect) {
-		unsigned char *newrect =
-		    MEM_mallocN(newx * newy * sizeof(int), "q_scale rect");
-		q_scale_byte((unsigned char *)ibuf->rect, newrect, ibuf->x, ibuf->y,
-		             newx, newy);
+#ifdef __SSE2__
+	const __m128 weight_r = _mm_set1_ps(weight);
 
-		imb_freerectImBuf(ibuf);
-		ibuf->mall |= IB_rect;
-		ibuf->rect = (unsigned int *) newrect;
-	}
-	if (ibuf->rect_float) {
-		float *newrect =
-		    MEM_mallocN(newx * newy * 4 * sizeof(float),
-		                "q_scale rectfloat");
-		q_scale_float(ibuf->rect_float, newrect, ibuf->x, ibuf->y,
-		              newx, newy);
-		imb_freerectfloatImBuf(ibuf);
-		ibuf->mall |= IB_rectfloat;
-		ibuf->rect_float = newrect;
-	}
-	ibuf->x = newx;
-	ibuf->y = newy;
+	for (; i + 4 <= len; i += 4)
+		_mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(_mm_loadu_ps(in + i), weight_r)));
+#endif
 
-	return true;
+	for (; i < len; i++)
+		out[i] += in[i] * weight;
 }
 
-static ImBuf *scaledownx(struct ImBuf *ibuf, int newx)
-{
-	const int do_rect = (ibuf->rect != NULL);
-	const int do_float = (ibuf->rect_float != NULL);
-	const size_t rect_size = ibuf->x * ibuf->y * 4;
+typedef struct ScaleFilterInitData {
+	ImBuf *ibuf;
 
-	uchar *rect, *_newrect, *newrect;
-	float *rectf, *_newrectf, *newrectf;
-	float sample, add, val[4], nval[4], valf[4], nvalf[4];
-	int x, y;
+	int newx;
+	int newy;
 
-	rectf = _newrectf = newrectf = NULL;
-	rect = _newrect = newrect = NULL;
-	nval[0] =  nval[1] = nval[2] = nval[3] = 0.0f;
-	nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
+	ScaleFilterWeights weights_x;
+	ScaleFilterWeights weights_y;
 
-	if (!do_rect && !do_float) return (ibuf);
+	unsigned char *byte_buffer;
+	float *float_buffer;
+} ScaleFilterInitData;
 
-	if (do_rect) {
-		_newrect = MEM_mallocN(newx * ibuf->y * sizeof(uchar) * 4, "scaledownx");
-		if (_newrect == NULL) return(ibuf);
-	}
-	if (do_float) {
-		_newrectf = MEM_mallocN(newx * ibuf->y * sizeof(float) * 4, "scaledownxf");
-		if (_newrectf == NULL) {
-			if (_newrect) MEM_freeN(_newrect);
-			return(ibuf);
-		}
-	}
+typedef struct ScaleFilterThreadData {
+	ScaleFilterInitData *init_data;
 
-	add = (ibuf->x - 0.01) / newx;
+	int start_line;
+	int tot_line;
+} ScaleFilterThreadData;
 
-	if (do_rect) {
-		rect = (uchar *) ibuf->rect;
-		newrect = _newrect;
-	}
-	if (do_float) {
-		rectf = ibuf->rect_float;
-		newrectf = _newrectf;
-	}
-		
-	for (y = ibuf->y; y > 0; y--) {
-		sample = 0.0f;
-		val[0] =  val[1] = val[2] = val[3] = 0.0f;
-		valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
+static void scale_filter_lines(ScaleFilterInitData *data, int start_line, int tot_line, bool do_float)
+{
+	ImBuf *ibuf = data->ibuf;
+	const ScaleFilterWeights *wx = &data->weights_x;
+	const ScaleFilterWeights *wy = &data->weights_y;
+	const int channels = do_float ? ibuf->channels : 4;
+	const size_t line_len = (size_t)data->newx * channels;
+	float *cache, *in_line = NULL, *out_line = NULL;
+	int *cache_lines;
+	int y, k;
+	size_t i;
 
-		for (x = newx; x > 0; x--) {
-			if (do_rect) {
-				nval[0] = -val[0] * sample;
-				nval[1] = -val[1] * sample;
-				nval[2] = -val[2] * sample;
-				nval[3] = -val[3] * sample;
-			}
-			if (do_float) {
-				nvalf[0] = -valf[0] * sample;
-				nvalf[1] = -valf[1] * sample;
-				nvalf[2] = -valf[2] * sample;
-				nvalf[3] = -valf[3] * sample;
-			}
-			
-			sample += add;
+	cache = MEM_mallocN(sizeof(float) * line_len * wy->max_taps, "scale filter cache");
+	cache_lines = MEM_mallocN(sizeof(int) * wy->max_taps, "scale filter cache lines");
 
-			while (sample >= 1.0f) {
-				sample -= 1.0f;
-				
-				if (do_rect) {
-					nval[0] += rect[0];
-					nval[1] += rect[1];
-					nval[2] += rect[2];
-					nval[3] += rect[3];
-					rect += 4;
-				}
-				if (do_float) {
-					nvalf[0] += rectf[0];
-					nvalf[1] += rectf[1];
-					nvalf[2] += rectf[2];
-					nvalf[3] += rectf[3];
-					rectf += 4;
-				}
-			}
-			
-			if (do_rect) {
-				val[0] = rect[0]; val[1] = rect[1]; val[2] = rect[2]; val[3] = rect[3];
-				rect += 4;
-				
-				newrect[0] = ((nval[0] + sample * val[0]) / add + 0.5f);
-				newrect[1] = ((nval[1] + sample * val[1]) / add + 0.5f);
-				newrect[2] = ((nval[2] + sample * val[2]) / add + 0.5f);
-				newrect[3] = ((nval[3] + sample * val[3]) / add + 0.5f);
-				
-				newrect += 4;
-			}
-			if (do_float) {
-				
-				valf[0] = rectf[0]; valf[1] = rectf[1]; valf[2] = rectf[2]; valf[3] = rectf[3];
-				rectf += 4;
-				
-				newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-				newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-				newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-				newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
-				
-				newrectf += 4;
-			}
-			
-			sample -= 1.0f;
-		}
-	}
+	for (k = 0; k < wy->max_taps; k++)
+		cache_lines[k] = -1;
 
-	if (do_rect) {
-		// printf("%ld %ld\n", (uchar *)rect - ((uchar *)ibuf->rect), rect_size);
-		BLI_assert((uchar *)rect - ((uchar *)ibuf->rect) == rect_size); /* see bug [#26502] */
-		imb_freerectImBuf(ibuf);
-		ibuf->mall |= IB_rect;
-		ibuf->rect = (unsigned int *) _newrect;
-	}
-	if (do_float) {
-		// printf("%ld %ld\n", rectf - ibuf->rect_float, rect_size);
-		BLI_assert((rectf - ibuf->rect_float) == rect_size); /* see bug [#26502] */
-		imb_freerectfloatImBuf(ibuf);
-		ibuf->mall |= IB_rectfloat;
-		ibuf->rect_float = _newrectf;
+	if (!do_float) {
+		in_line = MEM_mallocN(sizeof(float) * 4 * ibuf->x, "scale filter input line");
+		out_line = MEM_mallocN(sizeof(float) * line_len, "scale filter output line");
 	}
-	(void)rect_size; /* UNUSED in release builds */
-	
-	ibuf->x = newx;
-	return(ibuf);
-}
 
+	for (y = start_line; y < start_line + tot_line; y++) {
+		const float *weights = wy->weights + y * wy->max_taps;
+		float *out = do_float ? data->float_buffer + y * line_len : out_line;
 
-static ImBuf *scaledowny(struct ImBuf *ibuf, int newy)
-{
-	const int do_rect = (ibuf->rect != NULL);
-	const int do_float = (ibuf->rect_float != NULL);
-	const size_t rect_size = ibuf->x * ibuf->y * 4;
+		memset(out, 0, sizeof(float) * line_len);
 
-	uchar *rect, *_newrect, *newrect;
-	float *rectf, *_newrectf, *newrectf;
-	float sample, add, val[4], nval[4], valf[4], nvalf[4];
-	int x, y, skipx;
+		for (k = 0; k < wy->taps[y]; k++) {
+			const int line = wy->first[y] + k;
+			const int slot = line % wy->max_taps;
+			float *scaled = cache + slot * line_len;
 
-	rectf = _newrectf = newrectf = NULL;
-	rect = _newrect = newrect = NULL;
-	nval[0] =  nval[1] = nval[2] = nval[3] = 0.0f;
-	nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
+			/* lines are shared with the previous output lines when enlarging or filtering wider than a pixel */
+			if (cache_lines[slot] != line) {
+				if (do_float) {
+					scale_filter_line(wx, ibuf->rect_float + (size_t)line * ibuf->x * channels, scaled,
+					                  data->newx, channels);
+				}
+				else {
+					const unsigned char *rect = (unsigned char *)ibuf->rect + (size_t)line * ibuf->x * 4;
 
-	if (!do_rect && !do_float) return (ibuf);
+					for (i = 0; i < 4 * (size_t)ibuf->x; i++)
+						in_line[i] = rect[i];
 
-	if (do_rect) {
-		_newrect = MEM_mallocN(newy * ibuf->x * sizeof(uchar) * 4, "scaledowny");
-		if (_newrect == NULL) return(ibuf);
-	}
-	if (do_float) {
-		_newrectf = MEM_mallocN(newy * ibuf->x * sizeof(float) * 4, "scaledownyf");
-		if (_newrectf == NULL) {
-			if (_newrect) MEM_freeN(_newrect);
-			return(ibuf);
-		}
-	}
+					scale_filter_line(wx, in_line, scaled, data->newx, 4);
+				}
 
-	add = (ibuf->y - 0.01) / newy;
-	skipx = 4 * ibuf->x;
+				cache_lines[slot] = line;
+			}
 
-	for (x = skipx - 4; x >= 0; x -= 4) {
-		if (do_rect) {
-			rect = ((uchar *) ibuf->rect) + x;
-			newrect = _newrect + x;
-		}
-		if (do_float) {
-			rectf = ibuf->rect_float + x;
-			newrectf = _newrectf + x;
+			scale_filter_add_line(out, scaled, weights[k], line_len);
 		}
-		
-		sample = 0.0f;
-		val[0] =  val[1] = val[2] = val[3] = 0.0f;
-		valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
-
-		for (y = newy; y > 0; y--) {
-			if (do_rect) {
-				nval[0] = -val[0] * sample;
-				nval[1] = -val[1] * sample;
-				nval[2] = -val[2] * sample;
-				nval[3] = -val[3] * sample;
-			}
-			if (do_float) {
-				nvalf[0] = -valf[0] * sample;
-				nvalf[1] = -valf[1] * sample;
-				nvalf[2] = -valf[2] * sample;
-				nvalf[3] = -valf[3] * sample;
-			}
-			
-			sample += add;
 
-			while (sample >= 1.0f) {
-				sample -= 1.0f;
-				
-				if (do_rect) {
-					nval[0] += rect[0];
-					nval[1] += rect[1];
-					nval[2] += rect[2];
-					nval[3] += rect[3];
-					rect += skipx;
-				}
-				if (do_float) {
-					nvalf[0] += rectf[0];
-					nvalf[1] += rectf[1];
-					nvalf[2] += rectf[2];
-					nvalf[3] += rectf[3];
-					rectf += skipx;
-				}
-			}
+		if (!do_float) {
+			unsigned char *rect = data->byte_buffer + y * line_len;
 
-			if (do_rect) {
-				val[0] = rect[0]; val[1] = rect[1]; val[2] = rect[2]; val[3] = rect[3];
-				rect += skipx;
-				
-				newrect[0] = ((nval[0] + sample * val[0]) / add + 0.5f);
-				newrect[1] = ((nval[1] + sample * val[1]) / add + 0.5f);
-				newrect[2] = ((nval[2] + sample * val[2]) / add + 0.5f);
-				newrect[3] = ((nval[3] + sample * val[3]) / add + 0.5f);
-				
-				newrect += skipx;
+			/* filters with negative lobes can go out of range */
+			for (i = 0; i < line_len; i++) {
+				const float value = out_line[i] + 0.5f;
+				rect[i] = (value <= 0.0f) ? 0 : ((value >= 255.0f) ? 255 : (unsigned char)value);
 			}
-			if (do_float) {
-				
-				valf[0] = rectf[0]; valf[1] = rectf[1]; valf[2] = rectf[2]; valf[3] = rectf[3];
-				rectf += skipx;
-				
-				newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-				newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-				newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-				newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
-				
-				newrectf += skipx;
-			}
-			
-			sample -= 1.0f;
 		}
 	}
 
-	if (do_rect) {
-		// printf("%ld %ld\n", (uchar *)rect - ((uchar *)ibuf->rect), rect_size);
-		BLI_assert((uchar *)rect - ((uchar *)ibuf->rect) == rect_size); /* see bug [#26502] */
-		imb_freerectImBuf(ibuf);
-		ibuf->mall |= IB_rect;
-		ibuf->rect = (unsigned int *) _newrect;
-	}
-	if (do_float) {
-		// printf("%ld %ld\n", rectf - ibuf->rect_float, rect_size);
-		BLI_assert((rectf - ibuf->rect_float) == rect_size); /* see bug [#26502] */
-		imb_freerectfloatImBuf(ibuf);
-		ibuf->mall |= IB_rectfloat;
-		ibuf->rect_float = (float *) _newrectf;
+	MEM_freeN(cache);
+	MEM_freeN(cache_lines);
+
+	if (!do_float) {
+		MEM_freeN(in_line);
+		MEM_freeN(out_line);
 	}
-	(void)rect_size; /* UNUSED in release builds */
-	
-	ibuf->y = newy;
-	return(ibuf);
 }
 
-
-static ImBuf *scaleupx(struct ImBuf *ibuf, int newx)
+static void scale_filter_thread_init(void *data_v, int start_line, int tot_line, void *init_data_v)
 {
-	uchar *rect, *_newrect = NULL, *newrect;
-	float *rectf, *_newrectf = NULL, *newrectf;
-	float sample, add;
-	float val_a, nval_a, diff_a;
-	float val_b, nval_b, diff_b;
-	float val_g, nval_g, diff_g;
-	float val_r, nval_r, diff_r;
-	float val_af, nval_af, diff_af;
-	float val_bf, nval_bf, diff_bf;
-	float val_gf, nval_gf, diff_gf;
-	float val_rf, nval_rf, diff_rf;
-	int x, y;
-	bool do_rect = false, do_float = false;
+	ScaleFilterThreadData *data = (ScaleFilterThreadData *) data_v;
 
-	val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-	val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-	val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-	val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
-	if (ibuf == NULL) return(NULL);
-	if (ibuf->rect == NULL && ibuf->rect_float == NULL) return (ibuf);
+	data->init_data = (ScaleFilterInitData *) init_data_v;
 
-	if (ibuf->rect) {
-		do_rect = true;
-		_newrect = MEM_mallocN(newx * ibuf->y * sizeof(int), "scaleupx");
-		if (_newrect == NULL) return(ibuf);
-	}
-	if (ibuf->rect_float) {
-		do_float = true;
-		_newrectf = MEM_mallocN(newx * ibuf->y * sizeof(float) * 4, "scaleupxf");
-		if (_newrectf == NULL) {
-			if (_newrect) MEM_freeN(_newrect);
-			return(ibuf);
-		}
-	}
-
-	add = (ibuf->x - 1.001) / (newx - 1.0);
-
-	rect = (uchar *) ibuf->rect;
-	rectf = (float *) ibuf->rect_float;
-	newrect = _newrect;
-	newrectf = _newrectf;
-
-	for (y = ibuf->y; y > 0; y--) {
-
-		sample = 0;
-		
-		if (do_rect) {
-			val_a = rect[0];
-			nval_a = rect[4];
-			diff_a = nval_a - val_a;
-			val_a += 0.5f;
-
-			val_b = rect[1];
-			nval_b = rect[5];
-			diff_b = nval_b - val_b;
-			val_b += 0.5f;
-
-			val_g = rect[2];
-			nval_g = rect[6];
-			diff_g = nval_g - val_g;
-			val_g += 0.5f;
-
-			val_r = rect[3];
-			nval_r = rect[7];
-			diff_r = nval_r - val_r;
-			val_r += 0.5f;
-
-			rect += 8;
-		}
-		if (do_float) {
-			val_af = rectf[0];
-			nval_af = rectf[4];
-			diff_af = nval_af - val_af;
-	
-			val_bf = rectf[1];
-			nval_bf = rectf[5];
-			diff_bf = nval_bf - val_bf;
+	data->start_line = start_line;
+	data->tot_line = tot_line;
+}
 
-			val_gf = rectf[2];
-			nval_gf = rectf[6];
-			diff_gf = nval_gf - val_gf;
+static void *do_scale_filter_thread(void *data_v)
+{
+	ScaleFilterThreadData *data = (ScaleFilterThreadData *) data_v;
 
-			val_rf = rectf[3];
-			nval_rf = rectf[7];
-			diff_rf = nval_rf - val_rf;
+	if (data->init_data->byte_buffer)
+		scale_filter_lines(data->init_data, data->start_line, data->tot_line, false);
 
-			rectf += 8;
-		}
-		for (x = newx; x > 0; x--) {
-			if (sample >= 1.0f) {
-				sample -= 1.0f;
-
-				if (do_rect) {
-					val_a = nval_a;
-					nval_a = rect[0];
-					diff_a = nval_a - val_a;
-					val_a += 0.5f;
-
-					val_b = nval_b;
-					nval_b = rect[1];
-					diff_b = nval_b - val_b;
-					val_b += 0.5f;
-
-					val_g = nval_g;
-					nval_g = rect[2];
-					diff_g = nval_g - val_g;
-					val_g += 0.5f;
-
-					val_r = nval_r;
-					nval_r = rect[3];
-					diff_r = nval_r - val_r;
-					val_r += 0.5f;
-					rect += 4;
-				}
-				if (do_float) {
-					val_af = nval_af;
-					nval_af = rectf[0];
-					diff_af = nval_af - val_af;
-	
-					val_bf = nval_bf;
-					nval_bf = rectf[1];
-					diff_bf = nval_bf - val_bf;
-
-					val_gf = nval_gf;
-					nval_gf = rectf[2];
-					diff_gf = nval_gf - val_gf;
-
-					val_rf = nval_rf;
-					nval_rf = rectf[3];
-					diff_rf = nval_rf - val_rf;
-					rectf += 4;
-				}
-			}
-			if (do_rect) {
-				newrect[0] = val_a + sample * diff_a;
-				newrect[1] = val_b + sample * diff_b;
-				newrect[2] = val_g + sample * diff_g;
-				newrect[3] = val_r + sample * diff_r;
-				newrect += 4;
-			}
-			if (do_float) {
-				newrectf[0] = val_af + sample * diff_af;
-				newrectf[1] = val_bf + sample * diff_bf;
-				newrectf[2] = val_gf + sample * diff_gf;
-				newrectf[3] = val_rf + sample * diff_rf;
-				newrectf += 4;
-			}
-			sample += add;
-		}
-	}
+	if (data->init_data->float_buffer)
+		scale_filter_lines(data->init_data, data->start_line, data->tot_line, true);
 
-	if (do_rect) {
-		imb_freerectImBuf(ibuf);
-		ibuf->mall |= IB_rect;
-		ibuf->rect = (unsigned int *) _newrect;
-	}
-	if (do_float) {
-		imb_freerectfloatImBuf(ibuf);
-		ibuf->mall |= IB_rectfloat;
-		ibuf->rect_float = (float *) _newrectf;
-	}
-	
-	ibuf->x = newx;
-	return(ibuf);
+	return NULL;
 }
 
-static ImBuf *scaleupy(struct ImBuf *ibuf, int newy)
+static struct ImBuf *scale_filter_imbuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy,
+                                        IMB_ScaleFilter filter_x, IMB_ScaleFilter filter_y,
+                                        ScaleFilterAlign align_x, ScaleFilterAlign align_y)
 {
-	uchar *rect, *_newrect = NULL, *newrect;
-	float *rectf, *_newrectf = NULL, *newrectf;
-	float sample, add;
-	float val_a, nval_a, diff_a;
-	float val_b, nval_b, diff_b;
-	float val_g, nval_g, diff_g;
-	float val_r, nval_r, diff_r;
-	float val_af, nval_af, diff_af;
-	float val_bf, nval_bf, diff_bf;
-	float val_gf, nval_gf, diff_gf;
-	float val_rf, nval_rf, diff_rf;
-	int x, y, skipx;
-	bool do_rect = false, do_float = false;
-
-	val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-	val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-	val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-	val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
-	if (ibuf == NULL) return(NULL);
+	ScaleFilterInitData init_data = {NULL};
+
+	if (ibuf == NULL) return (NULL);
 	if (ibuf->rect == NULL && ibuf->rect_float == NULL) return (ibuf);
 
-	if (ibuf->rect) {
-		do_rect = true;
-		_newrect = MEM_mallocN(ibuf->x * newy * sizeof(int), "scaleupy");
-		if (_newrect == NULL) return(ibuf);
-	}
-	if (ibuf->rect_float) {
-		do_float = true;
-		_newrectf = MEM_mallocN(ibuf->x * newy * sizeof(float) * 4, "scaleupyf");
-		if (_newrectf == NULL) {
-			if (_newrect) MEM_freeN(_newrect);
-			return(ibuf);
-		}
-	}
+	/* zero keeps the size */
+	if (newx == 0) newx = ibuf->x;
+	if (newy == 0) newy = ibuf->y;
 
-	add = (ibuf->y - 1.001) / (newy - 1.0);
-	skipx = 4 * ibuf->x;
+	if (newx == ibuf->x && newy == ibuf->y) { return ibuf; }
 
-	rect = (uchar *) ibuf->rect;
-	rectf = (float *) ibuf->rect_float;
-	newrect = _newrect;
-	newrectf = _newrectf;
+	/* the Z-buffer is scaled without filtering */
+	scalefast_Z_ImBuf(ibuf, newx, newy);
 
-	for (x = ibuf->x; x > 0; x--) {
+	init_data.ibuf = ibuf;
 
-		sample = 0;
-		if (do_rect) {
-			rect = ((uchar *)ibuf->rect) + 4 * (x - 1);
-			newrect = _newrect + 4 * (x - 1);
-
-			val_a = rect[0];
-			nval_a = rect[skipx];
-			diff_a = nval_a - val_a;
-			val_a += 0.5f;
-
-			val_b = rect[1];
-			nval_b = rect[skipx + 1];
-			diff_b = nval_b - val_b;
-			val_b += 0.5f;
-
-			val_g = rect[2];
-			nval_g = rect[skipx + 2];
-			diff_g = nval_g - val_g;
-			val_g += 0.5f;
-
-			val_r = rect[3];
-			nval_r = rect[skipx + 3];
-			diff_r = nval_r - val_r;
-			val_r += 0.5f;
-
-			rect += 2 * skipx;
-		}
-		if (do_float) {
-			rectf = ibuf->rect_float + 4 * (x - 1);
-			newrectf = _newrectf + 4 * (x - 1);
+	init_data.newx = newx;
+	init_data.newy = newy;
 
-			val_af = rectf[0];
-			nval_af = rectf[skipx];
-			diff_af = nval_af - val_af;
-	
-			val_bf = rectf[1];
-			nval_bf = rectf[skipx + 1];
-			diff_bf = nval_bf - val_bf;
+	scale_filter_weights_init(&init_data.weights_x, filter_x, align_x, ibuf->x, newx);
+	scale_filter_weights_init(&init_data.weights_y, filter_y, align_y, ibuf->y, newy);
 
-			val_gf = rectf[2];
-			nval_gf = rectf[skipx + 2];
-			diff_gf = nval_gf - val_gf;
+	if (ibuf->rect)
+		init_data.byte_buffer = MEM_mallocN(4 * (size_t)newx * newy * sizeof(char), "scale filter byte buffer");
 
-			val_rf = rectf[3];
-			nval_rf = rectf[skipx + 3];
-			diff_rf = nval_rf - val_rf;
+	if (ibuf->rect_float)
+		init_data.float_buffer = MEM_mallocN(ibuf->channels * (size_t)newx * newy * sizeof(float), "scale filter float buffer");
 
-			rectf += 2 * skipx;
-		}
-		
-		for (y = newy; y > 0; y--) {
-			if (sample >= 1.0f) {
-				sample -= 1.0f;
-
-				if (do_rect) {
-					val_a = nval_a;
-					nval_a = rect[0];
-					diff_a = nval_a - val_a;
-					val_a += 0.5f;
-
-					val_b = nval_b;
-					nval_b = rect[1];
-					diff_b = nval_b - val_b;
-					val_b += 0.5f;
-
-					val_g = nval_g;
-					nval_g = rect[2];
-					diff_g = nval_g - val_g;
-					val_g += 0.5f;
-
-					val_r = nval_r;
-					nval_r = rect[3];
-					diff_r = nval_r - val_r;
-					val_r += 0.5f;
-					rect += skipx;
-				}
-				if (do_float) {
-					val_af = nval_af;
-					nval_af = rectf[0];
-					diff_af = nval_af - val_af;
-	
-					val_bf = nval_bf;
-					nval_bf = rectf[1];
-					diff_bf = nval_bf - val_bf;
-
-					val_gf = nval_gf;
-					nval_gf = rectf[2];
-					diff_gf = nval_gf - val_gf;
-
-					val_rf = nval_rf;
-					nval_rf = rectf[3];
-					diff_rf = nval_rf - val_rf;
-					rectf += skipx;
-				}
-			}
-			if (do_rect) {
-				newrect[0] = val_a + sample * diff_a;
-				newrect[1] = val_b + sample * diff_b;
-				newrect[2] = val_g + sample * diff_g;
-				newrect[3] = val_r + sample * diff_r;
-				newrect += skipx;
-			}
-			if (do_float) {
-				newrectf[0] = val_af + sample * diff_af;
-				newrectf[1] = val_bf + sample * diff_bf;
-				newrectf[2] = val_gf + sample * diff_gf;
-				newrectf[3] = val_rf + sample * diff_rf;
-				newrectf += skipx;
-			}
-			sample += add;
-		}
-	}
+	IMB_processor_apply_threaded(newy, sizeof(ScaleFilterThreadData), &init_data,
+	                             scale_filter_thread_init, do_scale_filter_thread);
 
-	if (do_rect) {
+	scale_filter_weights_free(&init_data.weights_x);
+	scale_filter_weights_free(&init_data.weights_y);
+
+	/* alter image buffer */
+	ibuf->x = newx;
+	ibuf->y = newy;
+
+	if (ibuf->rect) {
 		imb_freerectImBuf(ibuf);
 		ibuf->mall |= IB_rect;
-		ibuf->rect = (unsigned int *) _newrect;
+		ibuf->rect = (unsigned int *) init_data.byte_buffer;
 	}
-	if (do_float) {
+
+	if (ibuf->rect_float) {
 		imb_freerectfloatImBuf(ibuf);
 		ibuf->mall |= IB_rectfloat;
-		ibuf->rect_float = (float *) _newrectf;
+		ibuf->rect_float = init_data.float_buffer;
 	}
-	
-	ibuf->y = newy;
-	return(ibuf);
+
+	return ibuf;
 }
 
-static void scalefast_Z_ImBuf(ImBuf *ibuf, int newx, int newy)
+struct ImBuf *IMB_scaleImBuf_filter(struct ImBuf *ibuf, unsigned int newx, unsigned int newy, IMB_ScaleFilter filter)
 {
-	int *zbuf, *newzbuf, *_newzbuf = NULL;
-	float *zbuf_float, *newzbuf_float, *_newzbuf_float = NULL;
-	int x, y;
-	int ofsx, ofsy, stepx, stepy;
-
-	if (ibuf->zbuf) {
-		_newzbuf = MEM_mallocN(newx * newy * sizeof(int), __func__);
-		if (_newzbuf == NULL) {
-			IMB_freezbufImBuf(ibuf);
-		}
-	}
-
-	if (ibuf->zbuf_float) {
-		_newzbuf_float = MEM_mallocN((size_t)newx * newy * sizeof(float), __func__);
-		if (_newzbuf_float == NULL) {
-			IMB_freezbuffloatImBuf(ibuf);
-		}
-	}
-
-	if (!_newzbuf && !_newzbuf_float) {
-		return;
-	}
-
-	stepx = (65536.0 * (ibuf->x - 1.0) / (newx - 1.0)) + 0.5;
-	stepy = (65536.0 * (ibuf->y - 1.0) / (newy - 1.0)) + 0.5;
-	ofsy = 32768;
-
-	newzbuf = _newzbuf;
-	newzbuf_float = _newzbuf_float;
-
-	for (y = newy; y > 0; y--, ofsy += stepy) {
-		if (newzbuf) {
-			zbuf = ibuf->zbuf;
-			zbuf += (ofsy >> 16) * ibuf->x;
-			ofsx = 32768;
-			for (x = newx; x > 0; x--, ofsx += stepx) {
-				*newzbuf++ = zbuf[ofsx >> 16];
-			}
-		}
-
-		if (newzbuf_float) {
-			zbuf_float = ibuf->zbuf_float;
-			zbuf_float += (ofsy >> 16) * ibuf->x;
-			ofsx = 32768;
-			for (x = newx; x > 0; x--, ofsx += stepx) {
-				*newzbuf_float++ = zbuf_float[ofsx >> 16];
-			}
-		}
-	}
+	return scale_filter_imbuf(ibuf, newx, newy, filter, filter, SCALE_ALIGN_AREA, SCALE_ALIGN_AREA);
+}
 
-	if (_newzbuf) {
-		IMB_freezbufImBuf(ibuf);
-		ibuf->mall |= IB_zbuf;
-		ibuf->zbuf = _newzbuf;
-	}
+/* box average along axes which shrink, linear interpolation with the given alignment along
+ * axes which enlarge */
+static struct ImBuf *scale_default_imbuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy,
+                                         ScaleFilterAlign enlarge_align)
+{
+	const bool shrink_x = newx < ibuf->x, shrink_y = newy < ibuf->y;
 
-	if (_newzbuf_float) {
-		IMB_freezbuffloatImBuf(ibuf);
-		ibuf->mall |= IB_zbuffloat;
-		ibuf->zbuf_float = _newzbuf_float;
-	}
+	return scale_filter_imbuf(ibuf, newx, newy,
+	                          shrink_x ? IMB_SCALE_FILTER_BOX : IMB_SCALE_FILTER_BILINEAR,
+	                          shrink_y ? IMB_SCALE_FILTER_BOX : IMB_SCALE_FILTER_BILINEAR,
+	                          shrink_x ? SCALE_ALIGN_AREA : enlarge_align,
+	                          shrink_y ? SCALE_ALIGN_AREA : enlarge_align);
 }
 
 struct ImBuf *IMB_scaleImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy)
 {
 	if (ibuf == NULL) return (NULL);
-	if (ibuf->rect == NULL && ibuf->rect_float == NULL) return (ibuf);
-	
-	if (newx == ibuf->x && newy == ibuf->y) { return ibuf; }
-
-	/* scaleup / scaledown functions below change ibuf->x and ibuf->y
-	 * so we first scale the Z-buffer (if any) */
-	scalefast_Z_ImBuf(ibuf, newx, newy);
 
-	/* try to scale common cases in a fast way */
-	/* disabled, quality loss is unacceptable, see report #18609  (ton) */
-	if (0 && q_scale_linear_interpolation(ibuf, newx, newy)) {
-		return ibuf;
-	}
-
-	if (newx && (newx < ibuf->x)) scaledownx(ibuf, newx);
-	if (newy && (newy < ibuf->y)) scaledowny(ibuf, newy);
-	if (newx && (newx > ibuf->x)) scaleupx(ibuf, newx);
-	if (newy && (newy > ibuf->y)) scaleupy(ibuf, newy);
-	
-	return(ibuf);
+	return scale_default_imbuf(ibuf, newx, newy, SCALE_ALIGN_ENDS);
 }
 
 struct imbufRGBA {
@@ -1657,113 +997,8 @@ struct ImBuf *IMB_scalefastImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned
 	return(ibuf);
 }
 
-/* ******** threaded scaling ******** */
-
-typedef struct ScaleTreadInitData {
-	ImBuf *ibuf;
-
-	unsigned int newx;
-	unsigned int newy;
-
-	unsigned char *byte_buffer;
-	float *float_buffer;
-} ScaleTreadInitData;
-
-typedef struct ScaleThreadData {
-	ImBuf *ibuf;
-
-	unsigned int newx;
-	unsigned int newy;
-
-	int start_line;
-	int tot_line;
-
-	unsigned char *byte_buffer;
-	float *float_buffer;
-} ScaleThreadData;
-
-static void scale_thread_init(void *data_v, int start_line, int tot_line, void *init_data_v)
-{
-	ScaleThreadData *data = (ScaleThreadData *) data_v;
-	ScaleTreadInitData *init_data = (ScaleTreadInitData *) init_data_v;
-
-	data->ibuf = init_data->ibuf;
-
-	data->newx = init_data->newx;
-	data->newy = init_data->newy;
-
-	data->start_line = start_line;
-	data->tot_line = tot_line;
-
-	data->byte_buffer = init_data->byte_buffer;
-	data->float_buffer = init_data->float_buffer;
-}
-
-static void *do_scale_thread(void *data_v)
-{
-	ScaleThreadData *data = (ScaleThreadData *) data_v;
-	ImBuf *ibuf = data->ibuf;
-	int i;
-	float factor_x = (float) ibuf->x / data->newx;
-	float factor_y = (float) ibuf->y / data->newy;
-
-	for (i = 0; i < data->tot_line; i++) {
-		int y = data->start_line + i;
-		int x;
-
-		for (x = 0; x < data->newx; x++) {
-			float u = (float) x * factor_x;
-			float v = (float) y * factor_y;
-			int offset = y * data->newx + x;
-
-			if (data->byte_buffer) {
-				unsigned char *pixel = data->byte_buffer + 4 * offset;
-				BLI_bilinear_interpolation_char((unsigned char *) ibuf->rect, pixel, ibuf->x, ibuf->y, 4, u, v);
-			}
-
-			if (data->float_buffer) {
-				float *pixel = data->float_buffer + ibuf->channels * offset;
-				BLI_bilinear_interpolation_fl(ibuf->rect_float, pixel, ibuf->x, ibuf->y, ibuf->channels, u, v);
-			}
-		}
-	}
-
-	return NULL;
-}
-
 void IMB_scaleImBuf_threaded(ImBuf *ibuf, unsigned int newx, unsigned int newy)
 {
-	ScaleTreadInitData init_data = {NULL};
-
-	/* prepare initialization data */
-	init_data.ibuf = ibuf;
-
-	init_data.newx = newx;
-	init_data.newy = newy;
-
-	if (ibuf->rect)
-		init_data.byte_buffer = MEM_mallocN(4 * newx * newy * sizeof(char), "threaded scale byte buffer");
-
-	if (ibuf->rect_float)
-		init_data.float_buffer = MEM_mallocN(ibuf->channels * newx * newy * sizeof(float), "threaded scale float buffer");
-
-	/* actual scaling threads */
-	IMB_processor_apply_threaded(newy, sizeof(ScaleThreadData), &init_data,
-	                             scale_thread_init, do_scale_thread);
-
-	/* alter image buffer */
-	ibuf->x = newx;
-	ibuf->y = newy;
-
-	if (ibuf->rect) {
-		imb_freerectImBuf(ibuf);
-		ibuf->mall |= IB_rect;
-		ibuf->rect = (unsigned int *) init_data.byte_buffer;
-	}
-
-	if (ibuf->rect_float) {
-		imb_freerectfloatImBuf(ibuf);
-		ibuf->mall |= IB_rectfloat;
-		ibuf->rect_float = init_data.float_buffer;
-	}
+	/* all filtered scaling is threaded */
+	scale_default_imbuf(ibuf, newx, newy, SCALE_ALIGN_START);
 }
@@ -425,7 +425,8 @@ static ImBuf *thumb_create_ex(
 				imb_freerectfloatImBuf(img);
 			}
 
-			IMB_scaleImBuf(img, ex, ey);
+			/* thumbnails are much smaller than their images, a wide filter keeps them sharp without aliasing */
+			IMB_scaleImBuf_filter(img, ex, ey, IMB_SCALE_FILTER_LANCZOS);
 		}
 		BLI_snprintf(desc, sizeof(desc), "Thumbnail for %s", uri);
 		IMB_metadata_change_field(img, "Description", desc);
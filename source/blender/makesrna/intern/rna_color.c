@@ -607,6 +607,9 @@ static void rna_ColorManagedColorspaceSettings_reload_update(Main *UNUSED(bmain)
 			Sequence *seq;
 			bool seq_found = false;
 
+			/* the prefetch job might be using the animations which are freed */
+			BKE_sequencer_prefetch_stop();
+
 			if (&scene->sequencer_colorspace_settings != colorspace_settings) {
 				SEQ_BEGIN(scene->ed, seq);
 				{
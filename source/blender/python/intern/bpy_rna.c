@@ -70,6 +70,8 @@
 #include "BKE_report.h"
 #include "BKE_idprop.h"
 
+#include "WM_api.h"
+
 
 #include "../generic/idprop_py_api.h" /* for IDprop lookups */
 #include "../generic/py_capi_utils.h"
@@ -350,6 +352,16 @@ void pyrna_write_set(bool UNUSED(val))
 }
 #endif  /* USE_PEDANTIC_WRITE */
 
+/* jobs reading the data from a thread have to stop before it's changed */
+static void pyrna_write_begin(PointerRNA *ptr)
+{
+	wmWindowManager *wm = G.main->wm.first;
+
+	if (wm && ptr->id.data) {
+		WM_jobs_kill_data_readers(wm, ptr->id.data);
+	}
+}
+
 static Py_ssize_t pyrna_prop_collection_length(BPy_PropertyRNA *self);
 static Py_ssize_t pyrna_prop_array_length(BPy_PropertyArrayRNA *self);
 static int pyrna_py_to_prop(PointerRNA *ptr, PropertyRNA *prop, void *data, PyObject *value, const char *error_prefix);
@@ -424,6 +436,8 @@ static int mathutils_rna_vector_set(BaseMathObject *bmo, int subtype)
 		return -1;
 	}
 
+	pyrna_write_begin(&self->ptr);
+
 	RNA_property_float_range(&self->ptr, self->prop, &min, &max);
 
 	if (min != -FLT_MAX || max != FLT_MAX) {
@@ -488,6 +502,8 @@ static int mathutils_rna_vector_set_index(BaseMathObject *bmo, int UNUSED(subtyp
 		return -1;
 	}
 
+	pyrna_write_begin(&self->ptr);
+
 	RNA_property_float_clamp(&self->ptr, self->prop, &bmo->data[index]);
 	RNA_property_float_set_index(&self->ptr, self->prop, index, bmo->data[index]);
 
@@ -545,6 +561,8 @@ static int mathutils_rna_matrix_set(BaseMathObject *bmo, int UNUSED(subtype))
 		return -1;
 	}
 
+	pyrna_write_begin(&self->ptr);
+
 	/* can ignore clamping here */
 	RNA_property_float_set_array(&self->ptr, self->prop, bmo->data);
 
@@ -1575,6 +1593,10 @@ static int pyrna_py_to_prop(PointerRNA *ptr, PropertyRNA *prop, void *data, PyOb
 	/* XXX hard limits should be checked here */
 	const int type = RNA_property_type(prop);
 
+	/* data is only set for function parameters */
+	if (data == NULL) {
+		pyrna_write_begin(ptr);
+	}
 
 	if (RNA_property_array_check(prop)) {
 		/* done getting the length */
@@ -2021,6 +2043,8 @@ static int pyrna_py_to_prop_array_index(BPy_PropertyArrayRNA *self, int index, P
 
 	const int totdim = RNA_property_array_dimension(ptr, prop, NULL);
 
+	pyrna_write_begin(ptr);
+
 	if (totdim > 1) {
 		/* char error_str[512]; */
 		if (pyrna_py_to_array_index(&self->ptr, self->prop, self->arraydim, self->arrayoffset, index, value, "") == -1) {
@@ -444,6 +444,7 @@ enum {
 	WM_JOB_TYPE_CLIP_PREFETCH,
 	WM_JOB_TYPE_SEQ_BUILD_PROXY,
 	WM_JOB_TYPE_SEQ_BUILD_PREVIEW,
+	WM_JOB_TYPE_SEQ_PREFETCH,
 	WM_JOB_TYPE_POINTCACHE,
 	WM_JOB_TYPE_DPAINT_BAKE,
 	/* add as needed, screencast, seq proxy build
@@ -476,6 +477,7 @@ void		WM_jobs_kill(struct wmWindowManager *wm, void *owner, void (*)(void *, sho
 void		WM_jobs_kill_all(struct wmWindowManager *wm);
 void		WM_jobs_kill_all_except(struct wmWindowManager *wm, void *owner);
 void		WM_jobs_kill_type(struct wmWindowManager *wm, void *owner, int job_type);
+void		WM_jobs_kill_data_readers(struct wmWindowManager *wm, struct ID *id);
 
 bool        WM_jobs_has_running(struct wmWindowManager *wm);
 
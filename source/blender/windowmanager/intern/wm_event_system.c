@@ -768,8 +768,10 @@ static int wm_operator_exec(bContext *C, wmOperator *op, const bool repeat, cons
 		return retval;
 	
 	if (op->type->exec) {
-		if (op->type->flag & OPTYPE_UNDO)
+		if (op->type->flag & OPTYPE_UNDO) {
+			WM_jobs_kill_data_readers(wm, NULL);
 			wm->op_undo_depth++;
+		}
 
 		retval = op->type->exec(C, op);
 		OPERATOR_RETVAL_CHECK(retval);
@@ -1076,6 +1078,11 @@ static int wm_operator_invoke(
 		
 		op->flag |= OP_IS_INVOKE;
 
+		/* operators which can be undone edit data, which might be used by jobs */
+		if (ot->flag & OPTYPE_UNDO) {
+			WM_jobs_kill_data_readers(wm, NULL);
+		}
+
 		/* initialize setting from previous run */
 		if (!is_nested_call) { /* not called by py script */
 			WM_operator_last_properties_init(op);
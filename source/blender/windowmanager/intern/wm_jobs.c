@@ -505,6 +505,16 @@ void WM_jobs_kill_type(struct wmWindowManager *wm, void *owner, int job_type)
 	}
 }
 
+/* wait until jobs reading the data from a thread without a copy of it ended,
+ * needed before the data is edited, id is the edited datablock or NULL if unknown */
+void WM_jobs_kill_data_readers(struct wmWindowManager *wm, ID *id)
+{
+	/* the sequencer prefetch job renders the strips of the scene */
+	if (id == NULL || GS(id->name) == ID_SCE) {
+		WM_jobs_kill_type(wm, NULL, WM_JOB_TYPE_SEQ_PREFETCH);
+	}
+}
+
 /* signal job(s) from this owner or callback to stop, timer is required to get handled */
 void WM_jobs_stop(wmWindowManager *wm, void *owner, void *startjob)
 {